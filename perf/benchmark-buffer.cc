@@ -0,0 +1,107 @@
+/*
+ * Benchmarks for adding text to hb_buffer_t.
+ */
+#include "benchmark/benchmark.h"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "hb.h"
+
+static const char *texts[] =
+{
+  "perf/texts/en-thelittleprince.txt",
+  "perf/texts/en-words.txt",
+  "perf/texts/fa-thelittleprince.txt",
+  "perf/texts/ja-thelittleprince.txt",
+};
+
+enum encoding_t { UTF8, UTF16 };
+
+/* Adds the text line by line, as shaping clients do. */
+static void BM_BufferAdd (benchmark::State &state,
+			  encoding_t encoding,
+			  const char *text_path)
+{
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (text_path);
+  assert (blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (blob, &text_length);
+
+  std::vector<std::pair<unsigned, unsigned>> lines;
+  std::vector<uint16_t> utf16;
+  {
+    const char *start = text, *end = text + text_length;
+    while (start < end)
+    {
+      const char *p = (const char *) memchr (start, '\n', end - start);
+      if (!p) p = end;
+      lines.emplace_back (start - text, p - start);
+      start = p + 1;
+    }
+  }
+  if (encoding == UTF16)
+  {
+    /* Re-encode via a buffer, keeping line offsets valid as UTF-16
+     * offsets by converting each line separately. */
+    hb_buffer_t *buffer = hb_buffer_create ();
+    for (auto &line : lines)
+    {
+      hb_buffer_clear_contents (buffer);
+      hb_buffer_add_utf8 (buffer, text + line.first, line.second, 0, line.second);
+      unsigned len;
+      hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &len);
+      line.first = utf16.size ();
+      for (unsigned i = 0; i < len; i++)
+      {
+	hb_codepoint_t u = info[i].codepoint;
+	if (u < 0x10000u)
+	  utf16.push_back (u);
+	else
+	{
+	  utf16.push_back (0xD800u + ((u - 0x10000u) >> 10));
+	  utf16.push_back (0xDC00u + (u & 0x3FFu));
+	}
+      }
+      line.second = utf16.size () - line.first;
+    }
+    hb_buffer_destroy (buffer);
+  }
+
+  hb_buffer_t *buffer = hb_buffer_create ();
+  for (auto _ : state)
+  {
+    for (auto &line : lines)
+    {
+      hb_buffer_clear_contents (buffer);
+      if (encoding == UTF8)
+	hb_buffer_add_utf8 (buffer, text + line.first, line.second, 0, line.second);
+      else
+	hb_buffer_add_utf16 (buffer, utf16.data () + line.first, line.second, 0, line.second);
+    }
+  }
+  hb_buffer_destroy (buffer);
+
+  hb_blob_destroy (blob);
+}
+
+int main(int argc, char** argv)
+{
+  benchmark::Initialize(&argc, argv);
+
+  for (unsigned i = 0; i < sizeof (texts) / sizeof (texts[0]); i++)
+    for (encoding_t encoding : {UTF8, UTF16})
+    {
+      char name[1024] = "BM_BufferAdd/";
+      strcat (name, encoding == UTF8 ? "utf8/" : "utf16/");
+      const char *p = strrchr (texts[i], '/');
+      strcat (name, p ? p + 1 : texts[i]);
+
+      benchmark::RegisterBenchmark (name, BM_BufferAdd, encoding, texts[i])
+	->Unit(benchmark::kMicrosecond);
+    }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+}
@@ -1,5 +1,6 @@
 #include "benchmark/benchmark.h"
 #include <cassert>
+#include <cmath>
 #include <cstring>
 
 #ifdef HAVE_CONFIG_H
@@ -25,10 +26,12 @@ struct test_input_t
   {true , SUBSET_FONT_BASE_PATH "RobotoFlex-Variable.ttf"},
   {false, SUBSET_FONT_BASE_PATH "SourceSansPro-Regular.otf"},
   {true , SUBSET_FONT_BASE_PATH "AdobeVFPrototype.otf"},
+  {true , SUBSET_FONT_BASE_PATH "SourceSerif4Variable-Roman_subset.otf"},
   {true , SUBSET_FONT_BASE_PATH "SourceSerifVariable-Roman.ttf"},
   {false, SUBSET_FONT_BASE_PATH "Comfortaa-Regular-new.ttf"},
   {false, SUBSET_FONT_BASE_PATH "NotoNastaliqUrdu-Regular.ttf"},
   {false, SUBSET_FONT_BASE_PATH "NotoSerifMyanmar-Regular.otf"},
+  {false, SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf"},
 };
 
 static test_input_t *tests = default_tests;
@@ -39,9 +42,18 @@ enum backend_t { HARFBUZZ, FREETYPE };
 enum operation_t
 {
   nominal_glyphs,
+  nominal_glyphs_zipf,
+  nominal_glyphs_zipf_cached,
   glyph_h_advances,
+  glyph_h_advances_dense,
   glyph_extents,
+  glyph_extents_repeat,
+  glyph_extents_repeat_cached,
   draw_glyph,
+  draw_glyph_repeat,
+  draw_glyph_repeat_cached,
+  draw_glyph_animated,
+  draw_glyph_zipf,
   paint_glyph,
   load_face_and_shape,
 };
@@ -128,6 +140,15 @@ static void BM_Font (benchmark::State &state,
       break;
   }
 
+  if (operation == glyph_h_advances_dense)
+    hb_ot_font_set_advance_array_budget (font, 1u << 20);
+  if (operation == nominal_glyphs_zipf_cached)
+    hb_ot_font_set_cmap_cache (font, 16384, 4, true);
+  if (operation == glyph_extents_repeat_cached)
+    hb_ot_font_set_extents_cache (font, 256);
+  if (operation == draw_glyph_repeat_cached)
+    hb_ot_font_set_outline_cache (font, 256);
+
   switch (operation)
   {
     case nominal_glyphs:
@@ -155,7 +176,53 @@ static void BM_Font (benchmark::State &state,
       hb_set_destroy (set);
       break;
     }
+    case nominal_glyphs_zipf:
+    case nominal_glyphs_zipf_cached:
+    {
+      /* Look characters up with a Zipf-like frequency, the way running
+       * CJK text does, so the working set outgrows small caches. */
+      hb_set_t *set = hb_set_create ();
+      hb_face_collect_unicodes (hb_font_get_face (font), set);
+      unsigned pop = hb_set_get_population (set);
+      hb_codepoint_t *chars = (hb_codepoint_t *) calloc (pop, sizeof (hb_codepoint_t));
+      hb_codepoint_t *p = chars;
+      for (hb_codepoint_t u = HB_SET_VALUE_INVALID;
+	   hb_set_next (set, &u);)
+        *p++ = u;
+
+      unsigned count = 20000;
+      hb_codepoint_t *unicodes = (hb_codepoint_t *) calloc (count, sizeof (hb_codepoint_t));
+      hb_codepoint_t *glyphs = (hb_codepoint_t *) calloc (count, sizeof (hb_codepoint_t));
+      unsigned seed = 1;
+      for (unsigned i = 0; i < count; i++)
+      {
+        seed = seed * 1103515245u + 12345u;
+	/* Rank r is drawn with probability roughly proportional to 1/r. */
+	unsigned r = (unsigned) pow (pop, ((seed >> 8) & 0xFFFF) / 65536.) - 1;
+	/* Scatter ranks over the repertoire. */
+	unicodes[i] = chars[(r * 2654435761u) % pop];
+      }
+
+      for (auto _ : state)
+	for (unsigned i = 0; i < count;)
+	  i += hb_font_get_nominal_glyphs (font,
+					   count - i,
+					   unicodes + i, sizeof (*unicodes),
+					   glyphs + i, sizeof (*glyphs)) + 1;
+
+      unsigned hits = 0, misses = 0;
+      hb_ot_font_get_cmap_cache_stats (font, &hits, &misses);
+      if (hits + misses)
+	state.counters["hit_rate"] = (double) hits / (hits + misses);
+
+      free (glyphs);
+      free (unicodes);
+      free (chars);
+      hb_set_destroy (set);
+      break;
+    }
     case glyph_h_advances:
+    case glyph_h_advances_dense:
     {
       hb_codepoint_t *glyphs = (hb_codepoint_t *) calloc (num_glyphs, sizeof (hb_codepoint_t));
       hb_position_t *advances = (hb_position_t *) calloc (num_glyphs, sizeof (hb_codepoint_t));
@@ -181,6 +248,19 @@ static void BM_Font (benchmark::State &state,
 	  hb_font_get_glyph_extents (font, gid, &extents);
       break;
     }
+    case glyph_extents_repeat:
+    case glyph_extents_repeat_cached:
+    {
+      /* A layout engine asking again and again about the glyphs of a
+       * short run of text. */
+      hb_glyph_extents_t extents;
+      unsigned count = num_glyphs < 64 ? num_glyphs : 64;
+      for (auto _ : state)
+	for (unsigned i = 0; i < 16; i++)
+	  for (unsigned gid = 0; gid < count; ++gid)
+	    hb_font_get_glyph_extents (font, gid, &extents);
+      break;
+    }
     case draw_glyph:
     {
       hb_draw_funcs_t *draw_funcs = _draw_funcs_create ();
@@ -193,6 +273,76 @@ static void BM_Font (benchmark::State &state,
       hb_draw_funcs_destroy (draw_funcs);
       break;
     }
+    case draw_glyph_repeat:
+    case draw_glyph_repeat_cached:
+    {
+      /* A renderer drawing the glyphs of a short run of text again and
+       * again. */
+      hb_draw_funcs_t *draw_funcs = _draw_funcs_create ();
+      unsigned count = num_glyphs < 64 ? num_glyphs : 64;
+      for (auto _ : state)
+      {
+	float i = 0;
+	for (unsigned j = 0; j < 16; j++)
+	  for (unsigned gid = 0; gid < count; ++gid)
+	    hb_font_draw_glyph (font, gid, draw_funcs, &i);
+      }
+      hb_draw_funcs_destroy (draw_funcs);
+
+      unsigned hits = 0, misses = 0;
+      hb_ot_font_get_outline_cache_stats (font, &hits, &misses);
+      if (hits + misses)
+	state.counters["hit_rate"] = (double) hits / (hits + misses);
+      break;
+    }
+    case draw_glyph_animated:
+    {
+      /* Text whose weight is animated: the same glyphs, drawn at new
+       * coordinates every frame. */
+      hb_draw_funcs_t *draw_funcs = _draw_funcs_create ();
+      unsigned count = num_glyphs < 64 ? num_glyphs : 64;
+      for (auto _ : state)
+      {
+	float i = 0;
+	for (unsigned j = 0; j < 16; j++)
+	{
+	  hb_variation_t wght = {HB_TAG ('w','g','h','t'), 300.f + 40 * j};
+	  hb_font_set_variations (font, &wght, 1);
+	  for (unsigned gid = 0; gid < count; ++gid)
+	    hb_font_draw_glyph (font, gid, draw_funcs, &i);
+	}
+      }
+      hb_draw_funcs_destroy (draw_funcs);
+      break;
+    }
+    case draw_glyph_zipf:
+    {
+      /* Glyphs drawn with a Zipf-like frequency, the way rendering running
+       * CJK text does: a few glyphs over and over, and a long tail. */
+      hb_draw_funcs_t *draw_funcs = _draw_funcs_create ();
+      unsigned count = 4096;
+      hb_codepoint_t *glyphs = (hb_codepoint_t *) calloc (count, sizeof (hb_codepoint_t));
+      unsigned seed = 1;
+      for (unsigned i = 0; i < count; i++)
+      {
+        seed = seed * 1103515245u + 12345u;
+	/* Rank r is drawn with probability roughly proportional to 1/r. */
+	unsigned r = (unsigned) pow (num_glyphs, ((seed >> 8) & 0xFFFF) / 65536.) - 1;
+	/* Scatter ranks over the glyph set. */
+	glyphs[i] = (r * 2654435761u) % num_glyphs;
+      }
+
+      for (auto _ : state)
+      {
+	float i = 0;
+	for (unsigned j = 0; j < count; j++)
+	  hb_font_draw_glyph (font, glyphs[j], draw_funcs, &i);
+      }
+
+      free (glyphs);
+      hb_draw_funcs_destroy (draw_funcs);
+      break;
+    }
     case paint_glyph:
     {
       hb_paint_funcs_t *paint_funcs = hb_paint_funcs_create ();
@@ -303,9 +453,18 @@ int main(int argc, char** argv)
 #define TEST_OPERATION(op, time_unit) test_operation (op, #op, time_unit)
 
   TEST_OPERATION (nominal_glyphs, benchmark::kMicrosecond);
+  TEST_OPERATION (nominal_glyphs_zipf, benchmark::kMicrosecond);
+  TEST_OPERATION (nominal_glyphs_zipf_cached, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_h_advances, benchmark::kMicrosecond);
+  TEST_OPERATION (glyph_h_advances_dense, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_extents, benchmark::kMicrosecond);
+  TEST_OPERATION (glyph_extents_repeat, benchmark::kMicrosecond);
+  TEST_OPERATION (glyph_extents_repeat_cached, benchmark::kMicrosecond);
   TEST_OPERATION (draw_glyph, benchmark::kMicrosecond);
+  TEST_OPERATION (draw_glyph_repeat, benchmark::kMicrosecond);
+  TEST_OPERATION (draw_glyph_repeat_cached, benchmark::kMicrosecond);
+  TEST_OPERATION (draw_glyph_animated, benchmark::kMicrosecond);
+  TEST_OPERATION (draw_glyph_zipf, benchmark::kMicrosecond);
   TEST_OPERATION (paint_glyph, benchmark::kMillisecond);
   TEST_OPERATION (load_face_and_shape, benchmark::kMicrosecond);
 
@@ -1,5 +1,10 @@
 #include "benchmark/benchmark.h"
 #include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -39,6 +44,10 @@ struct test_input_t
    "perf/texts/hi-words.txt",
    false},
 
+  {SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf",
+   "perf/texts/ja-thelittleprince.txt",
+   false},
+
   {"perf/fonts/Roboto-Regular.ttf",
    "perf/texts/en-thelittleprince.txt",
    false},
@@ -57,9 +66,46 @@ static unsigned num_tests = sizeof (default_tests) / sizeof (default_tests[0]);
 
 enum backend_t { HARFBUZZ, FREETYPE };
 
+enum shape_mode_t { PER_CALL, BATCH, CACHED, NO_LAYOUT };
+
+/* Returns a copy of face without its GSUB, GPOS and GDEF tables.  Shaping
+ * mark-free text with it mostly comes down to normalization, mapping
+ * characters to glyphs and getting their advances. */
+static hb_face_t *
+face_without_layout (hb_face_t *face)
+{
+  hb_face_t *builder = hb_face_builder_create ();
+  hb_tag_t tags[32];
+  unsigned count, offset = 0;
+  do
+  {
+    count = sizeof (tags) / sizeof (tags[0]);
+    hb_face_get_table_tags (face, offset, &count, tags);
+    for (unsigned i = 0; i < count; i++)
+    {
+      if (tags[i] == HB_TAG ('G','S','U','B') ||
+	  tags[i] == HB_TAG ('G','P','O','S') ||
+	  tags[i] == HB_TAG ('G','D','E','F'))
+	continue;
+      hb_blob_t *blob = hb_face_reference_table (face, tags[i]);
+      hb_face_builder_add_table (builder, tags[i], blob);
+      hb_blob_destroy (blob);
+    }
+    offset += count;
+  }
+  while (count == sizeof (tags) / sizeof (tags[0]));
+
+  hb_blob_t *blob = hb_face_reference_blob (builder);
+  hb_face_destroy (builder);
+  hb_face_t *stripped = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return stripped;
+}
+
 static void BM_Shape (benchmark::State &state,
 		      bool is_var,
 		      backend_t backend,
+		      shape_mode_t mode,
 		      const test_input_t &input)
 {
   hb_font_t *font;
@@ -68,6 +114,12 @@ static void BM_Shape (benchmark::State &state,
     assert (blob);
     hb_face_t *face = hb_face_create (blob, 0);
     hb_blob_destroy (blob);
+    if (mode == NO_LAYOUT)
+    {
+      hb_face_t *stripped = face_without_layout (face);
+      hb_face_destroy (face);
+      face = stripped;
+    }
     font = hb_font_create (face);
     hb_face_destroy (face);
   }
@@ -96,23 +148,240 @@ static void BM_Shape (benchmark::State &state,
   unsigned orig_text_length;
   const char *orig_text = hb_blob_get_data (text_blob, &orig_text_length);
 
+  if (mode == BATCH)
+  {
+    /* Shape lines in batches of up to 64 buffers per hb_shape_batch() call. */
+    const unsigned batch_size = 64;
+    hb_buffer_t *bufs[batch_size];
+    for (unsigned i = 0; i < batch_size; i++)
+      bufs[i] = hb_buffer_create ();
+
+    for (auto _ : state)
+    {
+      unsigned text_length = orig_text_length;
+      const char *text = orig_text;
+
+      const char *end;
+      unsigned count = 0;
+      while ((end = (const char *) memchr (text, '\n', text_length)))
+      {
+	hb_buffer_t *buf = bufs[count++];
+	hb_buffer_clear_contents (buf);
+	hb_buffer_add_utf8 (buf, text, text_length, 0, end - text);
+	hb_buffer_guess_segment_properties (buf);
+
+	if (count == batch_size)
+	{
+	  hb_shape_batch (font, bufs, count, nullptr, 0, nullptr);
+	  count = 0;
+	}
+
+	unsigned skip = end - text + 1;
+	text_length -= skip;
+	text += skip;
+      }
+      hb_shape_batch (font, bufs, count, nullptr, 0, nullptr);
+    }
+
+    for (unsigned i = 0; i < batch_size; i++)
+      hb_buffer_destroy (bufs[i]);
+  }
+  else
+  {
+    /* The cache, sized for the whole word list, outlives iterations; after
+     * the first pass every cacheable line is a hit. */
+    hb_shape_cache_t *cache = mode == CACHED ? hb_shape_cache_create (1u << 16) : nullptr;
+
+    hb_buffer_t *buf = hb_buffer_create ();
+    for (auto _ : state)
+    {
+      unsigned text_length = orig_text_length;
+      const char *text = orig_text;
+
+      const char *end;
+      while ((end = (const char *) memchr (text, '\n', text_length)))
+      {
+	hb_buffer_clear_contents (buf);
+	hb_buffer_add_utf8 (buf, text, text_length, 0, end - text);
+	hb_buffer_guess_segment_properties (buf);
+	if (cache)
+	  hb_shape_cache_shape (cache, font, buf, nullptr, 0, nullptr);
+	else
+	  hb_shape (font, buf, nullptr, 0);
+
+	unsigned skip = end - text + 1;
+	text_length -= skip;
+	text += skip;
+      }
+    }
+    hb_buffer_destroy (buf);
+
+    if (cache)
+    {
+      unsigned hits, misses;
+      hb_shape_cache_get_stats (cache, &hits, &misses, nullptr);
+      state.counters["hit_rate"] = hits + misses ? (double) hits / (hits + misses) : 0.;
+      hb_shape_cache_destroy (cache);
+    }
+  }
+
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+}
+
+/* A minimal thread pool for hb_shape_parallel(); the calling thread
+ * works too. */
+struct thread_pool_t
+{
+  thread_pool_t (unsigned num_threads)
+  {
+    for (unsigned i = 1; i < num_threads; i++)
+      threads.push_back (std::thread ([this] { work (); }));
+  }
+  ~thread_pool_t ()
+  {
+    {
+      std::unique_lock<std::mutex> lk (m);
+      stop = true;
+    }
+    cv.notify_all ();
+    for (auto &thread : threads)
+      thread.join ();
+  }
+
+  static void run_tasks (unsigned num_tasks_,
+			 hb_shape_task_func_t task_,
+			 void *task_data_,
+			 void *user_data)
+  {
+    thread_pool_t *pool = (thread_pool_t *) user_data;
+    std::unique_lock<std::mutex> lk (pool->m);
+    pool->task = task_;
+    pool->task_data = task_data_;
+    pool->num_tasks = num_tasks_;
+    pool->next = pool->done = 0;
+    pool->generation++;
+    pool->cv.notify_all ();
+    pool->drain (lk);
+    pool->done_cv.wait (lk, [pool] { return pool->done == pool->num_tasks; });
+  }
+
+  private:
+  void work ()
+  {
+    unsigned seen = 0;
+    std::unique_lock<std::mutex> lk (m);
+    for (;;)
+    {
+      cv.wait (lk, [&] { return stop || generation != seen; });
+      if (stop)
+	return;
+      seen = generation;
+      drain (lk);
+    }
+  }
+
+  void drain (std::unique_lock<std::mutex> &lk)
+  {
+    while (next < num_tasks)
+    {
+      unsigned i = next++;
+      lk.unlock ();
+      task (i, task_data);
+      lk.lock ();
+      if (++done == num_tasks)
+	done_cv.notify_all ();
+    }
+  }
+
+  std::vector<std::thread> threads;
+  std::mutex m;
+  std::condition_variable cv, done_cv;
+  hb_shape_task_func_t task = nullptr;
+  void *task_data = nullptr;
+  unsigned num_tasks = 0, next = 0, done = 0, generation = 0;
+  bool stop = false;
+};
+
+/* Shapes the whole text as one paragraph, split across state.range(0)
+ * threads. */
+static void BM_ShapeParagraph (benchmark::State &state,
+			       hb_shape_parallel_flags_t flags,
+			       const test_input_t &input)
+{
+  unsigned num_threads = state.range (0);
+
+  hb_font_t *font;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (input.font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  thread_pool_t pool (num_threads);
   hb_buffer_t *buf = hb_buffer_create ();
   for (auto _ : state)
   {
-    unsigned text_length = orig_text_length;
-    const char *text = orig_text;
+    hb_buffer_clear_contents (buf);
+    hb_buffer_add_utf8 (buf, text, text_length, 0, -1);
+    hb_buffer_guess_segment_properties (buf);
+    hb_shape_parallel (font, buf, nullptr, 0, nullptr,
+		       num_threads, flags, thread_pool_t::run_tasks, &pool);
+  }
+  hb_buffer_destroy (buf);
+
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+}
+
+/* Shapes the whole text in pieces of about state.range(0) bytes, to show
+ * how shaping cost per glyph depends on run length.  Long runs let
+ * lookups step over whole runs of glyphs they cannot start at. */
+static void BM_ShapeRuns (benchmark::State &state,
+			  const test_input_t &input)
+{
+  unsigned run_length = state.range (0);
+
+  hb_font_t *font;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (input.font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
 
-    const char *end;
-    while ((end = (const char *) memchr (text, '\n', text_length)))
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  hb_buffer_t *buf = hb_buffer_create ();
+  for (auto _ : state)
+  {
+    unsigned start = 0;
+    while (start < text_length)
     {
+      unsigned end = std::min (start + run_length, text_length);
+      /* Do not split UTF-8 sequences. */
+      while (end < text_length && (text[end] & 0xC0) == 0x80)
+	end++;
+
       hb_buffer_clear_contents (buf);
-      hb_buffer_add_utf8 (buf, text, text_length, 0, end - text);
+      hb_buffer_add_utf8 (buf, text, text_length, start, end - start);
       hb_buffer_guess_segment_properties (buf);
       hb_shape (font, buf, nullptr, 0);
 
-      unsigned skip = end - text + 1;
-      text_length -= skip;
-      text += skip;
+      start = end;
     }
   }
   hb_buffer_destroy (buf);
@@ -124,6 +393,7 @@ static void BM_Shape (benchmark::State &state,
 static void test_backend (backend_t backend,
 			  const char *backend_name,
 			  bool variable,
+			  shape_mode_t mode,
 			  const test_input_t &test_input)
 {
   char name[1024] = "BM_Shape";
@@ -137,8 +407,48 @@ static void test_backend (backend_t backend,
   strcat (name, variable ? "/var" : "");
   strcat (name, "/");
   strcat (name, backend_name);
+  strcat (name, mode == BATCH ? "/batch" :
+		mode == CACHED ? "/cached" :
+		mode == NO_LAYOUT ? "/nolayout" : "");
 
-  benchmark::RegisterBenchmark (name, BM_Shape, variable, backend, test_input)
+  benchmark::RegisterBenchmark (name, BM_Shape, variable, backend, mode, test_input)
+   ->Unit(benchmark::kMillisecond);
+}
+
+static void test_paragraph (hb_shape_parallel_flags_t flags,
+			    const test_input_t &test_input)
+{
+  char name[1024] = "BM_ShapeParagraph";
+  const char *p;
+  strcat (name, "/");
+  p = strrchr (test_input.font_path, '/');
+  strcat (name, p ? p + 1 : test_input.font_path);
+  strcat (name, "/");
+  p = strrchr (test_input.text_path, '/');
+  strcat (name, p ? p + 1 : test_input.text_path);
+  strcat (name, flags & HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD ? "/bounded" : "");
+
+  benchmark::RegisterBenchmark (name, BM_ShapeParagraph, flags, test_input)
+   ->RangeMultiplier(2)
+   ->Range(1, std::max (1u, std::thread::hardware_concurrency ()))
+   ->UseRealTime()
+   ->Unit(benchmark::kMillisecond);
+}
+
+static void test_runs (const test_input_t &test_input)
+{
+  char name[1024] = "BM_ShapeRuns";
+  const char *p;
+  strcat (name, "/");
+  p = strrchr (test_input.font_path, '/');
+  strcat (name, p ? p + 1 : test_input.font_path);
+  strcat (name, "/");
+  p = strrchr (test_input.text_path, '/');
+  strcat (name, p ? p + 1 : test_input.text_path);
+
+  benchmark::RegisterBenchmark (name, BM_ShapeRuns, test_input)
+   ->RangeMultiplier(4)
+   ->Range(16, 1024)
    ->Unit(benchmark::kMillisecond);
 }
 
@@ -165,11 +475,24 @@ int main(int argc, char** argv)
     {
       bool is_var = (bool) variable;
 
-      test_backend (HARFBUZZ, "hb", is_var, test_input);
+      test_backend (HARFBUZZ, "hb", is_var, PER_CALL, test_input);
+      test_backend (HARFBUZZ, "hb", is_var, BATCH, test_input);
+      if (strstr (test_input.text_path, "-words."))
+	test_backend (HARFBUZZ, "hb", is_var, CACHED, test_input);
+      /* Mark-free Latin and CJK text, which normalization maps to glyphs
+       * in one go. */
+      if (strstr (test_input.text_path, "/en-") || strstr (test_input.text_path, "/ja-"))
+	test_backend (HARFBUZZ, "hb", is_var, NO_LAYOUT, test_input);
 #ifdef HAVE_FREETYPE
-      test_backend (FREETYPE, "ft", is_var, test_input);
+      test_backend (FREETYPE, "ft", is_var, PER_CALL, test_input);
 #endif
     }
+    if (!test_input.is_variable && !strstr (test_input.text_path, "-words."))
+    {
+      test_paragraph (HB_SHAPE_PARALLEL_FLAG_DEFAULT, test_input);
+      test_paragraph (HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD, test_input);
+      test_runs (test_input);
+    }
   }
 
   benchmark::RunSpecifiedBenchmarks();
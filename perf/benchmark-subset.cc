@@ -1,6 +1,12 @@
 #include "benchmark/benchmark.h"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -134,11 +140,87 @@ free_cached_face (void)
 }
 
 
-/* benchmark for subsetting a font */
+/* A minimal thread pool for hb_subset_plan_execute_parallel_or_fail();
+ * the calling thread works too. */
+struct thread_pool_t
+{
+  thread_pool_t (unsigned num_threads)
+  {
+    for (unsigned i = 1; i < num_threads; i++)
+      threads.push_back (std::thread ([this] { work (); }));
+  }
+  ~thread_pool_t ()
+  {
+    {
+      std::unique_lock<std::mutex> lk (m);
+      stop = true;
+    }
+    cv.notify_all ();
+    for (auto &thread : threads)
+      thread.join ();
+  }
+
+  static void run_tasks (unsigned num_tasks_,
+			 hb_subset_task_func_t task_,
+			 void *task_data_,
+			 void *user_data)
+  {
+    thread_pool_t *pool = (thread_pool_t *) user_data;
+    std::unique_lock<std::mutex> lk (pool->m);
+    pool->task = task_;
+    pool->task_data = task_data_;
+    pool->num_tasks = num_tasks_;
+    pool->next = pool->done = 0;
+    pool->generation++;
+    pool->cv.notify_all ();
+    pool->drain (lk);
+    pool->done_cv.wait (lk, [pool] { return pool->done == pool->num_tasks; });
+  }
+
+  private:
+  void work ()
+  {
+    unsigned seen = 0;
+    std::unique_lock<std::mutex> lk (m);
+    for (;;)
+    {
+      cv.wait (lk, [&] { return stop || generation != seen; });
+      if (stop)
+	return;
+      seen = generation;
+      drain (lk);
+    }
+  }
+
+  void drain (std::unique_lock<std::mutex> &lk)
+  {
+    while (next < num_tasks)
+    {
+      unsigned i = next++;
+      lk.unlock ();
+      task (i, task_data);
+      lk.lock ();
+      if (++done == num_tasks)
+	done_cv.notify_all ();
+    }
+  }
+
+  std::vector<std::thread> threads;
+  std::mutex m;
+  std::condition_variable cv, done_cv;
+  hb_subset_task_func_t task = nullptr;
+  void *task_data = nullptr;
+  unsigned num_tasks = 0, next = 0, done = 0, generation = 0;
+  bool stop = false;
+};
+
+/* benchmark for subsetting a font; with parallel set, the tables are
+ * subset on state.range(1) threads. */
 static void BM_subset (benchmark::State &state,
                        operation_t operation,
                        const test_input_t &test_input,
-                       bool retain_gids)
+                       bool retain_gids,
+                       bool parallel)
 {
   unsigned subset_size = state.range(0);
 
@@ -205,12 +287,22 @@ static void BM_subset (benchmark::State &state,
     break;
   }
 
+  thread_pool_t *pool = parallel ? new thread_pool_t (state.range(1)) : nullptr;
   for (auto _ : state)
   {
-    hb_face_t* subset = hb_subset_or_fail (face, input);
+    hb_face_t* subset;
+    if (pool)
+    {
+      hb_subset_plan_t* plan = hb_subset_plan_create_or_fail (face, input);
+      subset = hb_subset_plan_execute_parallel_or_fail (plan, thread_pool_t::run_tasks, pool);
+      hb_subset_plan_destroy (plan);
+    }
+    else
+      subset = hb_subset_or_fail (face, input);
     assert (subset);
     hb_face_destroy (subset);
   }
+  delete pool;
 
   hb_subset_input_destroy (input);
   hb_face_destroy (face);
@@ -233,11 +325,180 @@ static void test_subset (operation_t op,
   if (retain_gids)
     strcat (name, "/retaingids");
 
-  benchmark::RegisterBenchmark (name, BM_subset, op, test_input, retain_gids)
+  benchmark::RegisterBenchmark (name, BM_subset, op, test_input, retain_gids, false)
       ->Range(10, test_input.max_subset_size)
       ->Unit(time_unit);
 }
 
+/* Subsets to the largest size on 1, 2, 4, ... threads. */
+static void test_subset_parallel (operation_t op,
+                                  const char *op_name,
+                                  benchmark::TimeUnit time_unit,
+                                  const test_input_t &test_input)
+{
+  if (op == instance && test_input.instance_opts == nullptr)
+    return;
+
+  char name[1024] = "BM_subset_parallel/";
+  strcat (name, op_name);
+  strcat (name, "/");
+  const char *p = strrchr (test_input.font_path, '/');
+  strcat (name, p ? p + 1 : test_input.font_path);
+
+  auto *bm = benchmark::RegisterBenchmark (name, BM_subset, op, test_input, false, true);
+  unsigned max_threads = std::max (1u, std::thread::hardware_concurrency ());
+  for (unsigned num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    bm->Args ({(int64_t) test_input.max_subset_size, num_threads});
+  bm->Unit(time_unit);
+}
+
+/* benchmark for adding state.range(0) codepoints to an executed subset
+ * of base_size codepoints; either by extending its plan, or, for
+ * comparison, by subsetting again from scratch. */
+static void BM_subset_incremental (benchmark::State &state,
+                                   const char *font_path,
+                                   unsigned base_size,
+                                   bool desubroutinize,
+                                   bool incremental)
+{
+  unsigned added_size = state.range(0);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+  assert (blob);
+  hb_face_t *face = preprocess_face (hb_face_create (blob, 0));
+  hb_blob_destroy (blob);
+
+  hb_subset_input_t* input = hb_subset_input_create_or_fail ();
+  assert (input);
+  if (desubroutinize)
+    hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_DESUBROUTINIZE);
+
+  /* Base subset takes the even codepoints, additions the odd ones. */
+  hb_set_t* all_codepoints = hb_set_create ();
+  hb_face_collect_unicodes (face, all_codepoints);
+  hb_set_t* added = hb_set_create ();
+  hb_codepoint_t cp = HB_SET_VALUE_INVALID;
+  for (unsigned i = 0; hb_set_next (all_codepoints, &cp); i++)
+  {
+    if (i % 2 == 0 && i / 2 < base_size)
+      hb_set_add (hb_subset_input_unicode_set (input), cp);
+    else if (i % 2 == 1 && i / 2 < added_size)
+      hb_set_add (added, cp);
+  }
+  hb_set_destroy (all_codepoints);
+
+  hb_subset_plan_t* base = hb_subset_plan_create_or_fail (face, input);
+  assert (base);
+  hb_face_destroy (hb_subset_plan_execute_or_fail (base));
+
+  hb_subset_input_t* extended_input = hb_subset_input_create_or_fail ();
+  assert (extended_input);
+  hb_subset_input_set_flags (extended_input, hb_subset_input_get_flags (input));
+  hb_set_union (hb_subset_input_unicode_set (extended_input), hb_subset_input_unicode_set (input));
+  hb_set_union (hb_subset_input_unicode_set (extended_input), added);
+
+  for (auto _ : state)
+  {
+    hb_face_t* subset;
+    if (incremental)
+    {
+      hb_subset_plan_t* plan = hb_subset_plan_create_incremental_or_fail (base, added, nullptr);
+      subset = hb_subset_plan_execute_or_fail (plan);
+      hb_subset_plan_destroy (plan);
+    }
+    else
+      subset = hb_subset_or_fail (face, extended_input);
+    assert (subset);
+    hb_face_destroy (subset);
+  }
+
+  hb_subset_input_destroy (extended_input);
+  hb_subset_plan_destroy (base);
+  hb_set_destroy (added);
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+static void test_subset_incremental (const char *font_path,
+                                     unsigned base_size,
+                                     bool desubroutinize)
+{
+  for (bool incremental : {true, false})
+  {
+    char name[1024] = "BM_subset_incremental/";
+    strcat (name, incremental ? "incremental/" : "scratch/");
+    const char *p = strrchr (font_path, '/');
+    strcat (name, p ? p + 1 : font_path);
+    if (desubroutinize)
+      strcat (name, "/desubroutinize");
+
+    benchmark::RegisterBenchmark (name, BM_subset_incremental, font_path, base_size, desubroutinize, incremental)
+        ->Arg(1)->Arg(10)->Arg(100)
+        ->Unit(benchmark::kMicrosecond);
+  }
+}
+
+/* benchmark for subsetting a preprocessed face to state.range(0) different
+ * random sets of state.range(1) codepoints in turn; with few sets requests
+ * repeat and reuse cached layout closures, with many they do not. */
+static void BM_subset_random_sets (benchmark::State &state,
+                                   const test_input_t &test_input)
+{
+  unsigned num_sets = state.range(0);
+  unsigned subset_size = state.range(1);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+  assert (blob);
+  hb_face_t *face = preprocess_face (hb_face_create (blob, 0));
+  hb_blob_destroy (blob);
+
+  hb_set_t* all_codepoints = hb_set_create ();
+  hb_face_collect_unicodes (face, all_codepoints);
+  std::vector<hb_codepoint_t> codepoints;
+  hb_codepoint_t cp = HB_SET_VALUE_INVALID;
+  while (hb_set_next (all_codepoints, &cp))
+    codepoints.push_back (cp);
+  hb_set_destroy (all_codepoints);
+  assert (!codepoints.empty ());
+
+  std::minstd_rand rng (num_sets);
+  std::vector<hb_subset_input_t *> inputs;
+  for (unsigned i = 0; i < num_sets; i++)
+  {
+    hb_subset_input_t* input = hb_subset_input_create_or_fail ();
+    assert (input);
+    for (unsigned j = 0; j < subset_size; j++)
+      hb_set_add (hb_subset_input_unicode_set (input), codepoints[rng () % codepoints.size ()]);
+    inputs.push_back (input);
+  }
+
+  unsigned i = 0;
+  for (auto _ : state)
+  {
+    hb_face_t* subset = hb_subset_or_fail (face, inputs[i++ % num_sets]);
+    assert (subset);
+    hb_face_destroy (subset);
+  }
+
+  for (auto *input : inputs)
+    hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+static void test_subset_random_sets (const test_input_t &test_input)
+{
+  if (test_input.instance_opts)
+    return;
+
+  char name[1024] = "BM_subset_random_sets/";
+  const char *p = strrchr (test_input.font_path, '/');
+  strcat (name, p ? p + 1 : test_input.font_path);
+
+  benchmark::RegisterBenchmark (name, BM_subset_random_sets, test_input)
+      ->Args({16, 100})->Args({1024, 100})
+      ->Unit(benchmark::kMicrosecond);
+}
+
 static void test_operation (operation_t op,
                             const char *op_name,
                             const test_input_t *tests,
@@ -249,6 +510,7 @@ static void test_operation (operation_t op,
     auto& test_input = tests[i];
     test_subset (op, op_name, true, time_unit, test_input);
     test_subset (op, op_name, false, time_unit, test_input);
+    test_subset_parallel (op, op_name, time_unit, test_input);
   }
 }
 
@@ -279,6 +541,12 @@ int main(int argc, char** argv)
 
 #undef TEST_OPERATION
 
+  for (unsigned i = 0; i < num_tests; i++)
+    test_subset_random_sets (tests[i]);
+
+  test_subset_incremental (SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", 1000, false);
+  test_subset_incremental (SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", 1000, true);
+
   benchmark::RunSpecifiedBenchmarks();
   benchmark::Shutdown();
 
@@ -126,10 +126,33 @@ struct PairPosFormat2_4 : ValueBase
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
-    hb_buffer_t *buffer = c->buffer;
-    unsigned int index = (this+coverage).get_coverage  (buffer->cur().codepoint);
+    unsigned int index = (this+coverage).get_coverage  (c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
+    return_trace (apply_classes (c, this+classDef1, this+classDef2));
+  }
+
+  unsigned get_class_defs (const ClassDef **class_defs) const
+  {
+    if (class_defs)
+    {
+      class_defs[0] = &(this+classDef1);
+      class_defs[1] = &(this+classDef2);
+    }
+    return 2;
+  }
+  /* Like apply(), for a glyph known to be covered. */
+  bool apply_mapped (hb_ot_apply_context_t *c, const hb_class_map_t * const *class_maps) const
+  { return apply_classes (c, *class_maps[0], *class_maps[1]); }
+
+  template <typename class_def1_t, typename class_def2_t>
+  bool apply_classes (hb_ot_apply_context_t *c,
+		      const class_def1_t &class_def1,
+		      const class_def2_t &class_def2) const
+  {
+    TRACE_APPLY (this);
+    hb_buffer_t *buffer = c->buffer;
+
     hb_ot_apply_context_t::skipping_iterator_t &skippy_iter = c->iter_input;
     skippy_iter.reset_fast (buffer->idx);
     unsigned unsafe_to;
@@ -139,8 +162,8 @@ struct PairPosFormat2_4 : ValueBase
       return_trace (false);
     }
 
-    unsigned int klass1 = (this+classDef1).get_class (buffer->cur().codepoint);
-    unsigned int klass2 = (this+classDef2).get_class (buffer->info[skippy_iter.idx].codepoint);
+    unsigned int klass1 = class_def1.get_class (buffer->cur().codepoint);
+    unsigned int klass2 = class_def2.get_class (buffer->info[skippy_iter.idx].codepoint);
     if (unlikely (klass1 >= class1Count || klass2 >= class2Count))
     {
       buffer->unsafe_to_concat (buffer->idx, skippy_iter.idx + 1);
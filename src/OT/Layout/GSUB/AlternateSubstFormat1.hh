@@ -76,6 +76,17 @@ struct AlternateSubstFormat1_2
     unsigned int index = (this+coverage).get_coverage (c->buffer->cur().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
+    return_trace (apply_dense (c, index));
+  }
+
+  /* Dense table value for the glyph at coverage index: the index itself,
+   * which selects the alternate set. */
+  unsigned get_dense_value (unsigned index, hb_codepoint_t glyph_id HB_UNUSED) const
+  { return index; }
+
+  bool apply_dense (hb_ot_apply_context_t *c, unsigned index) const
+  {
+    TRACE_APPLY (this);
     return_trace ((this+alternateSet[index]).apply (c));
   }
 
@@ -85,6 +85,17 @@ struct LigatureSubstFormat1_2
     unsigned int index = (this+coverage).get_coverage (c->buffer->cur ().codepoint);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
+    return_trace (apply_dense (c, index));
+  }
+
+  /* Dense table value for the glyph at coverage index: the index itself,
+   * which selects the ligature set. */
+  unsigned get_dense_value (unsigned index, hb_codepoint_t glyph_id HB_UNUSED) const
+  { return index; }
+
+  bool apply_dense (hb_ot_apply_context_t *c, unsigned index) const
+  {
+    TRACE_APPLY (this);
     const auto &lig_set = this+ligatureSet[index];
     return_trace (lig_set.apply (c));
   }
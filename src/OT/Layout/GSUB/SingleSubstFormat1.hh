@@ -123,6 +123,10 @@ struct SingleSubstFormat1_3
     return 1;
   }
 
+  /* Dense table value for the glyph at coverage index: its substitute. */
+  unsigned get_dense_value (unsigned index HB_UNUSED, hb_codepoint_t glyph_id) const
+  { return (glyph_id + deltaGlyphID) & get_mask (); }
+
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
@@ -130,10 +134,12 @@ struct SingleSubstFormat1_3
     unsigned int index = (this+coverage).get_coverage (glyph_id);
     if (likely (index == NOT_COVERED)) return_trace (false);
 
-    hb_codepoint_t d = deltaGlyphID;
-    hb_codepoint_t mask = get_mask ();
+    return_trace (apply_dense (c, get_dense_value (index, glyph_id)));
+  }
 
-    glyph_id = (glyph_id + d) & mask;
+  bool apply_dense (hb_ot_apply_context_t *c, hb_codepoint_t glyph_id) const
+  {
+    TRACE_APPLY (this);
 
     if (HB_BUFFER_MESSAGE_MORE && c->buffer->messaging ())
     {
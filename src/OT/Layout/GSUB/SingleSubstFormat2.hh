@@ -100,6 +100,10 @@ struct SingleSubstFormat2_4
     return 1;
   }
 
+  /* Dense table value for the glyph at coverage index: its substitute. */
+  unsigned get_dense_value (unsigned index, hb_codepoint_t glyph_id HB_UNUSED) const
+  { return likely (index < substitute.len) ? (unsigned) substitute[index] : NOT_COVERED; }
+
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
@@ -108,6 +112,13 @@ struct SingleSubstFormat2_4
 
     if (unlikely (index >= substitute.len)) return_trace (false);
 
+    return_trace (apply_dense (c, substitute[index]));
+  }
+
+  bool apply_dense (hb_ot_apply_context_t *c, hb_codepoint_t glyph_id) const
+  {
+    TRACE_APPLY (this);
+
     if (HB_BUFFER_MESSAGE_MORE && c->buffer->messaging ())
     {
       c->buffer->sync_so_far ();
@@ -116,7 +127,7 @@ struct SingleSubstFormat2_4
 			  c->buffer->idx);
     }
 
-    c->replace_glyph (substitute[index]);
+    c->replace_glyph (glyph_id);
 
     if (HB_BUFFER_MESSAGE_MORE && c->buffer->messaging ())
     {
@@ -3,6 +3,7 @@
 #include "hb-aat-layout.cc"
 #include "hb-aat-map.cc"
 #include "hb-blob.cc"
+#include "hb-buffer-reshape.cc"
 #include "hb-buffer-serialize.cc"
 #include "hb-buffer-verify.cc"
 #include "hb-buffer.cc"
@@ -46,7 +47,10 @@
 #include "hb-paint-extents.cc"
 #include "hb-paint.cc"
 #include "hb-set.cc"
+#include "hb-shape-cache.cc"
+#include "hb-shape-parallel.cc"
 #include "hb-shape-plan.cc"
+#include "hb-shape-profile.cc"
 #include "hb-shape.cc"
 #include "hb-shaper.cc"
 #include "hb-static.cc"
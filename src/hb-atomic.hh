@@ -193,6 +193,7 @@ struct hb_atomic_int_t
   int get_acquire () const { return hb_atomic_int_impl_get (&v); }
   int inc () { return hb_atomic_int_impl_add (&v,  1); }
   int dec () { return hb_atomic_int_impl_add (&v, -1); }
+  int add (int v_) { return hb_atomic_int_impl_add (&v, v_); }
 
   int v = 0;
 };
@@ -224,5 +225,46 @@ static inline bool hb_barrier ()
   return true;
 }
 
+/* Lets readers use objects that writers unlink concurrently, without
+ * locking.  Readers bracket their use in enter() and leave().  Writers,
+ * serialized among themselves, keep what they unlink since the last
+ * advance(), and may free what they unlinked before it once
+ * previous_done(); then they can advance() again. */
+struct hb_epoch_t
+{
+  unsigned int enter ()
+  {
+    /* Count ourselves in the epoch that is current after we did. */
+    for (;;)
+    {
+      unsigned int e = epoch.get_relaxed ();
+      readers[e & 1].inc ();
+      _hb_memory_barrier ();
+      if (likely ((unsigned) epoch.get_acquire () == e))
+	return e;
+      readers[e & 1].dec ();
+    }
+  }
+  void leave (unsigned int e) { readers[e & 1].dec (); }
+
+  /* Whether the readers that entered before the last advance() left. */
+  bool previous_done () const
+  {
+    _hb_memory_barrier ();
+    return !readers[(epoch.get_relaxed () - 1) & 1].get_acquire ();
+  }
+  void advance () { epoch.set_release (epoch.get_relaxed () + 1); }
+  /* Waits until the readers that entered before now have left. */
+  void synchronize ()
+  {
+    while (!previous_done ()) {}
+    advance ();
+    while (!previous_done ()) {}
+  }
+
+  hb_atomic_int_t epoch;
+  hb_atomic_int_t readers[2]; /* By epoch parity. */
+};
+
 
 #endif /* HB_ATOMIC_HH */
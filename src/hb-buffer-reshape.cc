@@ -0,0 +1,313 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+
+#ifndef HB_NO_SHAPER
+
+#include "hb-buffer.hh"
+
+
+/* How many times to widen the reshaped window before giving up and
+ * shaping everything. */
+#define HB_BUFFER_RESHAPE_MAX_ATTEMPTS 4u
+/* How many safe pieces on either side of the edit are reshaped along,
+ * to check they come out the same. */
+#define HB_BUFFER_RESHAPE_OVERLAP 2u
+
+
+/*
+ * Incremental reshaping
+ *
+ * Everything is done in terms of cluster values, which must be monotone
+ * in the text.  The window reshaped is bounded by boundaries that were
+ * safe-to-break in the previous output, and extends a couple of safe
+ * pieces further on each side: those overlapping pieces must come out
+ * the same as before, and the boundaries between them and the edited
+ * text must still be safe-to-break, for the result to be spliced in.
+ */
+
+/* Where the glyphs of b split at cluster: for forward directions the
+ * first glyph at or after it, for backward ones the first before it. */
+static unsigned int
+_hb_buffer_reshape_split (const hb_buffer_t *b, unsigned int cluster)
+{
+  unsigned int i;
+  if (HB_DIRECTION_IS_FORWARD (b->props.direction))
+    for (i = 0; i < b->len && b->info[i].cluster < cluster; i++)
+      ;
+  else
+    for (i = 0; i < b->len && b->info[i].cluster >= cluster; i++)
+      ;
+  return i;
+}
+
+/* Glyphs of b for clusters lo..hi-1, in buffer order. */
+static void
+_hb_buffer_reshape_range (const hb_buffer_t *b,
+			  unsigned int lo, unsigned int hi,
+			  unsigned int *start, unsigned int *end)
+{
+  unsigned int a = _hb_buffer_reshape_split (b, lo);
+  unsigned int z = _hb_buffer_reshape_split (b, hi);
+  if (HB_DIRECTION_IS_FORWARD (b->props.direction))
+  { *start = a; *end = z; }
+  else
+  { *start = z; *end = a; }
+}
+
+static bool
+_hb_buffer_reshape_safe_to_break_before (const hb_buffer_t *b, unsigned int cluster)
+{
+  for (unsigned int i = 0; i < b->len; i++)
+    if (b->info[i].cluster == cluster)
+      return !(b->info[i].mask & HB_GLYPH_FLAG_UNSAFE_TO_BREAK);
+  /* Merged into a cluster starting earlier. */
+  return false;
+}
+
+/* Whether glyphs lo..hi-1 of new_ match those for old_lo..old_hi-1 of
+ * old, with clusters moved by delta. */
+static bool
+_hb_buffer_reshape_same (const hb_buffer_t *new_, unsigned int lo, unsigned int hi,
+			 const hb_buffer_t *old, unsigned int old_lo, unsigned int old_hi,
+			 int delta)
+{
+  unsigned int start, end, old_start, old_end;
+  _hb_buffer_reshape_range (new_, lo, hi, &start, &end);
+  _hb_buffer_reshape_range (old, old_lo, old_hi, &old_start, &old_end);
+  if (end - start != old_end - old_start)
+    return false;
+  for (unsigned int i = start, j = old_start; i < end; i++, j++)
+    if (new_->info[i].codepoint != old->info[j].codepoint ||
+	new_->info[i].cluster != old->info[j].cluster + delta ||
+	hb_memcmp (&new_->pos[i], &old->pos[j], sizeof (new_->pos[i])))
+      return false;
+  return true;
+}
+
+static unsigned int
+_hb_buffer_reshape_text_index (const hb_buffer_t *text, unsigned int cluster)
+{
+  unsigned int i;
+  for (i = 0; i < text->len && text->info[i].cluster < cluster; i++)
+    ;
+  return i;
+}
+
+static hb_bool_t
+_hb_buffer_reshape_all (hb_buffer_t        *buffer,
+			hb_buffer_t        *text,
+			hb_font_t          *font,
+			const hb_feature_t *features,
+			unsigned int        num_features,
+			const char * const *shaper_list)
+{
+  hb_buffer_set_length (buffer, 0);
+  buffer->have_positions = false;
+  hb_buffer_append (buffer, text, 0, -1);
+  return hb_shape_full (font, buffer, features, num_features, shaper_list);
+}
+
+/**
+ * hb_buffer_reshape_range:
+ * @buffer: an #hb_buffer_t holding the previous shaping output
+ * @text: an #hb_buffer_t holding the complete, edited, text
+ * @start: the cluster value where the edit starts
+ * @old_end: the cluster value where the edit ended before the edit
+ * @new_end: the cluster value where the edit ends in @text
+ * @font: an #hb_font_t to use for shaping
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Updates the shaping output in @buffer after the text it was shaped
+ * from had the clusters from @start to @old_end replaced by those from
+ * @start to @new_end of @text, such that it matches what shaping @text
+ * with hb_shape_full() would produce.  @buffer and @text must have the
+ * same segment properties, and the same font and features must be used
+ * as when @buffer was shaped.
+ *
+ * Only the text around the edit is reshaped: the edit is widened to
+ * boundaries the previous output marked safe to break at (see
+ * #HB_GLYPH_FLAG_UNSAFE_TO_BREAK), and the result is spliced into
+ * @buffer, moving the cluster values after the edit along.  If that
+ * cannot be done safely, all of @text is shaped again.
+ *
+ * The cluster values of @text must be monotone and those of @buffer must
+ * match the text it was shaped from, as is the case when text is added
+ * with hb_buffer_add_utf8() and friends.
+ *
+ * If @buffer has #HB_BUFFER_FLAG_VERIFY set, the result is compared to
+ * shaping all of @text.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_buffer_reshape_range (hb_buffer_t        *buffer,
+			 hb_buffer_t        *text,
+			 unsigned int        start,
+			 unsigned int        old_end,
+			 unsigned int        new_end,
+			 hb_font_t          *font,
+			 const hb_feature_t *features,
+			 unsigned int        num_features,
+			 const char * const *shaper_list)
+{
+  if (unlikely (hb_object_is_immutable (buffer)))
+    return false;
+
+  bool incremental = buffer->len &&
+		     buffer->content_type == HB_BUFFER_CONTENT_TYPE_GLYPHS &&
+		     text->content_type == HB_BUFFER_CONTENT_TYPE_UNICODE &&
+		     start <= old_end && start <= new_end &&
+		     hb_segment_properties_equal (&buffer->props, &text->props) &&
+		     (buffer->cluster_level == HB_BUFFER_CLUSTER_LEVEL_MONOTONE_GRAPHEMES ||
+		      buffer->cluster_level == HB_BUFFER_CLUSTER_LEVEL_MONOTONE_CHARACTERS);
+  for (unsigned int i = 1; incremental && i < text->len; i++)
+    if (text->info[i].cluster < text->info[i - 1].cluster)
+      incremental = false;
+
+  /* Boundaries the previous output was safe to break at; the start and
+   * end of text are represented by 0 and UINT_MAX. */
+  hb_vector_t<unsigned int> boundaries;
+  if (incremental)
+  {
+    boundaries.push (0);
+    bool forward = HB_DIRECTION_IS_FORWARD (buffer->props.direction);
+    for (unsigned int j = 0; j < buffer->len; j++)
+    {
+      unsigned int i = forward ? j : buffer->len - 1 - j;
+      unsigned int cluster = buffer->info[i].cluster;
+      if (cluster > boundaries.tail () &&
+	  !(buffer->info[i].mask & HB_GLYPH_FLAG_UNSAFE_TO_BREAK))
+	boundaries.push (cluster);
+    }
+    boundaries.push (UINT_MAX);
+    incremental = !boundaries.in_error ();
+  }
+
+  hb_buffer_t *window = nullptr;
+  bool spliced = false;
+  int delta = (int) (new_end - old_end);
+  auto to_new = [&] (unsigned int cluster) -> unsigned int
+  { return cluster == UINT_MAX ? cluster : cluster + delta; };
+
+  for (unsigned int attempt = 0; incremental && attempt < HB_BUFFER_RESHAPE_MAX_ATTEMPTS; attempt++)
+  {
+    /* Keep glyphs for clusters k0..k1-1 of the window w0..w1-1. */
+    unsigned int a = 0, b = boundaries.length - 1;
+    while (a + 1 < boundaries.length && boundaries[a + 1] <= start)
+      a++;
+    while (b && boundaries[b - 1] >= old_end)
+      b--;
+    a = a > attempt ? a - attempt : 0;
+    b = hb_min (b + attempt, boundaries.length - 1);
+
+    unsigned int k0 = boundaries[a];
+    unsigned int w0 = boundaries[a > HB_BUFFER_RESHAPE_OVERLAP ? a - HB_BUFFER_RESHAPE_OVERLAP : 0];
+    unsigned int old_k1 = boundaries[b];
+    unsigned int old_w1 = boundaries[hb_min (b + HB_BUFFER_RESHAPE_OVERLAP, boundaries.length - 1)];
+    unsigned int k1 = to_new (old_k1);
+    unsigned int w1 = to_new (old_w1);
+
+    unsigned int text_start = _hb_buffer_reshape_text_index (text, w0);
+    unsigned int text_end = _hb_buffer_reshape_text_index (text, w1);
+
+    hb_buffer_destroy (window);
+    window = hb_buffer_create_similar (buffer);
+    hb_buffer_flags_t flags = (hb_buffer_flags_t) (buffer->flags & ~HB_BUFFER_FLAG_VERIFY);
+    if (text_start)
+      flags = (hb_buffer_flags_t) (flags & ~HB_BUFFER_FLAG_BOT);
+    if (text_end < text->len)
+      flags = (hb_buffer_flags_t) (flags & ~HB_BUFFER_FLAG_EOT);
+    hb_buffer_set_flags (window, flags);
+    hb_buffer_set_segment_properties (window, &buffer->props);
+    hb_buffer_append (window, text, text_start, text_end);
+
+    if (unlikely (!window->successful) ||
+	!hb_shape_full (font, window, features, num_features, shaper_list) ||
+	unlikely (!window->successful))
+      break;
+
+    if (k0 != w0 &&
+	!(_hb_buffer_reshape_safe_to_break_before (window, k0) &&
+	  _hb_buffer_reshape_same (window, w0, k0, buffer, w0, k0, 0)))
+      continue;
+    if (k1 != w1 &&
+	!(_hb_buffer_reshape_safe_to_break_before (window, k1) &&
+	  _hb_buffer_reshape_same (window, k1, w1, buffer, old_k1, old_w1, delta)))
+      continue;
+
+    /* Splice.  Pieces are listed in logical order. */
+    struct { const hb_buffer_t *b; unsigned int lo, hi; int delta; } pieces[3] = {
+      {buffer, 0, k0, 0},
+      {window, k0, k1, 0},
+      {buffer, old_k1, UINT_MAX, delta},
+    };
+    hb_vector_t<hb_glyph_info_t> info;
+    hb_vector_t<hb_glyph_position_t> pos;
+    bool forward = HB_DIRECTION_IS_FORWARD (buffer->props.direction);
+    for (unsigned int p = 0; p < 3; p++)
+    {
+      const auto &piece = pieces[forward ? p : 2 - p];
+      unsigned int s, e;
+      _hb_buffer_reshape_range (piece.b, piece.lo, piece.hi, &s, &e);
+      for (unsigned int i = s; i < e; i++)
+      {
+	hb_glyph_info_t *glyph = info.push (piece.b->info[i]);
+	glyph->cluster += piece.delta;
+	pos.push (piece.b->pos[i]);
+      }
+    }
+    if (unlikely (info.in_error () || pos.in_error () ||
+		  !buffer->ensure (info.length)))
+      break;
+
+    hb_memcpy (buffer->info, info.arrayZ, info.get_size ());
+    hb_memcpy (buffer->pos, pos.arrayZ, pos.get_size ());
+    buffer->len = info.length;
+    spliced = true;
+    break;
+  }
+  hb_buffer_destroy (window);
+
+  if (!spliced)
+    return _hb_buffer_reshape_all (buffer, text, font, features, num_features, shaper_list);
+
+#ifndef HB_NO_BUFFER_VERIFY
+  if (buffer->flags & HB_BUFFER_FLAG_VERIFY)
+    buffer->verify_reshape (text, font, features, num_features, shaper_list);
+#endif
+
+  return true;
+}
+
+
+#endif
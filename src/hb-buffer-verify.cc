@@ -420,4 +420,40 @@ hb_buffer_t::verify (hb_buffer_t        *text_buffer,
 }
 
 
+/* Check that an incrementally reshaped buffer matches shaping all of
+ * the text; if not, replace it with the latter. */
+bool
+hb_buffer_t::verify_reshape (hb_buffer_t        *text_buffer,
+			     hb_font_t          *font,
+			     const hb_feature_t *features,
+			     unsigned int        num_features,
+			     const char * const *shapers)
+{
+  hb_buffer_t *reference = hb_buffer_create_similar (this);
+  hb_buffer_set_flags (reference, (hb_buffer_flags_t (hb_buffer_get_flags (reference) & ~HB_BUFFER_FLAG_VERIFY)));
+  hb_buffer_set_segment_properties (reference, &props);
+  hb_buffer_append (reference, text_buffer, 0, -1);
+
+  bool ret = true;
+  if (hb_shape_full (font, reference, features, num_features, shapers) &&
+      likely (reference->successful))
+  {
+    hb_buffer_diff_flags_t diff = hb_buffer_diff (this, reference, (hb_codepoint_t) -1, 0);
+    if (diff & ~HB_BUFFER_DIFF_FLAG_GLYPH_FLAGS_MISMATCH)
+    {
+      buffer_verify_error (this, font, BUFFER_VERIFY_ERROR "incremental reshape test failed.");
+      ret = false;
+
+      /* Return the correct result instead. */
+      hb_buffer_set_length (this, 0);
+      hb_buffer_append (this, reference, 0, -1);
+    }
+  }
+
+  hb_buffer_destroy (reference);
+
+  return ret;
+}
+
+
 #endif
@@ -848,6 +848,7 @@ hb_buffer_destroy (hb_buffer_t *buffer)
   if (buffer->message_destroy)
     buffer->message_destroy (buffer->message_data);
 #endif
+  hb_shape_profile_destroy (buffer->profile);
 
   hb_free (buffer);
 }
@@ -1814,6 +1815,40 @@ hb_buffer_add_utf (hb_buffer_t  *buffer,
 
   const T *next = text + item_offset;
   const T *end = next + item_length;
+
+  /* Copy runs of code units that are characters as is, ie. ASCII in
+   * UTF-8, straight into the buffer.  Stop looking for runs after a few
+   * misses in a row, and decode the rest with the plain loop below, so
+   * that mostly non-ASCII text does not pay for it. */
+  unsigned int direct_misses = 0;
+  while (next < end && direct_misses < 4)
+  {
+    unsigned int direct_len = utf_t::direct_len (next, end);
+    if (direct_len >= 4 && likely (buffer->ensure (buffer->len + direct_len)))
+    {
+      hb_glyph_info_t *info = buffer->info + buffer->len;
+      unsigned int cluster = next - text;
+      hb_memset (info, 0, direct_len * sizeof (info[0]));
+      for (unsigned int i = 0; i < direct_len; i++)
+      {
+	info[i].codepoint = next[i];
+	info[i].cluster = cluster + i;
+      }
+      buffer->len += direct_len;
+      next += direct_len;
+      direct_misses = 0;
+      if (next == end)
+	break;
+    }
+    else
+      direct_misses++;
+
+    hb_codepoint_t u;
+    const T *old_next = next;
+    next = utf_t::next (next, end, &u, replacement);
+    buffer->add (u, old_next - (const T *) text);
+  }
+
   while (next < end)
   {
     hb_codepoint_t u;
@@ -53,6 +53,8 @@ enum hb_buffer_scratch_flags_t {
   HB_BUFFER_SCRATCH_FLAG_HAS_GLYPH_FLAGS		= 0x00000020u,
   HB_BUFFER_SCRATCH_FLAG_HAS_BROKEN_SYLLABLE		= 0x00000040u,
   HB_BUFFER_SCRATCH_FLAG_HAS_VARIATION_SELECTOR_FALLBACK= 0x00000080u,
+  HB_BUFFER_SCRATCH_FLAG_USED_CONTEXT			= 0x00000100u,
+  HB_BUFFER_SCRATCH_FLAG_HAS_UNICODE_MARKS		= 0x00000200u,
 
   /* Reserved for shapers' internal use. */
   HB_BUFFER_SCRATCH_FLAG_SHAPER0			= 0x01000000u,
@@ -138,6 +140,12 @@ struct hb_buffer_t
   static constexpr unsigned message_depth = 0u;
 #endif
 
+  /*
+   * Profiling
+   */
+
+  hb_shape_profile_t *profile;
+
 
 
   /* Methods */
@@ -221,6 +229,20 @@ struct hb_buffer_t
   { return true; }
 #endif
 
+#ifndef HB_NO_BUFFER_VERIFY
+  HB_INTERNAL
+#endif
+  bool verify_reshape (hb_buffer_t        *text_buffer,
+		       hb_font_t          *font,
+		       const hb_feature_t *features,
+		       unsigned int        num_features,
+		       const char * const *shapers)
+#ifndef HB_NO_BUFFER_VERIFY
+  ;
+#else
+  { return true; }
+#endif
+
   unsigned int backtrack_len () const { return have_output ? out_len : idx; }
   unsigned int lookahead_len () const { return len - idx; }
   uint8_t next_serial () { return ++serial ? serial : ++serial; }
@@ -564,6 +586,14 @@ struct hb_buffer_t
     return false;
 #else
     return unlikely (message_func);
+#endif
+  }
+  bool profiling () const
+  {
+#ifdef HB_NO_SHAPE_PROFILE
+    return false;
+#else
+    return unlikely (profile);
 #endif
   }
   bool message (hb_font_t *font, const char *fmt, ...) HB_PRINTF_FUNC(3, 4)
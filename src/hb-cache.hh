@@ -96,4 +96,124 @@ struct hb_cache_t
 };
 
 
+/* Implements a lockfree set-associative cache for int->int functions,
+ * sized at runtime.
+ *
+ * The low bits of the key pick a set of num_ways items.  Each item
+ * packs the rest of the key above the value, like hb_cache_t does, so
+ * every item read is self-consistent without locking.  New items enter
+ * at the front of their set, pushing the oldest one out.  Lookups only
+ * read, so threads sharing the cache don't contend for lines they hit
+ * in, and compare all ways of the set without branching, so hits cost
+ * the same wherever in the set they are.
+ *
+ * Hit and miss counters are only kept if asked for at init(), since
+ * every reader writing them would share their cache line between all
+ * threads.  They are updated with relaxed loads and stores and can lose
+ * counts under contention.
+ */
+
+template <unsigned int key_bits=21,
+	  unsigned int value_bits=16>
+struct hb_set_associative_cache_t
+{
+  static constexpr unsigned MAX_WAYS = 8;
+  /* Enough set bits that the rest of the key fits next to the value. */
+  static constexpr unsigned MIN_SET_BITS = key_bits + value_bits > 32 ? key_bits + value_bits - 32 : 0;
+
+  static_assert ((key_bits < 32 && value_bits < 32), "");
+
+  hb_set_associative_cache_t () = default;
+  hb_set_associative_cache_t (const hb_set_associative_cache_t &) = delete;
+  ~hb_set_associative_cache_t () { fini (); }
+
+  /* Rounds num_entries and num_ways down to powers of two. */
+  bool init (unsigned int num_entries, unsigned int num_ways, bool keep_stats_ = false)
+  {
+    fini ();
+
+    keep_stats = keep_stats_;
+
+    way_bits = 0;
+    while ((2u << way_bits) <= hb_min (num_ways, MAX_WAYS))
+      way_bits++;
+    set_bits = 0;
+    while ((2u << (set_bits + way_bits)) <= num_entries && set_bits + way_bits < 24)
+      set_bits++;
+    set_bits = hb_max (set_bits, MIN_SET_BITS);
+
+    unsigned count = 1u << (set_bits + way_bits);
+    values = (hb_atomic_int_t *) hb_malloc (count * sizeof (values[0]));
+    if (unlikely (!values))
+      return false;
+    clear ();
+    return true;
+  }
+
+  void fini ()
+  {
+    hb_free (values);
+    values = nullptr;
+  }
+
+  void clear ()
+  {
+    unsigned count = get_num_entries ();
+    for (unsigned i = 0; i < count; i++)
+      values[i].set_relaxed (-1);
+    hits.set_relaxed (0);
+    misses.set_relaxed (0);
+  }
+
+  unsigned int get_num_entries () const { return values ? 1u << (set_bits + way_bits) : 0; }
+  unsigned int get_num_ways () const { return values ? 1u << way_bits : 0; }
+  unsigned int get_hits () const { return hits.get_relaxed (); }
+  unsigned int get_misses () const { return misses.get_relaxed (); }
+
+  bool get (unsigned int key, unsigned int *value) const
+  {
+    if (unlikely (key >> key_bits))
+      return false;
+    const hb_atomic_int_t *set = values + ((key & ((1u << set_bits) - 1)) << way_bits);
+    unsigned tag = key >> set_bits;
+    unsigned ways = 1u << way_bits;
+    unsigned found = (unsigned) -1;
+    for (unsigned i = 0; i < ways; i++)
+    {
+      unsigned item = set[i].get_relaxed ();
+      found = (item >> value_bits) == tag ? item : found;
+    }
+    if (found != (unsigned) -1)
+    {
+      *value = found & ((1u << value_bits) - 1);
+      if (unlikely (keep_stats))
+	hits.set_relaxed (hits.get_relaxed () + 1);
+      return true;
+    }
+    if (unlikely (keep_stats))
+      misses.set_relaxed (misses.get_relaxed () + 1);
+    return false;
+  }
+
+  bool set (unsigned int key, unsigned int value)
+  {
+    if (unlikely ((key >> key_bits) || (value >> value_bits)))
+      return false; /* Overflows */
+    hb_atomic_int_t *set = values + ((key & ((1u << set_bits) - 1)) << way_bits);
+    for (unsigned i = (1u << way_bits) - 1; i; i--)
+      set[i].set_relaxed (set[i - 1].get_relaxed ());
+    set[0].set_relaxed ((int) (((key >> set_bits) << value_bits) | value));
+    return true;
+  }
+
+  private:
+  unsigned set_bits = 0;
+  unsigned way_bits = 0;
+  bool keep_stats = false;
+  hb_atomic_int_t *values = nullptr;
+  mutable hb_atomic_int_t hits;
+  mutable hb_atomic_int_t misses;
+};
+
+
 #endif /* HB_CACHE_HH */
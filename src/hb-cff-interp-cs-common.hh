@@ -28,6 +28,8 @@
 
 #include "hb.hh"
 #include "hb-cff-interp-common.hh"
+#include "hb-map.hh"
+#include "hb-mutex.hh"
 
 namespace CFF {
 
@@ -872,6 +874,262 @@ struct path_procs_t
   }
 };
 
+static inline bool is_number_op (op_code_t op)
+{ return op == OpCode_shortint || (OpCode_OneByteIntFirst <= op && op <= OpCode_fixedcs); }
+
+/* Records a charstring with its subroutine calls inlined and its numbers
+ * decoded, as cs_interpreter_t::record() runs it.  Replaying that does what
+ * interpreting the charstring does, without fetching or decoding any byte;
+ * nothing in it depends on the variation coordinates.  Charstrings that do
+ * not fit are not recorded. */
+struct charstring_recorder_t
+{
+  static constexpr unsigned int MAX_OPS = 1024;
+  static constexpr unsigned int MAX_MASK_BYTES = 256;
+
+  template <typename ENV>
+  void record (op_code_t op, ENV &env, unsigned int offset)
+  {
+    if (unlikely (!valid))
+      return;
+
+    switch (op) {
+      case OpCode_return:
+	break;
+
+      case OpCode_callsubr:
+      case OpCode_callgsubr:
+	/* The subroutine number is the last number recorded, unless the
+	 * stack top was computed (a blend); that we cannot inline. */
+	if (likely (num_ops && is_number_op (ops[num_ops - 1])))
+	{
+	  num_ops--;
+	  num_numbers--;
+	}
+	else
+	  valid = false;
+	break;
+
+      case OpCode_hintmask:
+      case OpCode_cntrmask:
+	/* Without enough mask bytes the interpreter skips the mask. */
+	if (unlikely (env.str_ref.get_offset () != offset + env.hintmask_size ||
+		      num_masks + env.hintmask_size > MAX_MASK_BYTES))
+	{
+	  valid = false;
+	  break;
+	}
+	push_op (op);
+	hb_memcpy (masks + num_masks,
+		   env.str_ref.sub_array (offset, env.hintmask_size).arrayZ,
+		   env.hintmask_size);
+	num_masks += env.hintmask_size;
+	break;
+
+      default:
+	push_op (op);
+	/* Charstring numbers are integers or 16.16; both fit the latter. */
+	if (is_number_op (op) && likely (valid))
+	  numbers[num_numbers++] = env.argStack.peek ().to_fixed ();
+	break;
+    }
+  }
+
+  void push_op (op_code_t op)
+  {
+    if (unlikely (num_ops == MAX_OPS))
+      valid = false;
+    else
+      ops[num_ops++] = op;
+  }
+
+  bool valid = true;
+  unsigned int num_ops = 0;
+  unsigned int num_numbers = 0;
+  unsigned int num_masks = 0;
+  int32_t numbers[MAX_OPS];	/* One per number op, in 16.16. */
+  uint16_t ops[MAX_OPS];
+  uint8_t masks[MAX_MASK_BYTES];	/* Hint mask bytes, in order. */
+};
+
+/* A recorded charstring, in one allocation. */
+struct decoded_charstring_t
+{
+  static decoded_charstring_t *create (hb_codepoint_t glyph,
+				       const charstring_recorder_t &rec)
+  {
+    unsigned int size = sizeof (decoded_charstring_t) +
+			rec.num_numbers * sizeof (int32_t) +
+			rec.num_ops * sizeof (uint16_t) +
+			rec.num_masks;
+    auto *cs = (decoded_charstring_t *) hb_malloc (size);
+    if (unlikely (!cs))
+      return nullptr;
+    cs->ref_count.set_relaxed (1);
+    cs->glyph = glyph;
+    cs->size = size;
+    cs->num_ops = rec.num_ops;
+    int32_t *numbers = (int32_t *) (cs + 1);
+    uint16_t *ops = (uint16_t *) (numbers + rec.num_numbers);
+    uint8_t *masks = (uint8_t *) (ops + rec.num_ops);
+    hb_memcpy (numbers, rec.numbers, rec.num_numbers * sizeof (int32_t));
+    hb_memcpy (ops, rec.ops, rec.num_ops * sizeof (uint16_t));
+    hb_memcpy (masks, rec.masks, rec.num_masks);
+    cs->numbers = numbers;
+    cs->ops = ops;
+    cs->masks = hb_ubytes_t (masks, rec.num_masks);
+    return cs;
+  }
+
+  decoded_charstring_t *reference ()
+  {
+    ref_count.inc ();
+    return this;
+  }
+
+  void destroy ()
+  {
+    if (ref_count.dec () != 1)
+      return;
+    hb_free (this);
+  }
+
+  hb_atomic_int_t ref_count;
+  hb_codepoint_t glyph;
+  unsigned int size;
+  unsigned int num_ops;
+  decoded_charstring_t *prev;	/* LRU list, under the cache mutex. */
+  decoded_charstring_t *next;
+  const int32_t *numbers;
+  const uint16_t *ops;
+  hb_ubytes_t masks;
+};
+
+/* Per-face cache of decoded charstrings, least recently used ones evicted
+ * once they together exceed a byte budget.  Once full, it only records
+ * glyphs while hits are not rare; going over more glyphs than fit, over and
+ * over, would otherwise pay for recording and evicting on every glyph. */
+struct charstring_cache_t
+{
+  static constexpr unsigned int MAX_BYTES = 4u << 20;
+
+  static charstring_cache_t *create ()
+  {
+    auto *cache = (charstring_cache_t *) hb_calloc (1, sizeof (charstring_cache_t));
+    if (unlikely (!cache))
+      return nullptr;
+    new (cache) charstring_cache_t ();
+    return cache;
+  }
+
+  void destroy ()
+  {
+    while (head)
+      evict (head);
+    this->~charstring_cache_t ();
+    hb_free (this);
+  }
+
+  /* Interprets the charstring of glyph, replaying it if it was decoded
+   * before and recording it otherwise. */
+  template <typename INTERP, typename PARAM>
+  bool interpret (hb_codepoint_t glyph, INTERP &interp, PARAM &param)
+  {
+    bool admit;
+    decoded_charstring_t *cs = get (glyph, &admit);
+    if (cs)
+    {
+      bool ret = interp.replay (param, *cs);
+      cs->destroy ();
+      return ret;
+    }
+    if (!admit)
+      return interp.interpret (param);
+
+    charstring_recorder_t rec;
+    if (!interp.record (param, rec))
+      return false;
+    if (rec.valid && (cs = decoded_charstring_t::create (glyph, rec)))
+    {
+      set (cs);
+      cs->destroy ();
+    }
+    return true;
+  }
+
+  private:
+  decoded_charstring_t *get (hb_codepoint_t glyph, bool *admit)
+  {
+    hb_lock_t lock (mutex);
+    /* Recent history weighs most. */
+    if (hits + misses >= 4096)
+    {
+      hits /= 2;
+      misses /= 2;
+    }
+    decoded_charstring_t *cs = map.get (glyph);
+    if (!cs)
+    {
+      misses++;
+      *admit = bytes < MAX_BYTES - MAX_BYTES / 16 ||
+	       hits * 8 >= misses ||
+	       misses % 16 == 0;
+      return nullptr;
+    }
+    hits++;
+    unlink (cs);
+    link (cs);
+    return cs->reference ();
+  }
+
+  void set (decoded_charstring_t *cs)
+  {
+    hb_lock_t lock (mutex);
+    if (map.has (cs->glyph))
+      return;
+    if (unlikely (!map.set (cs->glyph, cs)))
+      return;
+    link (cs->reference ());
+    bytes += cs->size;
+    while (bytes > MAX_BYTES)
+      evict (tail);
+  }
+
+  void evict (decoded_charstring_t *cs)
+  {
+    map.del (cs->glyph);
+    unlink (cs);
+    bytes -= cs->size;
+    cs->destroy ();
+  }
+
+  /* Most recently used first. */
+  void link (decoded_charstring_t *cs)
+  {
+    cs->prev = nullptr;
+    cs->next = head;
+    if (head) head->prev = cs;
+    else tail = cs;
+    head = cs;
+  }
+
+  void unlink (decoded_charstring_t *cs)
+  {
+    if (cs->prev) cs->prev->next = cs->next;
+    else head = cs->next;
+    if (cs->next) cs->next->prev = cs->prev;
+    else tail = cs->prev;
+  }
+
+  hb_mutex_t mutex;
+  hb_hashmap_t<hb_codepoint_t, decoded_charstring_t *> map;
+  decoded_charstring_t *head = nullptr;
+  decoded_charstring_t *tail = nullptr;
+  unsigned int bytes = 0;
+  unsigned int hits = 0;
+  unsigned int misses = 0;
+};
+
 template <typename ENV, typename OPSET, typename PARAM>
 struct cs_interpreter_t : interpreter_t<ENV>
 {
@@ -896,6 +1154,56 @@ struct cs_interpreter_t : interpreter_t<ENV>
     return true;
   }
 
+  /* Like interpret(), recording the charstring into rec as it goes. */
+  bool record (PARAM& param, charstring_recorder_t &rec)
+  {
+    SUPER::env.set_endchar (false);
+
+    unsigned max_ops = HB_CFF_MAX_OPS;
+    for (;;) {
+      op_code_t op = SUPER::env.fetch_op ();
+      unsigned int offset = SUPER::env.str_ref.get_offset ();
+      OPSET::process_op (op, SUPER::env, param);
+      if (unlikely (SUPER::env.in_error () || !--max_ops))
+      {
+	SUPER::env.set_error ();
+	return false;
+      }
+      rec.record (op, SUPER::env, offset);
+      if (SUPER::env.is_endchar ())
+	break;
+    }
+
+    return true;
+  }
+
+  /* Like interpret(), on a charstring decoded by record(). */
+  bool replay (PARAM& param, const decoded_charstring_t &cs)
+  {
+    SUPER::env.set_endchar (false);
+    /* Only hint masks read the string now. */
+    SUPER::env.str_ref.reset (cs.masks);
+
+    const int32_t *number = cs.numbers;
+    for (unsigned int i = 0; i < cs.num_ops; i++)
+    {
+      op_code_t op = cs.ops[i];
+      if (is_number_op (op))
+	SUPER::env.argStack.push_fixed (*number++);
+      else
+	OPSET::process_op (op, SUPER::env, param);
+      if (unlikely (SUPER::env.in_error ()))
+      {
+	SUPER::env.set_error ();
+	return false;
+      }
+      if (SUPER::env.is_endchar ())
+	return true;
+    }
+
+    return false;
+  }
+
   private:
   typedef interpreter_t<ENV> SUPER;
 };
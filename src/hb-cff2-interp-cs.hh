@@ -70,11 +70,13 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
 {
   template <typename ACC>
   cff2_cs_interp_env_t (const hb_ubytes_t &str, ACC &acc, unsigned int fd,
-			const int *coords_=nullptr, unsigned int num_coords_=0)
+			const int *coords_=nullptr, unsigned int num_coords_=0,
+			const float *region_scalars_=nullptr)
     : SUPER (str, acc.globalSubrs, acc.privateDicts[fd].localSubrs)
   {
     coords = coords_;
     num_coords = num_coords_;
+    region_scalars = region_scalars_;
     varStore = acc.varStore;
     do_blend = num_coords && coords && varStore->size;
     set_ivs (acc.privateDicts[fd].ivs);
@@ -114,11 +116,16 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
       region_count = varStore->varStore.get_region_index_count (get_ivs ());
       if (do_blend)
       {
-	if (unlikely (!scalars.resize_exact (region_count)))
-	  SUPER::set_error ();
-	else
+	if (region_scalars)
+	  blend_scalars = varStore->varStore.get_region_scalars (get_ivs (), region_scalars, scalars);
+	else if (likely (scalars.resize_exact (region_count)))
+	{
 	  varStore->varStore.get_region_scalars (get_ivs (), coords, num_coords,
-						 &scalars[0], region_count);
+						 scalars.arrayZ, region_count);
+	  blend_scalars = scalars.as_array ();
+	}
+	if (unlikely (blend_scalars.length != region_count))
+	  SUPER::set_error ();
       }
       seen_blend = true;
     }
@@ -149,11 +156,11 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
     double v = 0;
     if (do_blend)
     {
-      if (likely (scalars.length == deltas.length))
+      if (likely (blend_scalars.length == deltas.length))
       {
-        unsigned count = scalars.length;
+        unsigned count = blend_scalars.length;
 	for (unsigned i = 0; i < count; i++)
-	  v += (double) scalars.arrayZ[i] * deltas.arrayZ[i].to_real ();
+	  v += (double) blend_scalars.arrayZ[i] * deltas.arrayZ[i].to_real ();
       }
     }
     return v;
@@ -167,7 +174,9 @@ struct cff2_cs_interp_env_t : cs_interp_env_t<ELEM, CFF2Subrs>
   const	 CFF2ItemVariationStore *varStore;
   unsigned int  region_count;
   unsigned int  ivs;
-  hb_vector_t<float>  scalars;
+  const float	*region_scalars;	/* Of all regions, if known up front. */
+  hb_array_t<const float> blend_scalars;
+  hb_vector_t<float>  scalars;	/* Storage for blend_scalars. */
   bool	  do_blend;
   bool	  seen_vsindex_ = false;
   bool	  seen_blend = false;
@@ -64,6 +64,7 @@ _hb_options_init ()
 	if (0 == strncmp (c, name, p - c) && strlen (name) == static_cast<size_t>(p - c)) do { u.opts.symbol = true; } while (0)
 
       OPTION ("uniscribe-bug-compatible", uniscribe_bug_compatible);
+      OPTION ("no-gvar-cache", no_gvar_cache);
 
 #undef OPTION
 
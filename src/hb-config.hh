@@ -84,6 +84,7 @@
 #define HB_NO_OT_SHAPE_FRACTIONS
 #define HB_NO_PAINT
 #define HB_NO_SETLOCALE
+#define HB_NO_SHAPE_PROFILE
 #define HB_NO_STYLE
 #define HB_NO_SUBSET_LAYOUT
 #define HB_NO_VERTICAL
@@ -194,6 +195,10 @@
 #define HB_NO_OT_LAYOUT_LOOKUP_CACHE
 #define HB_NO_OT_FONT_ADVANCE_CACHE
 #define HB_NO_OT_FONT_CMAP_CACHE
+#define HB_NO_OT_FONT_EXTENTS_CACHE
+#define HB_NO_OT_FONT_OUTLINE_CACHE
+#define HB_NO_GVAR_CACHE
+#define HB_NO_CFF_CHARSTRING_CACHE
 #endif
 
 #ifdef HB_OPTIMIZE_SIZE
@@ -311,12 +311,10 @@ hb_face_destroy (hb_face_t *face)
   if (!hb_object_destroy (face)) return;
 
 #ifndef HB_NO_SHAPER
-  for (hb_face_t::plan_node_t *node = face->shape_plans; node; )
+  if (hb_shape_plan_cache_t *shape_plans = face->shape_plans)
   {
-    hb_face_t::plan_node_t *next = node->next;
-    hb_shape_plan_destroy (node->shape_plan);
-    hb_free (node);
-    node = next;
+    shape_plans->~hb_shape_plan_cache_t ();
+    hb_free (shape_plans);
   }
 #endif
 
@@ -64,13 +64,8 @@ struct hb_face_t
   hb_ot_face_t table;			/* All the face's tables. */
 
   /* Cache */
-  struct plan_node_t
-  {
-    hb_shape_plan_t *shape_plan;
-    plan_node_t *next;
-  };
 #ifndef HB_NO_SHAPER
-  hb_atomic_ptr_t<plan_node_t> shape_plans;
+  hb_atomic_ptr_t<hb_shape_plan_cache_t> shape_plans; /* Created on first use. */
 #endif
 
   hb_blob_t *reference_table (hb_tag_t tag) const
@@ -1880,6 +1880,7 @@ _hb_font_adopt_var_coords (hb_font_t *font,
   font->design_coords = design_coords;
   font->num_coords = coords_length;
 
+  font->var_store_scalars_fini ();
   font->mults_changed (); // Easiest to call this to drop cached data
 }
 
@@ -1987,6 +1988,7 @@ hb_font_destroy (hb_font_t *font)
   if (!hb_object_destroy (font)) return;
 
   font->data.fini ();
+  font->var_store_scalars_fini ();
 
   if (font->destroy)
     font->destroy (font->user_data);
@@ -2197,6 +2199,7 @@ hb_font_set_face (hb_font_t *font,
 
   hb_face_make_immutable (face);
   font->face = hb_face_reference (face);
+  font->var_store_scalars_fini ();
   font->mults_changed ();
 
   hb_face_destroy (old);
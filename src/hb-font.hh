@@ -145,6 +145,21 @@ struct hb_font_t
 
   hb_shaper_object_dataset_t<hb_font_t> data; /* Various shaper data. */
 
+  /* Region scalars of the face's item-variation stores at coords.
+   * Computed on first use and shared by all readers until the
+   * coordinates change. */
+  enum var_store_t
+  {
+    VAR_STORE_HVAR,
+    VAR_STORE_VVAR,
+    VAR_STORE_MVAR,
+    VAR_STORE_GDEF,
+    VAR_STORE_CFF2,
+
+    VAR_STORE_COUNT
+  };
+  hb_atomic_ptr_t<float> var_store_scalars[VAR_STORE_COUNT];
+
 
   /* Convert from font-space to user-space */
   int64_t dir_mult (hb_direction_t direction)
@@ -686,6 +701,42 @@ struct hb_font_t
     return false;
   }
 
+  /* Returns the region scalars of store, a cache that is never written
+   * to, or nullptr if the font is not varied. */
+  template <typename Store>
+  float *get_var_store_scalars (var_store_t which, const Store &store)
+  {
+#ifdef HB_NO_VAR
+    return nullptr;
+#endif
+    if (!num_coords)
+      return nullptr;
+
+  retry:
+    float *scalars = var_store_scalars[which].get_acquire ();
+    if (likely (scalars))
+      return scalars;
+
+    scalars = store.create_cache (hb_array (coords, num_coords));
+    if (unlikely (!scalars))
+      return nullptr;
+    if (unlikely (!var_store_scalars[which].cmpexch (nullptr, scalars)))
+    {
+      Store::destroy_cache (scalars);
+      goto retry;
+    }
+    return scalars;
+  }
+
+  void var_store_scalars_fini ()
+  {
+    for (auto &scalars : var_store_scalars)
+    {
+      hb_free (scalars.get_relaxed ());
+      scalars.set_relaxed (nullptr);
+    }
+  }
+
   void mults_changed ()
   {
     float upem = face->get_upem ();
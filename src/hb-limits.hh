@@ -54,6 +54,34 @@
 #endif
 
 
+#ifndef HB_SHAPE_PLAN_CACHE_MAX_PLANS
+#define HB_SHAPE_PLAN_CACHE_MAX_PLANS 128
+#endif
+
+#ifndef HB_OT_LAYOUT_COVERAGE_BITMAP_BUDGET
+#define HB_OT_LAYOUT_COVERAGE_BITMAP_BUDGET (256 * 1024) /* Bytes, per face and table. */
+#endif
+
+#ifndef HB_OT_LAYOUT_COVERAGE_BITMAP_SAMPLES
+#define HB_OT_LAYOUT_COVERAGE_BITMAP_SAMPLES 1024
+#endif
+
+#ifndef HB_OT_LAYOUT_DENSE_SUBST_BUDGET
+#define HB_OT_LAYOUT_DENSE_SUBST_BUDGET (256 * 1024) /* Bytes, per face and table. */
+#endif
+
+#ifndef HB_OT_LAYOUT_DENSE_SUBST_MIN_GLYPHS
+#define HB_OT_LAYOUT_DENSE_SUBST_MIN_GLYPHS 8
+#endif
+
+#ifndef HB_OT_LAYOUT_DENSE_SUBST_MAX_SPARSENESS
+#define HB_OT_LAYOUT_DENSE_SUBST_MAX_SPARSENESS 32 /* Table entries per covered glyph. */
+#endif
+
+#ifndef HB_OT_LAYOUT_GLYPH_MAPS_BUDGET
+#define HB_OT_LAYOUT_GLYPH_MAPS_BUDGET (512 * 1024) /* Bytes, per face and table. */
+#endif
+
 #ifndef HB_MAX_CONTEXT_LENGTH
 #define HB_MAX_CONTEXT_LENGTH 64
 #endif
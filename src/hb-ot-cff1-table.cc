@@ -398,7 +398,7 @@ bool _get_bounds (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph, boun
   env.set_in_seac (in_seac);
   cff1_cs_interpreter_t<cff1_cs_opset_extents_t, cff1_extents_param_t> interp (env);
   cff1_extents_param_t param (cff);
-  if (unlikely (!interp.interpret (param))) return false;
+  if (unlikely (!cff->interpret (glyph, interp, param))) return false;
   bounds = param.bounds;
   return true;
 }
@@ -545,7 +545,7 @@ bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoin
   env.set_in_seac (in_seac);
   cff1_cs_interpreter_t<cff1_cs_opset_path_t, cff1_path_param_t> interp (env);
   cff1_path_param_t param (cff, font, draw_session, delta);
-  if (unlikely (!interp.interpret (param))) return false;
+  if (unlikely (!cff->interpret (glyph, interp, param))) return false;
 
   /* Let's end the path specially since it is called inside seac also */
   param.end_path ();
@@ -1362,10 +1362,17 @@ struct cff1
       glyph_names.set_relaxed (nullptr);
 
       if (!is_valid ()) return;
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+      cs_cache = CFF::charstring_cache_t::create ();
+#endif
       if (is_CID ()) return;
     }
     ~accelerator_t ()
     {
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+      if (cs_cache)
+	cs_cache->destroy ();
+#endif
       hb_sorted_vector_t<gname_t> *names = glyph_names.get_relaxed ();
       if (names)
       {
@@ -1465,6 +1472,18 @@ struct cff1
     HB_INTERNAL bool paint_glyph (hb_font_t *font, hb_codepoint_t glyph, hb_paint_funcs_t *funcs, void *data, hb_color_t foreground) const;
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session) const;
 
+    /* Runs interp on the charstring of glyph, through the decoded
+     * charstring cache when there is one. */
+    template <typename INTERP, typename PARAM>
+    bool interpret (hb_codepoint_t glyph, INTERP &interp, PARAM &param) const
+    {
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+      if (cs_cache)
+	return cs_cache->interpret (glyph, interp, param);
+#endif
+      return interp.interpret (param);
+    }
+
     private:
     struct gname_t
     {
@@ -1486,6 +1505,10 @@ struct cff1
 
     mutable hb_atomic_ptr_t<hb_sorted_vector_t<gname_t>> glyph_names;
 
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+    CFF::charstring_cache_t *cs_cache = nullptr;
+#endif
+
     typedef accelerator_templ_t<cff1_private_dict_opset_t, cff1_private_dict_values_t> SUPER;
   };
 
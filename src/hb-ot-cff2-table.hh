@@ -513,7 +513,20 @@ struct cff2
 
   struct accelerator_t : accelerator_templ_t<cff2_private_dict_opset_t, cff2_private_dict_values_t>
   {
-    accelerator_t (hb_face_t *face) : accelerator_templ_t (face) {}
+    accelerator_t (hb_face_t *face) : accelerator_templ_t (face)
+    {
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+      if (is_valid ())
+	cs_cache = CFF::charstring_cache_t::create ();
+#endif
+    }
+    ~accelerator_t ()
+    {
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+      if (cs_cache)
+	cs_cache->destroy ();
+#endif
+    }
 
     HB_INTERNAL bool get_extents (hb_font_t *font,
 				  hb_codepoint_t glyph,
@@ -521,6 +534,32 @@ struct cff2
     HB_INTERNAL bool paint_glyph (hb_font_t *font, hb_codepoint_t glyph, hb_paint_funcs_t *funcs, void *data, hb_color_t foreground) const;
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session) const;
     HB_INTERNAL bool get_path_at (hb_font_t *font, hb_codepoint_t glyph, hb_draw_session_t &draw_session, hb_array_t<const int> coords) const;
+
+    /* The font's region scalars, if coords are the font's. */
+    const float *get_region_scalars (hb_font_t *font, hb_array_t<const int> coords) const
+    {
+      if (!varStore->size ||
+	  coords.arrayZ != font->coords || coords.length != font->num_coords)
+	return nullptr;
+      return font->get_var_store_scalars (hb_font_t::VAR_STORE_CFF2, varStore->varStore);
+    }
+
+    /* Runs interp on the charstring of glyph, through the decoded
+     * charstring cache when there is one. */
+    template <typename INTERP, typename PARAM>
+    bool interpret (hb_codepoint_t glyph, INTERP &interp, PARAM &param) const
+    {
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+      if (cs_cache)
+	return cs_cache->interpret (glyph, interp, param);
+#endif
+      return interp.interpret (param);
+    }
+
+    private:
+#ifndef HB_NO_CFF_CHARSTRING_CACHE
+    CFF::charstring_cache_t *cs_cache = nullptr;
+#endif
   };
 
   struct accelerator_subset_t : accelerator_templ_t<cff2_private_dict_opset_subset_t, cff2_private_dict_values_subset_t>
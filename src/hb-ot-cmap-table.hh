@@ -2076,9 +2076,10 @@ struct cmap
     }
     ~accelerator_t () { this->table.destroy (); }
 
+    template <typename cache_type = cache_t>
     inline bool _cached_get (hb_codepoint_t unicode,
 			     hb_codepoint_t *glyph,
-			     cache_t *cache) const
+			     cache_type *cache) const
     {
       unsigned v;
       if (cache && cache->get (unicode, &v))
@@ -2093,20 +2094,22 @@ struct cmap
       return ret;
     }
 
+    template <typename cache_type = cache_t>
     bool get_nominal_glyph (hb_codepoint_t  unicode,
 			    hb_codepoint_t *glyph,
-			    cache_t *cache = nullptr) const
+			    cache_type *cache = nullptr) const
     {
       if (unlikely (!this->get_glyph_funcZ)) return false;
       return _cached_get (unicode, glyph, cache);
     }
 
+    template <typename cache_type = cache_t>
     unsigned int get_nominal_glyphs (unsigned int count,
 				     const hb_codepoint_t *first_unicode,
 				     unsigned int unicode_stride,
 				     hb_codepoint_t *first_glyph,
 				     unsigned int glyph_stride,
-				     cache_t *cache = nullptr) const
+				     cache_type *cache = nullptr) const
     {
       if (unlikely (!this->get_glyph_funcZ)) return 0;
 
@@ -2121,10 +2124,11 @@ struct cmap
       return done;
     }
 
+    template <typename cache_type = cache_t>
     bool get_variation_glyph (hb_codepoint_t  unicode,
 			      hb_codepoint_t  variation_selector,
 			      hb_codepoint_t *glyph,
-			      cache_t *cache = nullptr) const
+			      cache_type *cache = nullptr) const
     {
       switch (this->subtable_uvs->get_glyph_variant (unicode,
 						     variation_selector,
@@ -63,23 +63,244 @@
  **/
 
 using hb_ot_font_cmap_cache_t    = hb_cache_t<21, 16, 8, true>;
+using hb_ot_font_cmap_set_cache_t = hb_set_associative_cache_t<21, 16>;
 using hb_ot_font_advance_cache_t = hb_cache_t<24, 16, 8, true>;
 
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
 static hb_user_data_key_t hb_ot_font_cmap_cache_user_data_key;
 #endif
 
+#ifndef HB_NO_OT_FONT_ADVANCE_CACHE
+/* Dense h_advance array, see hb_ot_font_set_advance_array_budget().
+ *
+ * Scaled advances are kept in pages of 256 glyphs, each filled on first
+ * use and refilled when the font serial moves on.  Pages are only freed
+ * with the array, so a page pointer, once read, stays valid. */
+struct hb_ot_font_advance_page_t
+{
+  static constexpr unsigned PAGE_BITS = 8;
+  static constexpr unsigned PAGE_SIZE = 1u << PAGE_BITS;
+  static constexpr unsigned PAGE_MASK = PAGE_SIZE - 1;
+
+  hb_atomic_int_t serial;
+  hb_atomic_int_t advances[PAGE_SIZE];
+};
+
+struct hb_ot_font_advance_array_t
+{
+  unsigned budget;
+  unsigned num_glyphs;
+  unsigned num_pages;
+  mutable hb_atomic_int_t used_bytes;
+  hb_atomic_ptr_t<hb_ot_font_advance_page_t> *pages;
+};
+
+static void
+_hb_ot_font_advance_array_destroy (hb_ot_font_advance_array_t *array)
+{
+  if (!array) return;
+  for (unsigned i = 0; i < array->num_pages; i++)
+    hb_free (array->pages[i].get_relaxed ());
+  hb_free (array->pages);
+  hb_free (array);
+}
+#endif
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+/* Direct-mapped glyph extents cache, see hb_ot_font_set_extents_cache().
+ *
+ * Entries hold scaled extents for one glyph at one font serial, so any
+ * change to the font's scale or variations leaves them stale.  An entry
+ * is too wide to store atomically; it is guarded by a sequence number
+ * that is odd while its only writer, the one holding lock, updates it.
+ * Readers retry nothing: a torn or busy entry is just a miss. */
+struct hb_ot_font_extents_cache_entry_t
+{
+  hb_atomic_int_t lock;
+  hb_atomic_int_t seq;
+  hb_atomic_int_t glyph;
+  hb_atomic_int_t serial;
+  hb_atomic_int_t x_bearing;
+  hb_atomic_int_t y_bearing;
+  hb_atomic_int_t width;
+  hb_atomic_int_t height;
+};
+
+struct hb_ot_font_extents_cache_t
+{
+  static hb_ot_font_extents_cache_t *create (unsigned num_entries)
+  {
+    auto *cache = (hb_ot_font_extents_cache_t *) hb_calloc (1, sizeof (hb_ot_font_extents_cache_t) +
+								  num_entries * sizeof (hb_ot_font_extents_cache_entry_t));
+    if (unlikely (!cache))
+      return nullptr;
+    cache->mask = num_entries - 1;
+    for (unsigned i = 0; i < num_entries; i++)
+      cache->entries[i].glyph.set_relaxed (-1);
+    return cache;
+  }
+
+  bool get (hb_codepoint_t glyph, unsigned serial, hb_glyph_extents_t *extents) const
+  {
+    const auto &e = entries[glyph & mask];
+    int seq = e.seq.get_acquire ();
+    if (seq & 1)
+      return false;
+    if (e.glyph.get_relaxed () != (int) glyph ||
+	e.serial.get_relaxed () != (int) serial)
+      return false;
+    hb_glyph_extents_t v = {e.x_bearing.get_relaxed (),
+			    e.y_bearing.get_relaxed (),
+			    e.width.get_relaxed (),
+			    e.height.get_relaxed ()};
+    _hb_memory_r_barrier ();
+    if (e.seq.get_relaxed () != seq)
+      return false;
+    *extents = v;
+    return true;
+  }
+
+  void set (hb_codepoint_t glyph, unsigned serial, const hb_glyph_extents_t *extents)
+  {
+    auto &e = entries[glyph & mask];
+    if (e.lock.inc () != 0)
+    {
+      /* Someone else is filling this entry; let them. */
+      e.lock.dec ();
+      return;
+    }
+    int seq = e.seq.get_relaxed ();
+    e.seq.set_relaxed (seq + 1);
+    _hb_memory_w_barrier ();
+    e.glyph.set_relaxed (glyph);
+    e.serial.set_relaxed (serial);
+    e.x_bearing.set_relaxed (extents->x_bearing);
+    e.y_bearing.set_relaxed (extents->y_bearing);
+    e.width.set_relaxed (extents->width);
+    e.height.set_relaxed (extents->height);
+    e.seq.set_release (seq + 2);
+    e.lock.dec ();
+  }
+
+  unsigned mask;
+  hb_ot_font_extents_cache_entry_t entries[HB_VAR_ARRAY];
+};
+#endif
+
+#if !defined(HB_NO_DRAW) && !defined(HB_NO_OT_FONT_OUTLINE_CACHE)
+/* Recorded glyph outlines, see hb_ot_font_set_outline_cache().
+ *
+ * An outline is recorded unslanted at the font scale of the time, and
+ * is only valid for the variation coordinates it was drawn at.  Entries
+ * are reference-counted so they can be replayed, and call back into the
+ * client, without holding the lock. */
+struct hb_ot_font_outline_t
+{
+  static hb_ot_font_outline_t *create ()
+  {
+    auto *outline = (hb_ot_font_outline_t *) hb_calloc (1, sizeof (hb_ot_font_outline_t));
+    if (unlikely (!outline))
+      return nullptr;
+    new (outline) hb_ot_font_outline_t ();
+    outline->ref_count.set_relaxed (1);
+    return outline;
+  }
+
+  hb_ot_font_outline_t *reference ()
+  {
+    ref_count.inc ();
+    return this;
+  }
+
+  void destroy ()
+  {
+    if (ref_count.dec () != 1)
+      return;
+    this->~hb_ot_font_outline_t ();
+    hb_free (this);
+  }
+
+  hb_atomic_int_t ref_count;
+  hb_codepoint_t glyph;
+  unsigned coords_serial;
+  float x_multf;
+  float y_multf;
+  hb_outline_t outline;
+};
+
+struct hb_ot_font_outline_cache_t
+{
+  hb_ot_font_outline_cache_t (unsigned num_entries) : mask (num_entries - 1) {}
+  ~hb_ot_font_outline_cache_t ()
+  {
+    for (auto *outline : entries)
+      if (outline)
+	outline->destroy ();
+  }
+
+  /* Returns a reference, or nullptr. */
+  hb_ot_font_outline_t *get (hb_codepoint_t glyph, unsigned coords_serial)
+  {
+    hb_lock_t lock (mutex);
+    hb_ot_font_outline_t *outline = entries[glyph & mask];
+    if (outline && outline->glyph == glyph && outline->coords_serial == coords_serial)
+    {
+      hits.inc ();
+      return outline->reference ();
+    }
+    misses.inc ();
+    return nullptr;
+  }
+
+  void set (hb_ot_font_outline_t *outline)
+  {
+    hb_ot_font_outline_t *old;
+    {
+      hb_lock_t lock (mutex);
+      old = entries[outline->glyph & mask];
+      entries[outline->glyph & mask] = outline->reference ();
+    }
+    if (old)
+      old->destroy ();
+  }
+
+  unsigned mask;
+  hb_mutex_t mutex;
+  hb_atomic_int_t hits;
+  hb_atomic_int_t misses;
+  hb_vector_t<hb_ot_font_outline_t *> entries;
+};
+#endif
+
 struct hb_ot_font_t
 {
   const hb_ot_face_t *ot_face;
 
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
   hb_ot_font_cmap_cache_t *cmap_cache;
+  /* Opt-in; replaces the per-face cmap_cache when set. */
+  hb_ot_font_cmap_set_cache_t *cmap_set_cache;
 #endif
 
   /* h_advance caching */
   mutable hb_atomic_int_t cached_coords_serial;
   mutable hb_atomic_ptr_t<hb_ot_font_advance_cache_t> advance_cache;
+
+#ifndef HB_NO_OT_FONT_ADVANCE_CACHE
+  /* Opt-in; replaces advance_cache when set. */
+  hb_ot_font_advance_array_t *advance_array;
+#endif
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  /* Opt-in; created on first use with extents_cache_entries entries. */
+  unsigned extents_cache_entries;
+  mutable hb_atomic_ptr_t<hb_ot_font_extents_cache_t> extents_cache;
+#endif
+
+#if !defined(HB_NO_DRAW) && !defined(HB_NO_OT_FONT_OUTLINE_CACHE)
+  /* Opt-in. */
+  hb_ot_font_outline_cache_t *outline_cache;
+#endif
 };
 
 static hb_ot_font_t *
@@ -91,6 +312,7 @@ _hb_ot_font_create (hb_font_t *font)
 
   ot_font->ot_face = &font->face->table;
 
+
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
   // retry:
   auto *cmap_cache  = (hb_ot_font_cmap_cache_t *) hb_face_get_user_data (font->face,
@@ -131,6 +353,30 @@ _hb_ot_font_destroy (void *font_data)
   auto *cache = ot_font->advance_cache.get_relaxed ();
   hb_free (cache);
 
+#ifndef HB_NO_OT_FONT_ADVANCE_CACHE
+  _hb_ot_font_advance_array_destroy (ot_font->advance_array);
+#endif
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  hb_free (ot_font->extents_cache.get_relaxed ());
+#endif
+
+#if !defined(HB_NO_DRAW) && !defined(HB_NO_OT_FONT_OUTLINE_CACHE)
+  if (ot_font->outline_cache)
+  {
+    ot_font->outline_cache->~hb_ot_font_outline_cache_t ();
+    hb_free (ot_font->outline_cache);
+  }
+#endif
+
+#ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (ot_font->cmap_set_cache)
+  {
+    ot_font->cmap_set_cache->~hb_ot_font_cmap_set_cache_t ();
+    hb_free (ot_font->cmap_set_cache);
+  }
+#endif
+
   hb_free (ot_font);
 }
 
@@ -145,6 +391,8 @@ hb_ot_get_nominal_glyph (hb_font_t *font HB_UNUSED,
   const hb_ot_face_t *ot_face = ot_font->ot_face;
   hb_ot_font_cmap_cache_t *cmap_cache = nullptr;
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (ot_font->cmap_set_cache)
+    return ot_face->cmap->get_nominal_glyph (unicode, glyph, ot_font->cmap_set_cache);
   cmap_cache = ot_font->cmap_cache;
 #endif
   return ot_face->cmap->get_nominal_glyph (unicode, glyph, cmap_cache);
@@ -164,6 +412,11 @@ hb_ot_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
   const hb_ot_face_t *ot_face = ot_font->ot_face;
   hb_ot_font_cmap_cache_t *cmap_cache = nullptr;
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (ot_font->cmap_set_cache)
+    return ot_face->cmap->get_nominal_glyphs (count,
+					      first_unicode, unicode_stride,
+					      first_glyph, glyph_stride,
+					      ot_font->cmap_set_cache);
   cmap_cache = ot_font->cmap_cache;
 #endif
   return ot_face->cmap->get_nominal_glyphs (count,
@@ -184,6 +437,10 @@ hb_ot_get_variation_glyph (hb_font_t *font HB_UNUSED,
   const hb_ot_face_t *ot_face = ot_font->ot_face;
   hb_ot_font_cmap_cache_t *cmap_cache = nullptr;
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (ot_font->cmap_set_cache)
+    return ot_face->cmap->get_variation_glyph (unicode,
+					       variation_selector, glyph,
+					       ot_font->cmap_set_cache);
   cmap_cache = ot_font->cmap_cache;
 #endif
   return ot_face->cmap->get_variation_glyph (unicode,
@@ -191,6 +448,56 @@ hb_ot_get_variation_glyph (hb_font_t *font HB_UNUSED,
                                              cmap_cache);
 }
 
+#ifndef HB_NO_OT_FONT_ADVANCE_CACHE
+static const hb_ot_font_advance_page_t *
+_hb_ot_font_get_advance_page (const hb_ot_font_t *ot_font,
+			      hb_font_t *font,
+			      unsigned page_index,
+			      OT::ItemVariationStore::cache_t *varStore_cache)
+{
+  const hb_ot_font_advance_array_t *array = ot_font->advance_array;
+  if (unlikely (page_index >= array->num_pages))
+    return nullptr;
+
+  hb_ot_font_advance_page_t *page = array->pages[page_index].get_acquire ();
+  if (likely (page && page->serial.get_acquire () == (int) font->serial))
+    return page;
+
+  bool fresh = !page;
+  if (fresh)
+  {
+    if (array->used_bytes.add (sizeof (*page)) + sizeof (*page) > array->budget)
+    {
+      array->used_bytes.add (-(int) sizeof (*page));
+      return nullptr;
+    }
+    page = (hb_ot_font_advance_page_t *) hb_calloc (1, sizeof (*page));
+    if (unlikely (!page))
+    {
+      array->used_bytes.add (-(int) sizeof (*page));
+      return nullptr;
+    }
+  }
+
+  /* Concurrent fills for the same serial store the same values. */
+  const OT::hmtx_accelerator_t &hmtx = *ot_font->ot_face->hmtx;
+  unsigned start = page_index << hb_ot_font_advance_page_t::PAGE_BITS;
+  unsigned end = hb_min (start + hb_ot_font_advance_page_t::PAGE_SIZE, array->num_glyphs);
+  for (unsigned g = start; g < end; g++)
+    page->advances[g - start].set_relaxed (font->em_scale_x (hmtx.get_advance_with_var_unscaled (g, font, varStore_cache)));
+  page->serial.set_release (font->serial);
+
+  if (fresh && unlikely (!array->pages[page_index].cmpexch (nullptr, page)))
+  {
+    hb_free (page);
+    array->used_bytes.add (-(int) sizeof (*page));
+    return _hb_ot_font_get_advance_page (ot_font, font, page_index, varStore_cache);
+  }
+
+  return page;
+}
+#endif
+
 static void
 hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
 			    unsigned count,
@@ -210,9 +517,9 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
 #if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
   const OT::HVAR &HVAR = *hmtx.var_table;
   const OT::ItemVariationStore &varStore = &HVAR + HVAR.varStore;
-  OT::ItemVariationStore::cache_t *varStore_cache = font->num_coords * count >= 128 ? varStore.create_cache () : nullptr;
+  OT::ItemVariationStore::cache_t *varStore_cache = font->get_var_store_scalars (hb_font_t::VAR_STORE_HVAR, varStore);
 
-  bool use_cache = font->num_coords;
+  bool use_cache = font->num_coords && !ot_font->advance_array;
 #else
   OT::ItemVariationStore::cache_t *varStore_cache = nullptr;
   bool use_cache = false;
@@ -243,6 +550,29 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
   }
   out:
 
+#ifndef HB_NO_OT_FONT_ADVANCE_CACHE
+  if (ot_font->advance_array)
+  {
+    const hb_ot_font_advance_page_t *page = nullptr;
+    unsigned page_index = (unsigned) -1;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      hb_codepoint_t glyph = *first_glyph;
+      if ((glyph >> hb_ot_font_advance_page_t::PAGE_BITS) != page_index)
+      {
+	page_index = glyph >> hb_ot_font_advance_page_t::PAGE_BITS;
+	page = _hb_ot_font_get_advance_page (ot_font, font, page_index, varStore_cache);
+      }
+      if (likely (page))
+	*first_advance = page->advances[glyph & hb_ot_font_advance_page_t::PAGE_MASK].get_relaxed ();
+      else
+	*first_advance = font->em_scale_x (hmtx.get_advance_with_var_unscaled (glyph, font, varStore_cache));
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
+    }
+  }
+  else
+#endif
   if (!use_cache)
   {
     for (unsigned int i = 0; i < count; i++)
@@ -277,10 +607,6 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
     }
   }
 
-#if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
-  OT::ItemVariationStore::destroy_cache (varStore_cache);
-#endif
-
   if (font->x_strength && !font->embolden_in_place)
   {
     /* Emboldening. */
@@ -315,7 +641,7 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
 #if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
     const OT::VVAR &VVAR = *vmtx.var_table;
     const OT::ItemVariationStore &varStore = &VVAR + VVAR.varStore;
-    OT::ItemVariationStore::cache_t *varStore_cache = font->num_coords ? varStore.create_cache () : nullptr;
+    OT::ItemVariationStore::cache_t *varStore_cache = font->get_var_store_scalars (hb_font_t::VAR_STORE_VVAR, varStore);
 #else
     OT::ItemVariationStore::cache_t *varStore_cache = nullptr;
 #endif
@@ -326,10 +652,6 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
       first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
       first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
     }
-
-#if !defined(HB_NO_VAR) && !defined(HB_NO_OT_FONT_ADVANCE_CACHE)
-    OT::ItemVariationStore::destroy_cache (varStore_cache);
-#endif
   }
   else
   {
@@ -418,14 +740,12 @@ hb_ot_get_glyph_v_origin (hb_font_t *font,
 }
 #endif
 
-static hb_bool_t
-hb_ot_get_glyph_extents (hb_font_t *font,
-			 void *font_data,
-			 hb_codepoint_t glyph,
-			 hb_glyph_extents_t *extents,
-			 void *user_data HB_UNUSED)
+static bool
+_hb_ot_get_glyph_extents_uncached (hb_font_t *font,
+				   const hb_ot_font_t *ot_font,
+				   hb_codepoint_t glyph,
+				   hb_glyph_extents_t *extents)
 {
-  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
   const hb_ot_face_t *ot_face = ot_font->ot_face;
 
 #if !defined(HB_NO_OT_FONT_BITMAP) && !defined(HB_NO_COLOR)
@@ -444,6 +764,46 @@ hb_ot_get_glyph_extents (hb_font_t *font,
   return false;
 }
 
+static hb_bool_t
+hb_ot_get_glyph_extents (hb_font_t *font,
+			 void *font_data,
+			 hb_codepoint_t glyph,
+			 hb_glyph_extents_t *extents,
+			 void *user_data HB_UNUSED)
+{
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  hb_ot_font_extents_cache_t *cache = nullptr;
+  if (ot_font->extents_cache_entries)
+  {
+  retry:
+    cache = ot_font->extents_cache.get_acquire ();
+    if (unlikely (!cache))
+    {
+      cache = hb_ot_font_extents_cache_t::create (ot_font->extents_cache_entries);
+      if (unlikely (cache && !ot_font->extents_cache.cmpexch (nullptr, cache)))
+      {
+	hb_free (cache);
+	goto retry;
+      }
+    }
+  }
+
+  if (cache && cache->get (glyph, font->serial, extents))
+    return true;
+
+  if (!_hb_ot_get_glyph_extents_uncached (font, ot_font, glyph, extents))
+    return false;
+
+  if (cache)
+    cache->set (glyph, font->serial, extents);
+  return true;
+#else
+  return _hb_ot_get_glyph_extents_uncached (font, ot_font, glyph, extents);
+#endif
+}
+
 #ifndef HB_NO_OT_FONT_GLYPH_NAMES
 static hb_bool_t
 hb_ot_get_glyph_name (hb_font_t *font HB_UNUSED,
@@ -511,9 +871,67 @@ hb_ot_get_font_v_extents (hb_font_t *font,
 #endif
 
 #ifndef HB_NO_DRAW
+static void
+_hb_ot_draw_glyph_path (hb_font_t *font,
+			hb_codepoint_t glyph,
+			hb_draw_funcs_t *draw_funcs, void *draw_data,
+			float slant)
+{
+  hb_draw_session_t draw_session (draw_funcs, draw_data, slant);
+#ifndef HB_NO_VAR_COMPOSITES
+  if (!font->face->table.VARC->get_path (font, glyph, draw_session))
+#endif
+  // Keep the following in synch with VARC::get_path_at()
+  if (!font->face->table.glyf->get_path (font, glyph, draw_session))
+#ifndef HB_NO_CFF
+  if (!font->face->table.cff2->get_path (font, glyph, draw_session))
+  if (!font->face->table.cff1->get_path (font, glyph, draw_session))
+#endif
+  {}
+}
+
+#ifndef HB_NO_OT_FONT_OUTLINE_CACHE
+/* Returns a reference to the recorded outline of glyph, recording it
+ * first if needed, or nullptr if caching is off or fails. */
+static hb_ot_font_outline_t *
+_hb_ot_font_get_outline (hb_font_t *font,
+			 const hb_ot_font_t *ot_font,
+			 hb_codepoint_t glyph)
+{
+  hb_ot_font_outline_cache_t *cache = ot_font->outline_cache;
+  /* Can't scale back from a zero scale. */
+  if (!cache || !font->x_multf || !font->y_multf)
+    return nullptr;
+
+  hb_ot_font_outline_t *outline = cache->get (glyph, font->serial_coords);
+  if (outline)
+    return outline;
+
+  outline = hb_ot_font_outline_t::create ();
+  if (unlikely (!outline))
+    return nullptr;
+  outline->glyph = glyph;
+  outline->coords_serial = font->serial_coords;
+  outline->x_multf = font->x_multf;
+  outline->y_multf = font->y_multf;
+  _hb_ot_draw_glyph_path (font, glyph,
+			  hb_outline_recording_pen_get_funcs (), &outline->outline,
+			  0.f);
+  if (unlikely (outline->outline.points.in_error () ||
+		outline->outline.contours.in_error ()))
+  {
+    outline->destroy ();
+    return nullptr;
+  }
+
+  cache->set (outline);
+  return outline;
+}
+#endif
+
 static void
 hb_ot_draw_glyph (hb_font_t *font,
-		  void *font_data HB_UNUSED,
+		  void *font_data,
 		  hb_codepoint_t glyph,
 		  hb_draw_funcs_t *draw_funcs, void *draw_data,
 		  void *user_data)
@@ -521,20 +939,24 @@ hb_ot_draw_glyph (hb_font_t *font,
   bool embolden = font->x_strength || font->y_strength;
   hb_outline_t outline;
 
-  { // Need draw_session to be destructed before emboldening.
-    hb_draw_session_t draw_session (embolden ? hb_outline_recording_pen_get_funcs () : draw_funcs,
-				    embolden ? &outline : draw_data, font->slant_xy);
-#ifndef HB_NO_VAR_COMPOSITES
-    if (!font->face->table.VARC->get_path (font, glyph, draw_session))
-#endif
-    // Keep the following in synch with VARC::get_path_at()
-    if (!font->face->table.glyf->get_path (font, glyph, draw_session))
-#ifndef HB_NO_CFF
-    if (!font->face->table.cff2->get_path (font, glyph, draw_session))
-    if (!font->face->table.cff1->get_path (font, glyph, draw_session))
-#endif
-    {}
+#ifndef HB_NO_OT_FONT_OUTLINE_CACHE
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  if (hb_ot_font_outline_t *cached = _hb_ot_font_get_outline (font, ot_font, glyph))
+  {
+    /* Exactly 1 when drawing at the recorded scale. */
+    float x_mult = font->x_multf / cached->x_multf;
+    float y_mult = font->y_multf / cached->y_multf;
+    cached->outline.replay (embolden ? hb_outline_recording_pen_get_funcs () : draw_funcs,
+			    embolden ? &outline : draw_data,
+			    x_mult, y_mult, font->slant_xy);
+    cached->destroy ();
   }
+  else
+#endif
+  _hb_ot_draw_glyph_path (font, glyph,
+			  embolden ? hb_outline_recording_pen_get_funcs () : draw_funcs,
+			  embolden ? &outline : draw_data,
+			  font->slant_xy);
 
   if (embolden)
   {
@@ -659,4 +1081,296 @@ hb_ot_font_set_funcs (hb_font_t *font)
 		     _hb_ot_font_destroy);
 }
 
+/**
+ * hb_ot_font_set_advance_array_budget:
+ * @font: #hb_font_t to work upon
+ * @max_bytes: memory budget for the advance array, or 0 to disable it
+ *
+ * Makes @font keep the horizontal advances of its glyphs, scaled, in a
+ * dense array, so that looking an advance up costs a single load.  The
+ * array is built lazily, 256 glyphs at a time, and is refilled whenever
+ * the font scale, variations, or anything else that bumps
+ * hb_font_get_serial() changes.  Once the array uses @max_bytes, advances
+ * of glyphs not covered yet are computed on every call as usual.
+ *
+ * This is worthwhile for fonts that are shaped heavily at a fixed size.
+ * It is off by default.
+ *
+ * This function works with #hb_font_t objects whose font functions were
+ * set by hb_ot_font_set_funcs(), which is the default for fonts returned
+ * by hb_font_create().
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_ot_font_set_advance_array_budget (hb_font_t    *font,
+				     unsigned int  max_bytes)
+{
+#ifndef HB_NO_OT_FONT_ADVANCE_CACHE
+  if (hb_object_is_immutable (font))
+    return;
+
+  if (unlikely (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy))
+    return;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+
+  _hb_ot_font_advance_array_destroy (ot_font->advance_array);
+  ot_font->advance_array = nullptr;
+
+  unsigned num_glyphs = font->face->get_num_glyphs ();
+  unsigned num_pages = (num_glyphs + hb_ot_font_advance_page_t::PAGE_MASK) >> hb_ot_font_advance_page_t::PAGE_BITS;
+  size_t directory_bytes = sizeof (hb_ot_font_advance_array_t) +
+			   num_pages * sizeof (hb_atomic_ptr_t<hb_ot_font_advance_page_t>);
+  if (!max_bytes || directory_bytes > max_bytes)
+    return;
+
+  auto *array = (hb_ot_font_advance_array_t *) hb_calloc (1, sizeof (hb_ot_font_advance_array_t));
+  if (unlikely (!array))
+    return;
+  array->pages = (hb_atomic_ptr_t<hb_ot_font_advance_page_t> *) hb_calloc (num_pages, sizeof (array->pages[0]));
+  if (unlikely (num_pages && !array->pages))
+  {
+    hb_free (array);
+    return;
+  }
+  array->budget = max_bytes;
+  array->num_glyphs = num_glyphs;
+  array->num_pages = num_pages;
+  array->used_bytes.set_relaxed (directory_bytes);
+
+  ot_font->advance_array = array;
+#endif
+}
+
+/**
+ * hb_ot_font_set_cmap_cache:
+ * @font: #hb_font_t to work upon
+ * @num_entries: number of cached mappings, or 0 to drop the cache
+ * @num_ways: associativity of the cache
+ * @keep_stats: whether to count hits and misses
+ *
+ * Gives @font a cache of character-to-glyph mappings of its own, in
+ * place of the small direct-mapped cache that fonts of the same face
+ * share.  @num_entries and @num_ways are rounded down to powers of two;
+ * @num_ways is capped at 8.  Characters whose low bits collide share a
+ * set of @num_ways entries instead of evicting each other, which helps
+ * text with a large working set, such as CJK or emoji.
+ *
+ * Lookups stay lock-free and only read the cache.  If @keep_stats is
+ * true, they also count hits and misses, see
+ * hb_ot_font_get_cmap_cache_stats(); the counters are shared by all
+ * threads using @font, so leave it off outside of tuning.
+ *
+ * This function works with #hb_font_t objects whose font functions were
+ * set by hb_ot_font_set_funcs(), which is the default for fonts returned
+ * by hb_font_create().
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_ot_font_set_cmap_cache (hb_font_t    *font,
+			   unsigned int  num_entries,
+			   unsigned int  num_ways,
+			   hb_bool_t     keep_stats)
+{
+#ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (hb_object_is_immutable (font))
+    return;
+
+  if (unlikely (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy))
+    return;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+
+  if (ot_font->cmap_set_cache)
+  {
+    ot_font->cmap_set_cache->~hb_ot_font_cmap_set_cache_t ();
+    hb_free (ot_font->cmap_set_cache);
+    ot_font->cmap_set_cache = nullptr;
+  }
+
+  if (!num_entries)
+    return;
+
+  auto *cache = (hb_ot_font_cmap_set_cache_t *) hb_malloc (sizeof (hb_ot_font_cmap_set_cache_t));
+  if (unlikely (!cache))
+    return;
+  new (cache) hb_ot_font_cmap_set_cache_t ();
+  if (unlikely (!cache->init (num_entries, num_ways, keep_stats)))
+  {
+    cache->~hb_ot_font_cmap_set_cache_t ();
+    hb_free (cache);
+    return;
+  }
+
+  ot_font->cmap_set_cache = cache;
+#endif
+}
+
+/**
+ * hb_ot_font_get_cmap_cache_stats:
+ * @font: #hb_font_t to work upon
+ * @hits: (out) (optional): Number of mappings found in the cache
+ * @misses: (out) (optional): Number of mappings looked up in the font
+ *
+ * Fetches usage statistics of the cache set up on @font by
+ * hb_ot_font_set_cmap_cache().  Both are zero if @font has no such cache,
+ * or if it was set up without @keep_stats.
+ * Counts can be slightly low when @font is used from several threads at
+ * once.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_ot_font_get_cmap_cache_stats (hb_font_t    *font,
+				 unsigned int *hits,
+				 unsigned int *misses)
+{
+  const hb_ot_font_cmap_set_cache_t *cache = nullptr;
+#ifndef HB_NO_OT_FONT_CMAP_CACHE
+  if (likely (font->destroy == (hb_destroy_func_t) _hb_ot_font_destroy))
+    cache = ((const hb_ot_font_t *) font->user_data)->cmap_set_cache;
+#endif
+
+  if (hits) *hits = cache ? cache->get_hits () : 0;
+  if (misses) *misses = cache ? cache->get_misses () : 0;
+}
+
+/**
+ * hb_ot_font_set_extents_cache:
+ * @font: #hb_font_t to work upon
+ * @num_entries: number of cached glyph extents, or 0 to drop the cache
+ *
+ * Gives @font a cache of the glyph extents it returns, which saves
+ * reading the outline tables again for glyphs asked about repeatedly,
+ * as when laying out or rendering the same text over and over.
+ * @num_entries is rounded down to a power of two; glyphs whose ids
+ * collide evict each other.  Each entry takes 32 bytes.  By default
+ * @font has no such cache.
+ *
+ * Cached extents are dropped whenever the scale, variations or any other
+ * property of @font changes.
+ *
+ * This function works with #hb_font_t objects whose font functions were
+ * set by hb_ot_font_set_funcs(), which is the default for fonts returned
+ * by hb_font_create().
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_ot_font_set_extents_cache (hb_font_t    *font,
+			      unsigned int  num_entries)
+{
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  if (hb_object_is_immutable (font))
+    return;
+
+  if (unlikely (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy))
+    return;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+
+  hb_free (ot_font->extents_cache.get_relaxed ());
+  ot_font->extents_cache.set_relaxed (nullptr);
+
+  unsigned entries = num_entries ? 1 : 0;
+  while (entries && entries * 2 <= hb_min (num_entries, 1u << 20))
+    entries *= 2;
+  ot_font->extents_cache_entries = entries;
+#endif
+}
+
+/**
+ * hb_ot_font_set_outline_cache:
+ * @font: #hb_font_t to work upon
+ * @num_entries: number of cached outlines, or 0 to drop the cache
+ *
+ * Makes @font record the outline of each glyph it draws and replay the
+ * recording on later hb_font_draw_glyph() calls for the same glyph,
+ * instead of decoding the glyph again.  Up to @num_entries outlines,
+ * rounded down to a power of two, are kept, by glyph id.
+ *
+ * Outlines are recorded at the scale of the time and rescaled when
+ * replayed at another scale; synthetic slant and emboldening are applied
+ * on replay.  Changing the variation coordinates of @font makes the
+ * recorded outlines stale.
+ *
+ * The cache counts hits and misses, see
+ * hb_ot_font_get_outline_cache_stats().
+ *
+ * This function works with #hb_font_t objects whose font functions were
+ * set by hb_ot_font_set_funcs(), which is the default for fonts returned
+ * by hb_font_create().
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_ot_font_set_outline_cache (hb_font_t    *font,
+			      unsigned int  num_entries)
+{
+#if !defined(HB_NO_DRAW) && !defined(HB_NO_OT_FONT_OUTLINE_CACHE)
+  if (hb_object_is_immutable (font))
+    return;
+
+  if (unlikely (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy))
+    return;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+
+  if (ot_font->outline_cache)
+  {
+    ot_font->outline_cache->~hb_ot_font_outline_cache_t ();
+    hb_free (ot_font->outline_cache);
+    ot_font->outline_cache = nullptr;
+  }
+
+  unsigned entries = num_entries ? 1 : 0;
+  while (entries && entries * 2 <= hb_min (num_entries, 1u << 20))
+    entries *= 2;
+  if (!entries)
+    return;
+
+  auto *cache = (hb_ot_font_outline_cache_t *) hb_malloc (sizeof (hb_ot_font_outline_cache_t));
+  if (unlikely (!cache))
+    return;
+  new (cache) hb_ot_font_outline_cache_t (entries);
+  if (unlikely (!cache->entries.resize (entries)))
+  {
+    cache->~hb_ot_font_outline_cache_t ();
+    hb_free (cache);
+    return;
+  }
+
+  ot_font->outline_cache = cache;
+#endif
+}
+
+/**
+ * hb_ot_font_get_outline_cache_stats:
+ * @font: #hb_font_t to work upon
+ * @hits: (out) (optional): Number of glyphs drawn from a recorded outline
+ * @misses: (out) (optional): Number of glyphs decoded from the font
+ *
+ * Fetches usage statistics of the cache set up on @font by
+ * hb_ot_font_set_outline_cache().  Both are zero if @font has no such
+ * cache.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_ot_font_get_outline_cache_stats (hb_font_t    *font,
+				    unsigned int *hits,
+				    unsigned int *misses)
+{
+  const hb_ot_font_outline_cache_t *cache = nullptr;
+#if !defined(HB_NO_DRAW) && !defined(HB_NO_OT_FONT_OUTLINE_CACHE)
+  if (likely (font->destroy == (hb_destroy_func_t) _hb_ot_font_destroy))
+    cache = ((const hb_ot_font_t *) font->user_data)->outline_cache;
+#endif
+
+  if (hits) *hits = cache ? cache->hits.get_relaxed () : 0;
+  if (misses) *misses = cache ? cache->misses.get_relaxed () : 0;
+}
+
 #endif
@@ -39,6 +39,34 @@ HB_BEGIN_DECLS
 HB_EXTERN void
 hb_ot_font_set_funcs (hb_font_t *font);
 
+HB_EXTERN void
+hb_ot_font_set_advance_array_budget (hb_font_t    *font,
+				     unsigned int  max_bytes);
+
+HB_EXTERN void
+hb_ot_font_set_cmap_cache (hb_font_t    *font,
+			   unsigned int  num_entries,
+			   unsigned int  num_ways,
+			   hb_bool_t     keep_stats);
+
+HB_EXTERN void
+hb_ot_font_get_cmap_cache_stats (hb_font_t    *font,
+				 unsigned int *hits,
+				 unsigned int *misses);
+
+HB_EXTERN void
+hb_ot_font_set_extents_cache (hb_font_t    *font,
+			      unsigned int  num_entries);
+
+HB_EXTERN void
+hb_ot_font_set_outline_cache (hb_font_t    *font,
+			      unsigned int  num_entries);
+
+HB_EXTERN void
+hb_ot_font_get_outline_cache_stats (hb_font_t    *font,
+				    unsigned int *hits,
+				    unsigned int *misses);
+
 
 HB_END_DECLS
 
@@ -2834,6 +2834,33 @@ struct VarData
       scalars[i] = 0.f;
   }
 
+  /* Picks the scalars of our regions out of the scalars of all regions.
+   * Points into those when our regions are consecutive; gathers them into
+   * storage otherwise. */
+  hb_array_t<const float> get_region_scalars (hb_array_t<const float> all_scalars,
+					      hb_vector_t<float> &storage) const
+  {
+    unsigned count = regionIndices.len;
+    if (!count)
+      return hb_array_t<const float> ();
+
+    unsigned first = regionIndices.arrayZ[0];
+    bool consecutive = first + count <= all_scalars.length;
+    for (unsigned i = 1; consecutive && i < count; i++)
+      consecutive = regionIndices.arrayZ[i] == first + i;
+    if (consecutive)
+      return all_scalars.sub_array (first, count);
+
+    if (unlikely (!storage.resize_exact (count)))
+      return hb_array_t<const float> ();
+    for (unsigned i = 0; i < count; i++)
+    {
+      unsigned region = regionIndices.arrayZ[i];
+      storage.arrayZ[i] = region < all_scalars.length ? all_scalars.arrayZ[region] : 0.f;
+    }
+    return storage.as_array ();
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
@@ -3198,6 +3225,25 @@ struct ItemVariationStore
     return cache;
   }
 
+  /* Evaluates all regions at coords up front, so the cache is never
+   * written to when used and can be shared between threads. */
+  cache_t *create_cache (hb_array_t<const int> coords) const
+  {
+#ifdef HB_NO_VAR
+    return nullptr;
+#endif
+    auto &r = this+regions;
+    unsigned count = r.regionCount;
+
+    float *cache = (float *) hb_malloc (sizeof (float) * count);
+    if (unlikely (!cache)) return nullptr;
+
+    for (unsigned i = 0; i < count; i++)
+      cache[i] = r.evaluate (i, coords.arrayZ, coords.length);
+
+    return cache;
+  }
+
   static void destroy_cache (cache_t *cache) { hb_free (cache); }
 
   private:
@@ -3403,6 +3449,20 @@ struct ItemVariationStore
 					       &scalars[0], num_scalars);
   }
 
+  /* Scalars of the regions of subtable major, out of a cache made by
+   * create_cache (coords); see VarData::get_region_scalars(). */
+  hb_array_t<const float> get_region_scalars (unsigned int major,
+					      const cache_t *cache,
+					      hb_vector_t<float> &storage) const
+  {
+#ifdef HB_NO_VAR
+    return hb_array_t<const float> ();
+#endif
+
+    return (this+dataSets[major]).get_region_scalars (hb_array (cache, (this+regions).regionCount),
+						      storage);
+  }
+
   unsigned int get_sub_table_count () const
    {
 #ifdef HB_NO_VAR
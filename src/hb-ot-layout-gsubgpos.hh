@@ -757,7 +757,7 @@ struct hb_ot_apply_context_t :
 			var_store (gdef.get_var_store ()),
 			var_store_cache (
 #ifndef HB_NO_VAR
-					 table_index == 1 && font->num_coords ? var_store.create_cache () : nullptr
+					 table_index == 1 ? font->get_var_store_scalars (hb_font_t::VAR_STORE_GDEF, var_store) : nullptr
 #else
 					 nullptr
 #endif
@@ -767,13 +767,6 @@ struct hb_ot_apply_context_t :
 			has_glyph_classes (gdef.has_glyph_classes ())
   { init_iters (); }
 
-  ~hb_ot_apply_context_t ()
-  {
-#ifndef HB_NO_VAR
-    ItemVariationStore::destroy_cache (var_store_cache);
-#endif
-  }
-
   void init_iters ()
   {
     iter_input.init (this, false);
@@ -900,6 +893,254 @@ struct hb_ot_apply_context_t :
 };
 
 
+/* Exact coverage as a flat bit array over [first, first + length).
+ *
+ * hb_set_digest_t floods when coverage is scattered over the glyph
+ * space, as in large CJK and Arabic fonts.  When that happens, most
+ * glyphs pass the digest only to fail the Coverage binary search; a
+ * bitmap rejects them with one load instead.  Not in use while words
+ * is nullptr. */
+struct hb_coverage_bitmap_t
+{
+  bool in_use () const { return words; }
+
+  bool has (hb_codepoint_t g) const
+  {
+    g -= first;
+    return g < length && (words[g / 64] & (1ull << (g % 64)));
+  }
+  bool may_have (hb_codepoint_t g) const { return has (g); }
+
+  /* Whether a bitmap for coverage is worth its memory, that is, whether
+   * the digest lets through more glyphs outside of coverage than in it.
+   * Estimated by sampling the glyph space evenly. */
+  static bool worthwhile (const hb_set_digest_t &digest,
+			  const hb_bit_set_t &coverage,
+			  unsigned num_glyphs)
+  {
+    if (coverage.is_empty () || unlikely (coverage.in_error ()))
+      return false;
+
+    unsigned step = hb_max (1u, num_glyphs / HB_OT_LAYOUT_COVERAGE_BITMAP_SAMPLES);
+    unsigned passed = 0, covered = 0;
+    for (hb_codepoint_t g = 0; g < num_glyphs; g += step)
+      if (digest.may_have (g))
+      {
+	passed++;
+	covered += coverage.has (g);
+      }
+    return passed - covered > covered;
+  }
+
+  static unsigned words_for (const hb_bit_set_t &coverage)
+  { return (coverage.get_max () - coverage.get_min ()) / 64 + 1; }
+
+  void init (const hb_bit_set_t &coverage, uint64_t *storage)
+  {
+    first = coverage.get_min ();
+    length = coverage.get_max () - first + 1;
+    for (hb_codepoint_t g : coverage)
+      storage[(g - first) / 64] |= 1ull << ((g - first) % 64);
+    words = storage;
+  }
+
+  const uint64_t *words;
+  hb_codepoint_t first;
+  unsigned length;
+};
+
+/* Direct-indexed table from glyph to a per-subtable value over
+ * [first, first + length), replacing the Coverage lookup of simple
+ * substitution subtables.  What the value means is up to the subtable;
+ * see get_dense_value() and apply_dense() of the subtables that support
+ * it.  Not in use while values is nullptr. */
+struct hb_dense_glyph_map_t
+{
+  static constexpr unsigned NOT_FOUND = 0xFFFFu;
+
+  bool in_use () const { return values; }
+
+  unsigned get (hb_codepoint_t g) const
+  {
+    g -= first;
+    return g < length ? values[g] : NOT_FOUND;
+  }
+
+  /* Whether a table is worth building for coverage: large enough that
+   * the Coverage lookup is a real search, and dense enough not to waste
+   * memory. */
+  static bool worthwhile (const hb_bit_set_t &coverage)
+  {
+    if (coverage.is_empty () || unlikely (coverage.in_error ()))
+      return false;
+    unsigned population = coverage.get_population ();
+    if (population < HB_OT_LAYOUT_DENSE_SUBST_MIN_GLYPHS || population >= NOT_FOUND)
+      return false;
+    return coverage.get_max () - coverage.get_min () < population * HB_OT_LAYOUT_DENSE_SUBST_MAX_SPARSENESS;
+  }
+
+  static unsigned words_for (const hb_bit_set_t &coverage)
+  { return (coverage.get_max () - coverage.get_min ()) / 4 + 1; }
+
+  /* Returns false, leaving the table not in use, if a value does not fit
+   * in 16 bits, like a substitute glyph of 0xFFFF or above; such
+   * subtables keep using their Coverage. */
+  template <typename value_func_t>
+  bool init (const hb_bit_set_t &coverage, uint64_t *storage, value_func_t value_func)
+  {
+    first = coverage.get_min ();
+    length = coverage.get_max () - first + 1;
+    uint16_t *v = (uint16_t *) storage;
+    hb_memset (v, 0xFF, length * sizeof (v[0]));
+    for (hb_codepoint_t g : coverage)
+    {
+      unsigned value = value_func (g);
+      if (value == NOT_COVERED) continue;
+      if (unlikely (value >= NOT_FOUND)) return false;
+      v[g - first] = value;
+    }
+    values = v;
+    return true;
+  }
+
+  const uint16_t *values;
+  hb_codepoint_t first;
+  unsigned length;
+};
+
+/* Direct-indexed ClassDef over [first, first + length), one byte per
+ * glyph where all classes fit and two otherwise.  Like ClassDef, glyphs
+ * outside are class zero. */
+struct hb_class_map_t
+{
+  unsigned get_class (hb_codepoint_t g) const
+  {
+    g -= first;
+    if (g >= length) return 0;
+    return wide ? classes16[g] : classes8[g];
+  }
+
+  union {
+  const uint8_t *classes8;
+  const uint16_t *classes16;
+  };
+  hb_codepoint_t first;
+  unsigned length;
+  bool wide;
+};
+
+/* ClassDef maps and Coverage bitmaps of a GSUB or GPOS table, built the
+ * first time a lookup accelerator asks for them and shared by every
+ * subtable that references the same ClassDef or Coverage.  They live as
+ * long as the face.  Each is a single allocation, with its data right
+ * after the header; nullptr is recorded for tables not mapped, to not
+ * try again. */
+struct hb_ot_layout_glyph_maps_t
+{
+  ~hb_ot_layout_glyph_maps_t ()
+  {
+    for (hb_class_map_t *map : class_maps.values ())
+      hb_free (map);
+    for (hb_coverage_bitmap_t *bitmap : coverage_bitmaps.values ())
+      hb_free (bitmap);
+  }
+
+  const hb_class_map_t *get_class_map (const ClassDef &class_def)
+  {
+    hb_lock_t lock (mutex);
+
+    hb_class_map_t **p;
+    if (class_maps.has ((uintptr_t) &class_def, &p))
+      return *p;
+
+    hb_class_map_t *map = nullptr;
+    hb_bit_set_t glyphs;
+    if (class_def.collect_coverage (&glyphs) && likely (!glyphs.in_error ()))
+    {
+      hb_codepoint_t first = glyphs.is_empty () ? 0 : glyphs.get_min ();
+      unsigned length = glyphs.is_empty () ? 0 : glyphs.get_max () - first + 1;
+      unsigned size = sizeof (hb_class_map_t) + length * sizeof (uint16_t);
+      if (size <= budget && (map = (hb_class_map_t *) hb_malloc (size)))
+      {
+	uint16_t *classes = (uint16_t *) (map + 1);
+	hb_memset (classes, 0, length * sizeof (uint16_t));
+	unsigned max_class = 0;
+	for (hb_codepoint_t g : glyphs)
+	{
+	  unsigned klass = class_def.get_class (g);
+	  classes[g - first] = klass;
+	  max_class = hb_max (max_class, klass);
+	}
+
+	map->first = first;
+	map->length = length;
+	map->wide = max_class > 0xFFu;
+	if (map->wide)
+	  map->classes16 = classes;
+	else
+	{
+	  /* Narrow in place; each byte is written after the entry it
+	   * overlaps has been read. */
+	  uint8_t *narrow = (uint8_t *) classes;
+	  for (unsigned i = 0; i < length; i++)
+	    narrow[i] = classes[i];
+	  size = sizeof (hb_class_map_t) + length;
+	  if (auto *shrunk = (hb_class_map_t *) hb_realloc (map, size))
+	    map = shrunk;
+	  map->classes8 = (const uint8_t *) (map + 1);
+	}
+	budget -= size;
+      }
+    }
+
+    if (unlikely (!class_maps.set ((uintptr_t) &class_def, map)))
+    {
+      hb_free (map);
+      return nullptr;
+    }
+    return map;
+  }
+
+  const hb_coverage_bitmap_t *get_coverage_bitmap (const Coverage &coverage)
+  {
+    hb_lock_t lock (mutex);
+
+    hb_coverage_bitmap_t **p;
+    if (coverage_bitmaps.has ((uintptr_t) &coverage, &p))
+      return *p;
+
+    hb_coverage_bitmap_t *bitmap = nullptr;
+    hb_bit_set_t glyphs;
+    if (coverage.collect_coverage (&glyphs) &&
+	likely (!glyphs.in_error ()) && !glyphs.is_empty ())
+    {
+      unsigned words = hb_coverage_bitmap_t::words_for (glyphs);
+      unsigned size = sizeof (hb_coverage_bitmap_t) + words * sizeof (uint64_t);
+      if (size <= budget && (bitmap = (hb_coverage_bitmap_t *) hb_malloc (size)))
+      {
+	uint64_t *storage = (uint64_t *) (bitmap + 1);
+	hb_memset (storage, 0, words * sizeof (uint64_t));
+	bitmap->init (glyphs, storage);
+	budget -= size;
+      }
+    }
+
+    if (unlikely (!coverage_bitmaps.set ((uintptr_t) &coverage, bitmap)))
+    {
+      hb_free (bitmap);
+      return nullptr;
+    }
+    return bitmap;
+  }
+
+  private:
+  hb_mutex_t mutex;
+  /* Keyed by address. */
+  hb_hashmap_t<uintptr_t, hb_class_map_t *> class_maps;
+  hb_hashmap_t<uintptr_t, hb_coverage_bitmap_t *> coverage_bitmaps;
+  unsigned budget = HB_OT_LAYOUT_GLYPH_MAPS_BUDGET;
+};
+
 struct hb_accelerate_subtables_context_t :
        hb_dispatch_context_t<hb_accelerate_subtables_context_t>
 {
@@ -936,6 +1177,45 @@ struct hb_accelerate_subtables_context_t :
 
   typedef bool (*hb_apply_func_t) (const void *obj, hb_ot_apply_context_t *c);
   typedef bool (*hb_cache_func_t) (const void *obj, hb_ot_apply_context_t *c, bool enter);
+  typedef bool (*hb_apply_dense_func_t) (const void *obj, hb_ot_apply_context_t *c, unsigned value);
+  typedef unsigned (*hb_dense_value_func_t) (const void *obj, unsigned index, hb_codepoint_t glyph);
+
+  template <typename Type>
+  static inline bool apply_dense_to (const void *obj, hb_ot_apply_context_t *c, unsigned value)
+  {
+    const Type *typed_obj = (const Type *) obj;
+    return typed_obj->apply_dense (c, value);
+  }
+  template <typename Type>
+  static inline unsigned dense_value_to (const void *obj, unsigned index, hb_codepoint_t glyph)
+  {
+    const Type *typed_obj = (const Type *) obj;
+    return typed_obj->get_dense_value (index, glyph);
+  }
+
+  /* Only subtables implementing apply_dense() can use dense tables. */
+  template <typename T>
+  static inline auto apply_dense_func_ (const T *obj, hb_priority<1>)
+  -> hb_head_t<hb_apply_dense_func_t, decltype (obj->apply_dense (nullptr, 0u))>
+  { return apply_dense_to<T>; }
+  template <typename T>
+  static inline hb_apply_dense_func_t apply_dense_func_ (const T *obj, hb_priority<0>) { return nullptr; }
+  template <typename T>
+  static inline auto dense_value_func_ (const T *obj, hb_priority<1>)
+  -> hb_head_t<hb_dense_value_func_t, decltype (obj->get_dense_value (0u, 0u))>
+  { return dense_value_to<T>; }
+  template <typename T>
+  static inline hb_dense_value_func_t dense_value_func_ (const T *obj, hb_priority<0>) { return nullptr; }
+
+  static constexpr unsigned MAX_CLASS_DEFS = 3;
+  typedef bool (*hb_apply_mapped_func_t) (const void *obj, hb_ot_apply_context_t *c, const hb_class_map_t * const *class_maps);
+
+  template <typename Type>
+  static inline bool apply_mapped_to (const void *obj, hb_ot_apply_context_t *c, const hb_class_map_t * const *class_maps)
+  {
+    const Type *typed_obj = (const Type *) obj;
+    return typed_obj->apply_mapped (c, class_maps);
+  }
 
   struct hb_applicable_t
   {
@@ -957,18 +1237,42 @@ struct hb_accelerate_subtables_context_t :
       apply_cached_func = apply_cached_func_;
       cache_func = cache_func_;
 #endif
+      coverage = &obj_.get_coverage ();
       digest.init ();
-      obj_.get_coverage ().collect_coverage (&digest);
+      coverage->collect_coverage (&digest);
+      apply_dense_func = apply_dense_func_ (&obj_, hb_prioritize);
+      dense_value_func = dense_value_func_ (&obj_, hb_prioritize);
     }
 
+    bool may_have (hb_codepoint_t g) const
+    { return bitmap.in_use () ? bitmap.has (g) : digest.may_have (g); }
+
     bool apply (hb_ot_apply_context_t *c) const
     {
-      return digest.may_have (c->buffer->cur().codepoint) && apply_func (obj, c);
+      if (dense.in_use ())
+	return apply_dense (c);
+      if (apply_mapped_func)
+	return apply_mapped (c);
+      return may_have (c->buffer->cur().codepoint) && apply_func (obj, c);
+    }
+    bool apply_dense (hb_ot_apply_context_t *c) const
+    {
+      unsigned value = dense.get (c->buffer->cur().codepoint);
+      return value != hb_dense_glyph_map_t::NOT_FOUND && apply_dense_func (obj, c, value);
+    }
+    /* The bitmap is exact, so apply_mapped() can skip Coverage. */
+    bool apply_mapped (hb_ot_apply_context_t *c) const
+    {
+      return bitmap.has (c->buffer->cur().codepoint) && apply_mapped_func (obj, c, class_maps);
     }
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
     bool apply_cached (hb_ot_apply_context_t *c) const
     {
-      return digest.may_have (c->buffer->cur().codepoint) &&  apply_cached_func (obj, c);
+      if (dense.in_use ())
+	return apply_dense (c);
+      if (apply_mapped_func)
+	return apply_mapped (c);
+      return may_have (c->buffer->cur().codepoint) &&  apply_cached_func (obj, c);
     }
     bool cache_enter (hb_ot_apply_context_t *c) const
     {
@@ -987,9 +1291,42 @@ struct hb_accelerate_subtables_context_t :
     hb_apply_func_t apply_cached_func;
     hb_cache_func_t cache_func;
 #endif
+    const Coverage *coverage;
     hb_set_digest_t digest;
+    hb_coverage_bitmap_t bitmap;
+    hb_apply_dense_func_t apply_dense_func;
+    hb_dense_value_func_t dense_value_func;
+    hb_dense_glyph_map_t dense;
+    hb_apply_mapped_func_t apply_mapped_func;
+    const hb_class_map_t *class_maps[MAX_CLASS_DEFS];
   };
 
+  /* Subtables matching by class implement get_class_defs() and
+   * apply_mapped(), and get their ClassDefs and Coverage mapped if
+   * glyph_maps has room for them. */
+  template <typename T>
+  auto map_ (hb_applicable_t *entry, const T &obj, hb_priority<1>)
+  -> hb_head_t<void, decltype (obj.get_class_defs (nullptr))>
+  {
+    const ClassDef *class_defs[MAX_CLASS_DEFS];
+    unsigned count = obj.get_class_defs (class_defs);
+    const hb_class_map_t *class_maps[MAX_CLASS_DEFS] = {};
+    for (unsigned i = 0; i < count; i++)
+      if (!(class_maps[i] = glyph_maps->get_class_map (*class_defs[i])))
+	return;
+
+    const hb_coverage_bitmap_t *bitmap = glyph_maps->get_coverage_bitmap (obj.get_coverage ());
+    if (!bitmap)
+      return;
+
+    entry->bitmap = *bitmap;
+    for (unsigned i = 0; i < count; i++)
+      entry->class_maps[i] = class_maps[i];
+    entry->apply_mapped_func = apply_mapped_to<T>;
+  }
+  template <typename T>
+  void map_ (hb_applicable_t *entry HB_UNUSED, const T &obj HB_UNUSED, hb_priority<0>) {}
+
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
   template <typename T>
   auto cache_cost (const T &obj, hb_priority<1>) HB_AUTO_RETURN ( obj.cache_cost () )
@@ -1010,6 +1347,8 @@ struct hb_accelerate_subtables_context_t :
 		 , cache_func_to<T>
 #endif
 		 );
+    if (glyph_maps)
+      map_ (entry, obj, hb_prioritize);
 
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
     /* Cache handling
@@ -1019,8 +1358,9 @@ struct hb_accelerate_subtables_context_t :
      * because the resources they would use will collide.  As such, we ask
      * each subtable to tell us how much it costs (which a cache would avoid),
      * and we allocate the cache opportunity to the costliest subtable.
+     * Subtables with mapped ClassDefs have no use for it.
      */
-    unsigned cost = cache_cost (obj, hb_prioritize);
+    unsigned cost = entry->apply_mapped_func ? 0 : cache_cost (obj, hb_prioritize);
     if (cost > cache_user_cost)
     {
       cache_user_idx = i - 1;
@@ -1032,10 +1372,13 @@ struct hb_accelerate_subtables_context_t :
   }
   static return_t default_return_value () { return hb_empty_t (); }
 
-  hb_accelerate_subtables_context_t (hb_applicable_t *array_) :
-				     array (array_) {}
+  hb_accelerate_subtables_context_t (hb_applicable_t *array_,
+				     hb_ot_layout_glyph_maps_t *glyph_maps_ = nullptr) :
+				     array (array_),
+				     glyph_maps (glyph_maps_) {}
 
   hb_applicable_t *array;
+  hb_ot_layout_glyph_maps_t *glyph_maps;
   unsigned i = 0;
 
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
@@ -1222,6 +1565,11 @@ static inline bool match_class_cached2 (hb_glyph_info_t &info, unsigned value, c
     info.syllable() = (info.syllable() & 0x0F) | (klass << 4);
   return klass == value;
 }
+static inline bool match_class_mapped (hb_glyph_info_t &info, unsigned value, const void *data)
+{
+  const hb_class_map_t &class_map = *reinterpret_cast<const hb_class_map_t *>(data);
+  return class_map.get_class (info.codepoint) == value;
+}
 static inline bool match_coverage (hb_glyph_info_t &info, unsigned value, const void *data)
 {
   Offset16To<Coverage> coverage;
@@ -2663,6 +3011,25 @@ struct ContextFormat2_5
     return_trace (rule_set.apply (c, lookup_context));
   }
 
+  unsigned get_class_defs (const ClassDef **class_defs) const
+  {
+    if (class_defs)
+      class_defs[0] = &(this+classDef);
+    return 1;
+  }
+  /* Like apply(), for a glyph known to be covered. */
+  bool apply_mapped (hb_ot_apply_context_t *c, const hb_class_map_t * const *class_maps) const
+  {
+    TRACE_APPLY (this);
+    struct ContextApplyLookupContext lookup_context = {
+      {match_class_mapped},
+      class_maps[0]
+    };
+    unsigned index = class_maps[0]->get_class (c->buffer->cur().codepoint);
+    const RuleSet &rule_set = this+ruleSet[index];
+    return_trace (rule_set.apply (c, lookup_context));
+  }
+
   bool subset (hb_subset_context_t *c) const
   {
     TRACE_SUBSET (this);
@@ -3913,6 +4280,29 @@ struct ChainContextFormat2_5
     return_trace (rule_set.apply (c, lookup_context));
   }
 
+  unsigned get_class_defs (const ClassDef **class_defs) const
+  {
+    if (class_defs)
+    {
+      class_defs[0] = &(this+backtrackClassDef);
+      class_defs[1] = &(this+inputClassDef);
+      class_defs[2] = &(this+lookaheadClassDef);
+    }
+    return 3;
+  }
+  /* Like apply(), for a glyph known to be covered. */
+  bool apply_mapped (hb_ot_apply_context_t *c, const hb_class_map_t * const *class_maps) const
+  {
+    TRACE_APPLY (this);
+    struct ChainContextApplyLookupContext lookup_context = {
+      {{match_class_mapped, match_class_mapped, match_class_mapped}},
+      {class_maps[0], class_maps[1], class_maps[2]}
+    };
+    unsigned index = class_maps[1]->get_class (c->buffer->cur().codepoint);
+    const ChainRuleSet &rule_set = this+ruleSet[index];
+    return_trace (rule_set.apply (c, lookup_context));
+  }
+
   bool subset (hb_subset_context_t *c) const
   {
     TRACE_SUBSET (this);
@@ -4379,7 +4769,11 @@ struct Extension
 struct hb_ot_layout_lookup_accelerator_t
 {
   template <typename TLookup>
-  static hb_ot_layout_lookup_accelerator_t *create (const TLookup &lookup)
+  static hb_ot_layout_lookup_accelerator_t *create (const TLookup &lookup,
+						    unsigned num_glyphs = 0,
+						    hb_atomic_int_t *bitmap_budget = nullptr,
+						    hb_atomic_int_t *dense_budget = nullptr,
+						    hb_ot_layout_glyph_maps_t *glyph_maps = nullptr)
   {
     unsigned count = lookup.get_subtable_count ();
 
@@ -4396,7 +4790,7 @@ struct hb_ot_layout_lookup_accelerator_t
     if (unlikely (!thiz))
       return nullptr;
 
-    hb_accelerate_subtables_context_t c_accelerate_subtables (thiz->subtables);
+    hb_accelerate_subtables_context_t c_accelerate_subtables (thiz->subtables, glyph_maps);
     lookup.dispatch (&c_accelerate_subtables);
 
     thiz->digest.init ();
@@ -4410,11 +4804,157 @@ struct hb_ot_layout_lookup_accelerator_t
 	thiz->subtables[i].apply_cached_func = thiz->subtables[i].apply_func;
 #endif
 
+    if (bitmap_budget || dense_budget)
+      thiz = compile (thiz, size, count, num_glyphs, bitmap_budget, dense_budget);
+
+    return thiz;
+  }
+
+  /* Trades memory for speed where it pays, as far as budgets allow:
+   *
+   * - Simple substitution subtables with compact coverage get a dense
+   *   table from glyph to what they would look up through Coverage.
+   * - Digests that would let through mostly uncovered glyphs are
+   *   replaced with exact bitmaps, except for subtables that got shared
+   *   ones along with their ClassDef maps.
+   *
+   * Both are stored past the end of the accelerator, so it is still
+   * freed with hb_free(). */
+  static hb_ot_layout_lookup_accelerator_t *
+  compile (hb_ot_layout_lookup_accelerator_t *thiz,
+	   unsigned size,
+	   unsigned count,
+	   unsigned num_glyphs,
+	   hb_atomic_int_t *bitmap_budget,
+	   hb_atomic_int_t *dense_budget)
+  {
+    /* The last entry of each is for the lookup itself, whose coverage is
+     * the union of that of its subtables.  Ends are in words into the
+     * storage, zero for no table. */
+    hb_vector_t<hb_bit_set_t> coverages;
+    hb_vector_t<unsigned> bitmap_ends, dense_ends;
+    if (unlikely (!coverages.resize (count + 1) ||
+		  !bitmap_ends.resize (count + 1) ||
+		  !dense_ends.resize (count + 1)))
+      return thiz;
+
+    hb_bit_set_t &lookup_coverage = coverages.arrayZ[count];
+    unsigned bitmap_words = 0, dense_words = 0;
+    for (unsigned i = 0; i <= count; i++)
+    {
+      const hb_bit_set_t &coverage = coverages.arrayZ[i];
+      if (i < count)
+      {
+	const auto &subtable = thiz->subtables[i];
+	if (!subtable.coverage) continue;
+	subtable.coverage->collect_coverage (&coverages.arrayZ[i]);
+	lookup_coverage.union_ (coverage);
+	/* Has a shared exact bitmap already. */
+	if (subtable.apply_mapped_func) continue;
+
+	if (dense_budget && subtable.apply_dense_func &&
+	    hb_dense_glyph_map_t::worthwhile (coverage))
+	{
+	  unsigned n = hb_dense_glyph_map_t::words_for (coverage);
+	  if (reserve (*dense_budget, n))
+	  {
+	    dense_words += n;
+	    dense_ends.arrayZ[i] = bitmap_words + dense_words;
+	    /* The dense table filters exactly already. */
+	    continue;
+	  }
+	}
+      }
+
+      const hb_set_digest_t &digest = i < count ? thiz->subtables[i].digest : thiz->digest;
+      if (bitmap_budget &&
+	  hb_coverage_bitmap_t::worthwhile (digest, coverage, num_glyphs))
+      {
+	unsigned n = hb_coverage_bitmap_t::words_for (coverage);
+	if (reserve (*bitmap_budget, n))
+	{
+	  bitmap_words += n;
+	  bitmap_ends.arrayZ[i] = bitmap_words + dense_words;
+	}
+      }
+    }
+    unsigned words = bitmap_words + dense_words;
+    if (!words)
+      return thiz;
+
+    size = (size + sizeof (uint64_t) - 1) & ~(sizeof (uint64_t) - 1);
+    auto *p = (hb_ot_layout_lookup_accelerator_t *) hb_realloc (thiz, size + words * sizeof (uint64_t));
+    if (unlikely (!p))
+    {
+      if (bitmap_words) bitmap_budget->add (bitmap_words * sizeof (uint64_t));
+      if (dense_words) dense_budget->add (dense_words * sizeof (uint64_t));
+      return thiz;
+    }
+    thiz = p;
+
+    uint64_t *storage = (uint64_t *) ((char *) thiz + size);
+    hb_memset (storage, 0, words * sizeof (uint64_t));
+    for (unsigned i = 0; i <= count; i++)
+    {
+      const hb_bit_set_t &coverage = coverages.arrayZ[i];
+      if (unsigned end = bitmap_ends.arrayZ[i])
+      {
+	hb_coverage_bitmap_t &bitmap = i < count ? thiz->subtables[i].bitmap : thiz->bitmap;
+	bitmap.init (coverage, storage + end - hb_coverage_bitmap_t::words_for (coverage));
+      }
+      if (unsigned end = dense_ends.arrayZ[i])
+      {
+	auto &subtable = thiz->subtables[i];
+	(void) subtable.dense.init (coverage,
+				    storage + end - hb_dense_glyph_map_t::words_for (coverage),
+				    [&] (hb_codepoint_t g)
+				    {
+				      unsigned index = subtable.coverage->get_coverage (g);
+				      return subtable.dense_value_func (subtable.obj, index, g);
+				    });
+      }
+    }
+    thiz->bitmap_bytes = bitmap_words * sizeof (uint64_t);
+    thiz->dense_bytes = dense_words * sizeof (uint64_t);
+
     return thiz;
   }
 
+  static bool reserve (hb_atomic_int_t &budget, unsigned words)
+  {
+    int bytes = words * sizeof (uint64_t);
+    if (budget.add (-bytes) >= bytes)
+      return true;
+    budget.add (bytes);
+    return false;
+  }
+
   bool may_have (hb_codepoint_t g) const
-  { return digest.may_have (g); }
+  { return bitmap.in_use () ? bitmap.has (g) : digest.may_have (g); }
+
+  /* Returns the index of the first of info[start, end) that may_have()
+   * lets through, or end.  Runs of glyphs a lookup can't start at are
+   * common, so this tests them in a tight loop of their own, with the
+   * choice of filter made once. */
+  unsigned next_candidate (const hb_glyph_info_t *info,
+			   unsigned start,
+			   unsigned end) const
+  {
+    if (bitmap.in_use ())
+      return next_candidate (bitmap, info, start, end);
+    return next_candidate (digest, info, start, end);
+  }
+
+  template <typename filter_t>
+  static unsigned next_candidate (const filter_t &filter,
+				  const hb_glyph_info_t *info,
+				  unsigned start,
+				  unsigned end)
+  {
+    while (start < end && !filter.may_have (info[start].codepoint))
+      start++;
+    return start;
+  }
 
 #ifndef HB_OPTIMIZE_SIZE
   HB_ALWAYS_INLINE
@@ -4460,6 +5000,9 @@ struct hb_ot_layout_lookup_accelerator_t
 
 
   hb_set_digest_t digest;
+  hb_coverage_bitmap_t bitmap;
+  unsigned bitmap_bytes;
+  unsigned dense_bytes;
   private:
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
   unsigned cache_user_idx = (unsigned) -1;
@@ -4836,6 +5379,7 @@ struct GSUBGPOS
       }
 
       this->lookup_count = table->get_lookup_count ();
+      this->num_glyphs = face->get_num_glyphs ();
 
       this->accels = (hb_atomic_ptr_t<hb_ot_layout_lookup_accelerator_t> *) hb_calloc (this->lookup_count, sizeof (*accels));
       if (unlikely (!this->accels))
@@ -4863,12 +5407,18 @@ struct GSUBGPOS
       auto *accel = accels[lookup_index].get_acquire ();
       if (unlikely (!accel))
       {
-	accel = hb_ot_layout_lookup_accelerator_t::create (table->get_lookup (lookup_index));
+	accel = hb_ot_layout_lookup_accelerator_t::create (table->get_lookup (lookup_index),
+							  num_glyphs,
+							  &bitmap_budget,
+							  &dense_budget,
+							  &glyph_maps);
 	if (unlikely (!accel))
 	  return nullptr;
 
 	if (unlikely (!accels[lookup_index].cmpexch (nullptr, accel)))
 	{
+	  bitmap_budget.add (accel->bitmap_bytes);
+	  dense_budget.add (accel->dense_bytes);
 	  hb_free (accel);
 	  goto retry;
 	}
@@ -4879,7 +5429,12 @@ struct GSUBGPOS
 
     hb_blob_ptr_t<T> table;
     unsigned int lookup_count;
+    unsigned int num_glyphs;
     hb_atomic_ptr_t<hb_ot_layout_lookup_accelerator_t> *accels;
+    /* Bytes left for exact coverage bitmaps and dense tables of lookups. */
+    mutable hb_atomic_int_t bitmap_budget = HB_OT_LAYOUT_COVERAGE_BITMAP_BUDGET;
+    mutable hb_atomic_int_t dense_budget = HB_OT_LAYOUT_DENSE_SUBST_BUDGET;
+    mutable hb_ot_layout_glyph_maps_t glyph_maps;
   };
 
   protected:
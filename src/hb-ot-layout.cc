@@ -41,6 +41,7 @@
 #include "hb-ot-face.hh"
 #include "hb-ot-map.hh"
 #include "hb-map.hh"
+#include "hb-shape-profile.hh"
 
 #include "hb-ot-kern-table.hh"
 #include "hb-ot-layout-gdef-table.hh"
@@ -1899,10 +1900,28 @@ struct GPOSProxy
 };
 
 
+/* Counts the glyphs in [start, start + count) the coverage filter of
+ * the lookup rejects, for a profile. */
+static void
+count_rejections (hb_shape_profile_t::lookup_t *stats,
+		  const OT::hb_ot_layout_lookup_accelerator_t &accel,
+		  const hb_glyph_info_t *info,
+		  unsigned start,
+		  unsigned count)
+{
+  stats->glyphs_visited += count;
+  for (unsigned i = start; i < start + count; i++)
+    stats->digest_rejections += !accel.may_have (info[i].codepoint);
+}
+
+/* With profiling, stats is updated as the lookup goes; without, it is
+ * not looked at and the counting compiles away. */
+template <bool profiling>
 static inline bool
 apply_forward (OT::hb_ot_apply_context_t *c,
 	       const OT::hb_ot_layout_lookup_accelerator_t &accel,
-	       unsigned subtable_count)
+	       unsigned subtable_count,
+	       hb_shape_profile_t::lookup_t *stats)
 {
   bool use_cache = accel.cache_enter (c);
 
@@ -1910,16 +1929,32 @@ apply_forward (OT::hb_ot_apply_context_t *c,
   hb_buffer_t *buffer = c->buffer;
   while (buffer->idx < buffer->len && buffer->successful)
   {
+    if (!accel.may_have (buffer->cur().codepoint))
+    {
+      /* Step over the whole run of glyphs the lookup can't start at. */
+      unsigned skip = accel.next_candidate (buffer->info, buffer->idx + 1, buffer->len) - buffer->idx;
+      if (profiling)
+	count_rejections (stats, accel, buffer->info, buffer->idx, skip);
+      (void) buffer->next_glyphs (skip);
+      continue;
+    }
+
+    if (profiling)
+      count_rejections (stats, accel, buffer->info, buffer->idx, 1);
+
     bool applied = false;
-    if (accel.digest.may_have (buffer->cur().codepoint) &&
-	(buffer->cur().mask & c->lookup_mask) &&
+    if ((buffer->cur().mask & c->lookup_mask) &&
 	c->check_glyph_property (&buffer->cur(), c->lookup_props))
      {
        applied = accel.apply (c, subtable_count, use_cache);
      }
 
     if (applied)
+    {
+      if (profiling)
+	stats->applications++;
       ret = true;
+    }
     else
       (void) buffer->next_glyph ();
   }
@@ -1930,19 +1965,29 @@ apply_forward (OT::hb_ot_apply_context_t *c,
   return ret;
 }
 
+template <bool profiling>
 static inline bool
 apply_backward (OT::hb_ot_apply_context_t *c,
 	       const OT::hb_ot_layout_lookup_accelerator_t &accel,
-	       unsigned subtable_count)
+	       unsigned subtable_count,
+	       hb_shape_profile_t::lookup_t *stats)
 {
   bool ret = false;
   hb_buffer_t *buffer = c->buffer;
   do
   {
-    if (accel.digest.may_have (buffer->cur().codepoint) &&
+    if (profiling)
+      count_rejections (stats, accel, buffer->info, buffer->idx, 1);
+
+    if (accel.may_have (buffer->cur().codepoint) &&
 	(buffer->cur().mask & c->lookup_mask) &&
 	c->check_glyph_property (&buffer->cur(), c->lookup_props))
-      ret |= accel.apply (c, subtable_count, false);
+    {
+      bool applied = accel.apply (c, subtable_count, false);
+      if (profiling)
+	stats->applications += applied;
+      ret |= applied;
+    }
 
     /* The reverse lookup doesn't "advance" cursor (for good reason). */
     buffer->idx--;
@@ -1956,7 +2001,8 @@ template <typename Proxy>
 static inline bool
 apply_string (OT::hb_ot_apply_context_t *c,
 	      const typename Proxy::Lookup &lookup,
-	      const OT::hb_ot_layout_lookup_accelerator_t &accel)
+	      const OT::hb_ot_layout_lookup_accelerator_t &accel,
+	      hb_shape_profile_t::lookup_t *stats = nullptr)
 {
   hb_buffer_t *buffer = c->buffer;
   unsigned subtable_count = lookup.get_subtable_count ();
@@ -1975,7 +2021,8 @@ apply_string (OT::hb_ot_apply_context_t *c,
       buffer->clear_output ();
 
     buffer->idx = 0;
-    ret = apply_forward (c, accel, subtable_count);
+    ret = unlikely (stats) ? apply_forward<true> (c, accel, subtable_count, stats)
+			   : apply_forward<false> (c, accel, subtable_count, nullptr);
 
     if (!Proxy::always_inplace)
       buffer->sync ();
@@ -1985,7 +2032,8 @@ apply_string (OT::hb_ot_apply_context_t *c,
     /* in-place backward substitution/positioning */
     assert (!buffer->have_output);
     buffer->idx = buffer->len - 1;
-    ret = apply_backward (c, accel, subtable_count);
+    ret = unlikely (stats) ? apply_backward<true> (c, accel, subtable_count, stats)
+			   : apply_backward<false> (c, accel, subtable_count, nullptr);
   }
 
   return ret;
@@ -2002,9 +2050,16 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
   OT::hb_ot_apply_context_t c (table_index, font, buffer, proxy.accel.get_blob ());
   c.set_recurse_func (Proxy::Lookup::template dispatch_recurse_func<OT::hb_ot_apply_context_t>);
 
+  hb_shape_profile_t *profile = buffer->profiling () ? buffer->profile : nullptr;
+
+  /* Lookups that some glyph in the buffer may start at. */
+  const lookup_starts_t &starts_map = lookup_starts[table_index];
+  uint64_t starts = starts_map.get (buffer);
+
   for (unsigned int stage_index = 0; stage_index < stages[table_index].length; stage_index++)
   {
     const stage_map_t *stage = &stages[table_index][stage_index];
+    uint64_t stage_start = profile ? profile->now () : 0;
     for (; i < stage->last_lookup; i++)
     {
       auto &lookup = lookups[table_index][i];
@@ -2020,8 +2075,9 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
       /* c.digest is a digest of all the current glyphs in the buffer
        * (plus some past glyphs).
        *
-       * Only try applying the lookup if there is any overlap. */
-      if (accel->digest.may_have (c.digest))
+       * Only try applying the lookup if there is any overlap, and if any
+       * glyph is in its coverage. */
+      if ((starts & lookup_starts_t::bit (i)) && accel->digest.may_have (c.digest))
       {
 	c.set_lookup_index (lookup_index);
 	c.set_lookup_mask (lookup.mask, false);
@@ -2031,9 +2087,22 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
 	c.set_per_syllable (lookup.per_syllable, false);
 	/* apply_string's set_lookup_props initializes the iterators. */
 
-	apply_string<Proxy> (&c,
-			     proxy.accel.table->get_lookup (lookup_index),
-			     *accel);
+	auto *stats = profile ? profile->get_lookup (table_index, lookup_index) : nullptr;
+	uint64_t lookup_start = stats ? profile->now () : 0;
+
+	bool applied = apply_string<Proxy> (&c,
+					    proxy.accel.table->get_lookup (lookup_index),
+					    *accel,
+					    stats);
+	/* Substitutions may have added glyphs other lookups start at. */
+	if (applied && !Proxy::always_inplace)
+	  starts = starts_map.get (buffer);
+
+	if (stats)
+	{
+	  stats->invocations++;
+	  stats->time += profile->now () - lookup_start;
+	}
       }
       else if (buffer->messaging ())
 	(void) buffer->message (font, "skipped lookup %u feature '%c%c%c%c' because no glyph matches", lookup_index, HB_UNTAG (lookup.feature_tag));
@@ -2048,8 +2117,12 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
       {
 	/* Refresh working buffer digest since buffer changed. */
 	c.digest = buffer->digest ();
+	starts = starts_map.get (buffer);
       }
     }
+
+    if (profile)
+      profile->add_layout_stage_time (table_index, stage_index, profile->now () - stage_start);
   }
 }
 
@@ -2081,6 +2154,28 @@ hb_ot_layout_substitute_lookup (OT::hb_ot_apply_context_t *c,
   apply_string<GSUBProxy> (c, lookup, accel);
 }
 
+/* Glyphs lookup_index of GSUB (table_index 0) or GPOS (1) can start
+ * matching at. */
+void
+hb_ot_layout_lookup_collect_coverage (hb_face_t    *face,
+				      unsigned int  table_index,
+				      unsigned int  lookup_index,
+				      hb_bit_set_t *glyphs /* OUT */)
+{
+  if (table_index == 0)
+  {
+    const auto &gsub = *face->table.GSUB->table;
+    if (lookup_index < gsub.get_lookup_count ())
+      gsub.get_lookup (lookup_index).collect_coverage (glyphs);
+  }
+  else
+  {
+    const auto &gpos = *face->table.GPOS->table;
+    if (lookup_index < gpos.get_lookup_count ())
+      gpos.get_lookup (lookup_index).collect_coverage (glyphs);
+  }
+}
+
 #ifndef HB_NO_BASE
 
 static void
@@ -117,6 +117,12 @@ hb_ot_layout_substitute_lookup (OT::hb_ot_apply_context_t *c,
 				const OT::Layout::GSUB_impl::SubstLookup &lookup,
 				const OT::hb_ot_layout_lookup_accelerator_t &accel);
 
+HB_INTERNAL void
+hb_ot_layout_lookup_collect_coverage (hb_face_t    *face,
+				      unsigned int  table_index,
+				      unsigned int  lookup_index,
+				      hb_bit_set_t *glyphs /* OUT */);
+
 
 /* Should be called before all the position_lookup's are done. */
 HB_INTERNAL void
@@ -207,11 +213,12 @@ enum hb_unicode_props_flags_t {
 HB_MARK_AS_FLAG_T (hb_unicode_props_flags_t);
 
 static inline void
-_hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
+_hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer,
+				  hb_unicode_general_category_t general_category)
 {
   hb_unicode_funcs_t *unicode = buffer->unicode;
   unsigned int u = info->codepoint;
-  unsigned int gen_cat = (unsigned int) unicode->general_category (u);
+  unsigned int gen_cat = (unsigned int) general_category;
   unsigned int props = gen_cat;
 
   if (u >= 0x80u)
@@ -246,6 +253,7 @@ _hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
 
     if (unlikely (HB_UNICODE_GENERAL_CATEGORY_IS_MARK (gen_cat)))
     {
+      buffer->scratch_flags |= HB_BUFFER_SCRATCH_FLAG_HAS_UNICODE_MARKS;
       props |= UPROPS_MASK_CONTINUATION;
       props |= unicode->modified_combining_class (u)<<8;
     }
@@ -254,6 +262,13 @@ _hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
   info->unicode_props() = props;
 }
 
+static inline void
+_hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
+{
+  _hb_glyph_info_set_unicode_props (info, buffer,
+				    buffer->unicode->general_category (info->codepoint));
+}
+
 static inline void
 _hb_glyph_info_set_general_category (hb_glyph_info_t *info,
 				     hb_unicode_general_category_t gen_cat)
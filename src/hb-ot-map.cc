@@ -41,6 +41,58 @@ void hb_ot_map_t::collect_lookups (unsigned int table_index, hb_set_t *lookups_o
     lookups_out->add (lookups[table_index][i].index);
 }
 
+void hb_ot_map_t::lookup_starts_t::compile (hb_face_t *face,
+					     unsigned int table_index,
+					     hb_array_t<const lookup_map_t> lookups)
+{
+  unsigned int limit = hb_min (face->get_num_glyphs (), HB_OT_MAP_LOOKUP_STARTS_MAX_GLYPHS);
+  hb_vector_t<uint64_t> glyph_starts;
+  if (unlikely (!glyph_starts.resize (limit)))
+    return;
+
+  unsigned int num_glyphs = 0;
+  hb_bit_set_t coverage;
+  for (unsigned int i = 0; i < lookups.length; i++)
+  {
+    coverage.clear ();
+    hb_ot_layout_lookup_collect_coverage (face, table_index, lookups.arrayZ[i].index, &coverage);
+    if (unlikely (coverage.in_error ()))
+      return;
+    for (hb_codepoint_t g : coverage)
+      if (g < limit)
+      {
+	glyph_starts.arrayZ[g] |= bit (i);
+	num_glyphs = hb_max (num_glyphs, g + 1);
+      }
+      else
+	beyond |= bit (i);
+  }
+
+  hb_hashmap_t<uint64_t, unsigned int> class_of;
+  if (unlikely (!glyph_classes.resize_exact (num_glyphs) ||
+		!classes.push (0) ||
+		!class_of.set (0, 0)))
+    goto fail;
+  for (unsigned int g = 0; g < num_glyphs; g++)
+  {
+    uint64_t starts = glyph_starts.arrayZ[g];
+    unsigned int *found;
+    unsigned int klass = classes.length;
+    if (class_of.has (starts, &found))
+      klass = *found;
+    else if (klass == 256 ||
+	     unlikely (!class_of.set (starts, klass) ||
+		       !classes.push (starts)))
+      goto fail;
+    glyph_classes.arrayZ[g] = klass;
+  }
+  return;
+
+fail:
+  glyph_classes.fini ();
+  classes.fini ();
+}
+
 
 hb_ot_map_builder_t::hb_ot_map_builder_t (hb_face_t *face_,
 					  const hb_segment_properties_t &props_)
@@ -387,6 +439,8 @@ hb_ot_map_builder_t::compile (hb_ot_map_t                  &m,
 	stage_index++;
       }
     }
+
+    m.lookup_starts[table_index].compile (face, table_index, lookups);
   }
 }
 
@@ -34,6 +34,9 @@
 
 #define HB_OT_MAP_MAX_BITS 8u
 #define HB_OT_MAP_MAX_VALUE ((1u << HB_OT_MAP_MAX_BITS) - 1u)
+/* Glyphs from this one on share a class of lookup starts, which bounds
+ * their memory use to a byte per glyph per table. */
+#define HB_OT_MAP_LOOKUP_STARTS_MAX_GLYPHS 16384u
 
 struct hb_ot_shape_plan_t;
 
@@ -95,6 +98,44 @@ struct hb_ot_map_t
     pause_func_t pause_func;
   };
 
+  /* Which lookups of a table can start at each glyph, from their
+   * coverage, so that lookups no glyph in the buffer can start at are
+   * skipped without walking the buffer.  Lookups are numbered by their
+   * position in the map, modulo 64.  Glyphs map to one of up to 256
+   * classes of lookups; those past the end of the class array to all
+   * lookups covering any of them. */
+  struct lookup_starts_t
+  {
+    void init () { glyph_classes.init0 (); classes.init0 (); beyond = 0; }
+    void fini () { glyph_classes.fini (); classes.fini (); }
+
+    static uint64_t bit (unsigned int lookup) { return 1ull << (lookup % 64); }
+
+    uint64_t get (const hb_buffer_t *buffer) const
+    {
+      if (unlikely (!classes.length))
+	return (uint64_t) -1;
+
+      uint64_t starts = 0;
+      unsigned int num_glyphs = glyph_classes.length;
+      const hb_glyph_info_t *info = buffer->info;
+      for (unsigned int i = 0; i < buffer->len; i++)
+      {
+	hb_codepoint_t g = info[i].codepoint;
+	starts |= g < num_glyphs ? classes.arrayZ[glyph_classes.arrayZ[g]] : beyond;
+      }
+      return starts;
+    }
+
+    HB_INTERNAL void compile (hb_face_t *face,
+			      unsigned int table_index,
+			      hb_array_t<const lookup_map_t> lookups);
+
+    hb_vector_t<uint8_t> glyph_classes;
+    hb_vector_t<uint64_t> classes; /* Empty if not compiled. */
+    uint64_t beyond;
+  };
+
   void init ()
   {
     hb_memset (this, 0, sizeof (*this));
@@ -104,6 +145,7 @@ struct hb_ot_map_t
     {
       lookups[table_index].init0 ();
       stages[table_index].init0 ();
+      lookup_starts[table_index].init ();
     }
   }
   void fini ()
@@ -113,6 +155,7 @@ struct hb_ot_map_t
     {
       lookups[table_index].fini ();
       stages[table_index].fini ();
+      lookup_starts[table_index].fini ();
     }
   }
 
@@ -178,6 +221,7 @@ struct hb_ot_map_t
   hb_sorted_vector_t<feature_map_t> features;
   hb_vector_t<lookup_map_t> lookups[2]; /* GSUB/GPOS */
   hb_vector_t<stage_map_t> stages[2]; /* GSUB/GPOS */
+  lookup_starts_t lookup_starts[2]; /* GSUB/GPOS */
 };
 
 enum hb_ot_map_feature_flags_t
@@ -319,6 +319,21 @@ _hb_ot_shape_normalize (const hb_ot_shape_plan_t *plan,
    * this way. */
 
 
+  /* Without marks there is nothing to reorder or recompose; and if the
+   * font has all the characters, nothing to decompose either. */
+  if (might_short_circuit &&
+      !(buffer->scratch_flags & HB_BUFFER_SCRATCH_FLAG_HAS_UNICODE_MARKS))
+  {
+    count = buffer->len;
+    if (font->get_nominal_glyphs (count,
+				  &buffer->info[0].codepoint,
+				  sizeof (buffer->info[0]),
+				  &buffer->info[0].glyph_index(),
+				  sizeof (buffer->info[0])) == count)
+      return;
+  }
+
+
   /* First round, decompose */
 
   bool all_simple = true;
@@ -44,6 +44,7 @@
 #include "hb-ot-face.hh"
 
 #include "hb-set.hh"
+#include "hb-shape-profile.hh"
 
 #include "hb-aat-layout.hh"
 
@@ -473,9 +474,19 @@ hb_set_unicode_props (hb_buffer_t *buffer)
    */
   unsigned int count = buffer->len;
   hb_glyph_info_t *info = buffer->info;
+  hb_unicode_general_category_t gen_cats[64];
+  unsigned int chunk_start = 0, chunk_end = 0;
   for (unsigned int i = 0; i < count; i++)
   {
-    _hb_glyph_info_set_unicode_props (&info[i], buffer);
+    if (i >= chunk_end)
+    {
+      chunk_start = i;
+      chunk_end = hb_min (count, i + ARRAY_LENGTH (gen_cats));
+      buffer->unicode->general_categories (chunk_end - chunk_start,
+					   &info[i].codepoint, sizeof (info[0]),
+					   gen_cats);
+    }
+    _hb_glyph_info_set_unicode_props (&info[i], buffer, gen_cats[i - chunk_start]);
 
     unsigned gen_cat = _hb_glyph_info_get_general_category (&info[i]);
     if (FLAG_UNSAFE (gen_cat) &
@@ -705,12 +716,18 @@ hb_ot_rotate_chars (const hb_ot_shape_context_t *c)
     hb_unicode_funcs_t *unicode = buffer->unicode;
     hb_mask_t rtlm_mask = c->plan->rtlm_mask;
 
-    for (unsigned int i = 0; i < count; i++) {
-      hb_codepoint_t codepoint = unicode->mirroring (info[i].codepoint);
-      if (unlikely (codepoint != info[i].codepoint && c->font->has_glyph (codepoint)))
-	info[i].codepoint = codepoint;
-      else
-	info[i].mask |= rtlm_mask;
+    hb_codepoint_t mirrored[64];
+    for (unsigned int start = 0; start < count; start += ARRAY_LENGTH (mirrored))
+    {
+      unsigned int end = hb_min (count, start + ARRAY_LENGTH (mirrored));
+      unicode->mirrorings (end - start, &info[start].codepoint, sizeof (info[0]), mirrored);
+      for (unsigned int i = start; i < end; i++) {
+	hb_codepoint_t codepoint = mirrored[i - start];
+	if (unlikely (codepoint != info[i].codepoint && c->font->has_glyph (codepoint)))
+	  info[i].codepoint = codepoint;
+	else
+	  info[i].mask |= rtlm_mask;
+      }
     }
   }
 
@@ -924,6 +941,14 @@ hb_synthesize_glyph_classes (hb_buffer_t *buffer)
   }
 }
 
+static inline void
+hb_ot_shape_profile_lap (const hb_ot_shape_context_t *c,
+			 hb_shape_profile_stage_t      stage)
+{
+  if (c->buffer->profiling ())
+    c->buffer->profile->lap (stage);
+}
+
 static inline void
 hb_ot_substitute_default (const hb_ot_shape_context_t *c)
 {
@@ -934,8 +959,10 @@ hb_ot_substitute_default (const hb_ot_shape_context_t *c)
   HB_BUFFER_ALLOCATE_VAR (buffer, glyph_index);
 
   _hb_ot_shape_normalize (c->plan, buffer, c->font);
+  hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_NORMALIZE);
 
   hb_ot_shape_setup_masks (c);
+  hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_SETUP_MASKS);
 
   /* This is unfortunate to go here, but necessary... */
   if (c->plan->fallback_mark_positioning)
@@ -978,6 +1005,7 @@ hb_ot_substitute_pre (const hb_ot_shape_context_t *c)
   if (c->plan->apply_morx && c->plan->apply_gpos)
     hb_aat_layout_remove_deleted_glyphs (c->buffer);
 #endif
+  hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_SUBSTITUTE);
 }
 
 static inline void
@@ -1138,10 +1166,14 @@ hb_ot_position_plan (const hb_ot_shape_context_t *c)
       c->font->subtract_glyph_h_origin (info[i].codepoint,
 					&pos[i].x_offset,
 					&pos[i].y_offset);
+  hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_POSITION);
 
   if (c->plan->fallback_mark_positioning)
+  {
     _hb_ot_shape_fallback_mark_position (c->plan, c->font, c->buffer,
 					 adjust_offsets_when_zeroing);
+    hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_FALLBACK_POSITION);
+  }
 }
 
 static inline void
@@ -1212,6 +1244,9 @@ hb_ot_shape_internal (hb_ot_shape_context_t *c)
   /* Save the original direction, we use it later. */
   c->target_direction = c->buffer->props.direction;
 
+  if (c->buffer->profiling ())
+    c->buffer->profile->start ();
+
   _hb_buffer_allocate_unicode_vars (c->buffer);
 
   hb_ot_shape_initialize_masks (c);
@@ -1228,6 +1263,7 @@ hb_ot_shape_internal (hb_ot_shape_context_t *c)
     c->plan->shaper->preprocess_text (c->plan, c->buffer, c->font);
     (void) c->buffer->message(c->font, "end preprocess-text");
   }
+  hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_PREPARE);
 
   hb_ot_substitute_pre (c);
   hb_ot_position (c);
@@ -1240,6 +1276,7 @@ hb_ot_shape_internal (hb_ot_shape_context_t *c)
   c->buffer->props.direction = c->target_direction;
 
   c->buffer->leave ();
+  hb_ot_shape_profile_lap (c, HB_SHAPE_PROFILE_STAGE_FINISH);
 }
 
 
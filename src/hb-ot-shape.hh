@@ -49,7 +49,7 @@ struct hb_ot_shape_plan_key_t
 						  &variations_index[table_index]);
   }
 
-  bool equal (const hb_ot_shape_plan_key_t *other)
+  bool equal (const hb_ot_shape_plan_key_t *other) const
   {
     return 0 == hb_memcmp (this, other, sizeof (*this));
   }
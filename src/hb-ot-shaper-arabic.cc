@@ -302,6 +302,9 @@ arabic_joining (hb_buffer_t *buffer)
   hb_glyph_info_t *info = buffer->info;
   unsigned int prev = UINT_MAX, state = 0;
 
+  if (buffer->context_len[0] || buffer->context_len[1])
+    buffer->scratch_flags |= HB_BUFFER_SCRATCH_FLAG_USED_CONTEXT;
+
   /* Check pre-context */
   for (unsigned int i = 0; i < buffer->context_len[0]; i++)
   {
@@ -591,8 +591,24 @@ struct gvar
 	}
 	shared_tuple_active_idx.arrayZ[i] = {idx1, idx2};
       }
+
+#ifndef HB_NO_GVAR_CACHE
+      /* HB_OPTIONS=no-gvar-cache turns the cache off at runtime. */
+      if (glyphCount && !hb_options ().no_gvar_cache)
+	glyph_cache = (glyph_deltas_t **) hb_calloc (GLYPH_CACHE_SIZE, sizeof (glyph_cache[0]));
+#endif
+    }
+    ~accelerator_t ()
+    {
+#ifndef HB_NO_GVAR_CACHE
+      if (glyph_cache)
+	for (unsigned i = 0; i < GLYPH_CACHE_SIZE; i++)
+	  if (glyph_cache[i])
+	    glyph_cache[i]->destroy ();
+      hb_free (glyph_cache);
+#endif
+      table.destroy ();
     }
-    ~accelerator_t () { table.destroy (); }
 
     private:
 
@@ -622,6 +638,498 @@ struct gvar
     static unsigned int next_index (unsigned int i, unsigned int start, unsigned int end)
     { return (i >= end) ? start : (i + 1); }
 
+#ifndef HB_NO_GVAR_CACHE
+    /* Everything in the variation data of a glyph that does not depend on
+     * the coordinates.  The tuple headers are listed up front; the deltas
+     * of a tuple, and for tuples that leave points out the plan to infer
+     * theirs, are decompiled the first time the tuple applies.  Applying it
+     * does the same float operations as decompiling afresh, in the same
+     * order. */
+    struct glyph_deltas_t
+    {
+      /* The cases of infer_delta(). */
+      enum iup_kind_t : uint8_t { IUP_EQUAL, IUP_PREV, IUP_NEXT, IUP_INTERPOLATE };
+      struct iup_t
+      {
+	unsigned target, prev, next;
+	iup_kind_t x_kind, y_kind;
+	float x_r, y_r;
+      };
+
+      struct tuple_deltas_t
+      {
+	bool apply_to_all;
+	hb_vector_t<unsigned> indices;	/* Unless apply_to_all. */
+	hb_vector_t<float> x;
+	hb_vector_t<float> y;
+	hb_vector_t<iup_t> iup;
+      };
+
+      struct tuple_t
+      {
+	const TupleVariationHeader *header;
+	const HBUINT8 *data;
+	unsigned length;
+      };
+
+      static glyph_deltas_t *create ()
+      {
+	auto *deltas = (glyph_deltas_t *) hb_calloc (1, sizeof (glyph_deltas_t));
+	if (unlikely (!deltas))
+	  return nullptr;
+	new (deltas) glyph_deltas_t ();
+	deltas->ref_count.set_relaxed (1);
+	return deltas;
+      }
+
+      glyph_deltas_t *reference ()
+      {
+	ref_count.inc ();
+	return this;
+      }
+
+      void destroy ()
+      {
+	if (ref_count.dec () != 1)
+	  return;
+	if (cache_bytes)
+	  cache_bytes->add (-(int) size);
+	for (unsigned i = 0; i < tuples.length; i++)
+	{
+	  tuple_deltas_t *decompiled = tuple_deltas[i].get_relaxed ();
+	  if (decompiled)
+	  {
+	    decompiled->~tuple_deltas_t ();
+	    hb_free (decompiled);
+	  }
+	}
+	hb_free (tuple_deltas);
+	this->~glyph_deltas_t ();
+	hb_free (this);
+      }
+
+      static void infer_kind (float target_val, float prev_val, float next_val,
+			      iup_kind_t *kind, float *r)
+      {
+	*r = 0.f;
+	if (prev_val == next_val)
+	  *kind = IUP_EQUAL;
+	else if (target_val <= hb_min (prev_val, next_val))
+	  *kind = (prev_val < next_val) ? IUP_PREV : IUP_NEXT;
+	else if (target_val >= hb_max (prev_val, next_val))
+	  *kind = (prev_val > next_val) ? IUP_PREV : IUP_NEXT;
+	else
+	{
+	  *kind = IUP_INTERPOLATE;
+	  *r = (target_val - prev_val) / (next_val - prev_val);
+	}
+      }
+
+      static float infer (iup_kind_t kind, float r, float prev_delta, float next_delta)
+      {
+	switch (kind)
+	{
+	  case IUP_EQUAL:	return (prev_delta == next_delta) ? prev_delta : 0.f;
+	  case IUP_PREV:	return prev_delta;
+	  case IUP_NEXT:	return next_delta;
+	  case IUP_INTERPOLATE:	break;
+	}
+	return prev_delta + r * (next_delta - prev_delta);
+      }
+
+      /* Lists the tuples of glyph; with_iup, points must hold the glyph's
+       * original points, with their end-point markers.  The entry counts
+       * the bytes it holds, now and as tuples get decompiled, in
+       * *cache_bytes_ until destroyed. */
+      bool init (hb_codepoint_t glyph_,
+		 hb_bytes_t var_data_bytes,
+		 unsigned axis_count,
+		 const hb_array_t<contour_point_t> points,
+		 bool with_iup,
+		 hb_atomic_int_t *cache_bytes_)
+      {
+	glyph = glyph_;
+	num_points = points.length;
+	has_iup = with_iup;
+
+	GlyphVariationData::tuple_iterator_t iterator;
+	if (!GlyphVariationData::get_tuple_iterator (var_data_bytes, axis_count,
+						     var_data_bytes.arrayZ,
+						     shared_indices, &iterator))
+	  return false;
+
+	do
+	{
+	  const HBUINT8 *p = iterator.get_serialized_data ();
+	  unsigned int length = iterator.current_tuple->get_data_size ();
+	  if (unlikely (!iterator.var_data_bytes.check_range (p, length)))
+	    return false;
+	  tuples.push (tuple_t {iterator.current_tuple, p, length});
+	} while (iterator.move_to_next ());
+	if (unlikely (tuples.in_error ()))
+	  return false;
+
+	tuple_deltas = (hb_atomic_ptr_t<tuple_deltas_t> *) hb_calloc (tuples.length, sizeof (tuple_deltas[0]));
+	if (unlikely (!tuple_deltas))
+	  return false;
+
+	if (with_iup)
+	{
+	  if (unlikely (!orig_x.resize (num_points, false) ||
+			!orig_y.resize (num_points, false)))
+	    return false;
+	  for (unsigned i = 0; i < num_points; i++)
+	  {
+	    orig_x.arrayZ[i] = points.arrayZ[i].x;
+	    orig_y.arrayZ[i] = points.arrayZ[i].y;
+	    if (points.arrayZ[i].is_end_point)
+	      end_points.push (i);
+	  }
+	  if (unlikely (end_points.in_error ()))
+	    return false;
+	}
+
+	cache_bytes = cache_bytes_;
+	charge (sizeof (*this) +
+		tuples.length * (sizeof (tuple_t) + sizeof (tuple_deltas[0])) +
+		shared_indices.allocated * sizeof (unsigned) +
+		(orig_x.allocated + orig_y.allocated) * sizeof (float) +
+		end_points.allocated * sizeof (unsigned));
+	return true;
+      }
+
+      void charge (size_t bytes) const
+      {
+	size.add (bytes);
+	cache_bytes->add (bytes);
+      }
+
+      /* Decompiles the deltas of tuple i and plans the inference of deltas
+       * for the points it leaves out, walking the gaps the way
+       * apply_deltas_to_points_uncached() does. */
+      tuple_deltas_t *decompile_tuple (unsigned i) const
+      {
+	auto *decompiled = (tuple_deltas_t *) hb_calloc (1, sizeof (tuple_deltas_t));
+	if (unlikely (!decompiled))
+	  return nullptr;
+	new (decompiled) tuple_deltas_t ();
+	if (likely (decompile_tuple (tuples.arrayZ[i], decompiled)))
+	  return decompiled;
+	decompiled->~tuple_deltas_t ();
+	hb_free (decompiled);
+	return nullptr;
+      }
+
+      bool decompile_tuple (const tuple_t &tuple, tuple_deltas_t *decompiled) const
+      {
+	const HBUINT8 *p = tuple.data;
+	const HBUINT8 *end = p + tuple.length;
+
+	hb_vector_t<unsigned int> private_indices;
+	bool has_private_points = tuple.header->has_private_points ();
+	if (has_private_points &&
+	    !GlyphVariationData::decompile_points (p, private_indices, end))
+	  return false;
+	const hb_vector_t<unsigned int> &indices = has_private_points ? private_indices : shared_indices;
+
+	unsigned count = num_points;
+	bool apply_to_all = decompiled->apply_to_all = (indices.length == 0);
+	unsigned int num_deltas = apply_to_all ? count : indices.length;
+	hb_vector_t<int> x_deltas;
+	hb_vector_t<int> y_deltas;
+	if (unlikely (!x_deltas.resize (num_deltas, false))) return false;
+	if (unlikely (!GlyphVariationData::decompile_deltas (p, x_deltas, end))) return false;
+	if (unlikely (!y_deltas.resize (num_deltas, false))) return false;
+	if (unlikely (!GlyphVariationData::decompile_deltas (p, y_deltas, end))) return false;
+
+	if (unlikely (!decompiled->x.alloc (num_deltas, true) ||
+		      !decompiled->y.alloc (num_deltas, true)))
+	  return false;
+	if (apply_to_all)
+	{
+	  for (unsigned i = 0; i < num_deltas; i++)
+	  {
+	    decompiled->x.push (x_deltas.arrayZ[i]);
+	    decompiled->y.push (y_deltas.arrayZ[i]);
+	  }
+	  return true;
+	}
+
+	hb_vector_t<uint8_t> referenced;
+	if (has_iup && unlikely (!referenced.resize (count)))
+	  return false;
+	if (unlikely (!decompiled->indices.alloc (num_deltas, true)))
+	  return false;
+	for (unsigned i = 0; i < num_deltas; i++)
+	{
+	  unsigned pt_index = indices.arrayZ[i];
+	  if (unlikely (pt_index >= count)) continue;
+	  decompiled->indices.push (pt_index);
+	  decompiled->x.push (x_deltas.arrayZ[i]);
+	  decompiled->y.push (y_deltas.arrayZ[i]);
+	  if (has_iup)
+	    referenced.arrayZ[pt_index] = 1;
+	}
+
+	if (!has_iup)
+	  return true;
+
+	auto &iup = decompiled->iup;
+	unsigned start_point = 0;
+	for (unsigned end_point : end_points)
+	{
+	  unsigned unref_count = 0;
+	  for (unsigned i = start_point; i < end_point + 1; i++)
+	    unref_count += referenced.arrayZ[i];
+	  unref_count = (end_point - start_point + 1) - unref_count;
+
+	  unsigned j = start_point;
+	  if (unref_count == 0 || unref_count > end_point - start_point)
+	    goto no_more_gaps;
+
+	  for (;;)
+	  {
+	    unsigned int prev, next, i;
+	    for (;;)
+	    {
+	      i = j;
+	      j = next_index (i, start_point, end_point);
+	      if (referenced.arrayZ[i] && !referenced.arrayZ[j]) break;
+	    }
+	    prev = j = i;
+	    for (;;)
+	    {
+	      i = j;
+	      j = next_index (i, start_point, end_point);
+	      if (!referenced.arrayZ[i] && referenced.arrayZ[j]) break;
+	    }
+	    next = j;
+	    i = prev;
+	    for (;;)
+	    {
+	      i = next_index (i, start_point, end_point);
+	      if (i == next) break;
+	      iup_t step = {i, prev, next};
+	      infer_kind (orig_x.arrayZ[i], orig_x.arrayZ[prev], orig_x.arrayZ[next],
+			  &step.x_kind, &step.x_r);
+	      infer_kind (orig_y.arrayZ[i], orig_y.arrayZ[prev], orig_y.arrayZ[next],
+			  &step.y_kind, &step.y_r);
+	      iup.push (step);
+	      if (--unref_count == 0) goto no_more_gaps;
+	    }
+	  }
+	no_more_gaps:
+	  start_point = end_point + 1;
+	}
+
+	return !iup.in_error ();
+      }
+
+      /* Returns the decompiled deltas of tuple i.  They are kept in the
+       * entry unless the cache is over GLYPH_CACHE_MAX_BYTES; then they are
+       * also returned in *owned, for the caller to free. */
+      const tuple_deltas_t *get_tuple_deltas (unsigned i,
+					      tuple_deltas_t **owned) const
+      {
+      retry:
+	tuple_deltas_t *decompiled = tuple_deltas[i].get_acquire ();
+	if (decompiled)
+	  return decompiled;
+
+	decompiled = decompile_tuple (i);
+	if (unlikely (!decompiled))
+	  return nullptr;
+	if ((size_t) cache_bytes->get_relaxed () > GLYPH_CACHE_MAX_BYTES)
+	{
+	  *owned = decompiled;
+	  return decompiled;
+	}
+	if (unlikely (!tuple_deltas[i].cmpexch (nullptr, decompiled)))
+	{
+	  decompiled->~tuple_deltas_t ();
+	  hb_free (decompiled);
+	  goto retry;
+	}
+	charge (sizeof (tuple_deltas_t) +
+		decompiled->indices.allocated * sizeof (unsigned) +
+		(decompiled->x.allocated + decompiled->y.allocated) * sizeof (float) +
+		decompiled->iup.allocated * sizeof (iup_t));
+	return decompiled;
+      }
+
+      bool apply (hb_array_t<const int> coords,
+		  unsigned num_coords,
+		  hb_array_t<const F2DOT14> shared_tuples,
+		  const hb_vector_t<hb_pair_t<int, int>> *shared_tuple_active_idx,
+		  const hb_array_t<contour_point_t> points,
+		  bool phantom_only) const
+      {
+	contour_point_vector_t deltas_vec; // Populated lazily
+	auto deltas = deltas_vec.as_array ();
+
+	unsigned count = points.length;
+	unsigned first = phantom_only ? count - 4 : 0;
+	bool flush = false;
+	for (unsigned t = 0; t < tuples.length; t++)
+	{
+	  float scalar = tuples.arrayZ[t].header->calculate_scalar (coords, num_coords, shared_tuples,
+								    shared_tuple_active_idx);
+	  if (scalar == 0.f) continue;
+
+	  if (!deltas)
+	  {
+	    if (unlikely (!deltas_vec.resize (count, false))) return false;
+	    deltas = deltas_vec.as_array ();
+	    hb_memset (deltas.arrayZ + first, 0, (count - first) * sizeof (deltas[0]));
+	  }
+
+	  tuple_deltas_t *owned = nullptr;
+	  const tuple_deltas_t *tuple = get_tuple_deltas (t, &owned);
+	  if (unlikely (!tuple)) return false;
+
+	  if (!tuple->apply_to_all)
+	  {
+	    if (flush)
+	    {
+	      for (unsigned int i = first; i < count; i++)
+		points.arrayZ[i].translate (deltas.arrayZ[i]);
+	      flush = false;
+	    }
+	    hb_memset (deltas.arrayZ + first, 0, (count - first) * sizeof (deltas[0]));
+	  }
+
+	  const float *xs = tuple->x.arrayZ;
+	  const float *ys = tuple->y.arrayZ;
+	  if (tuple->apply_to_all)
+	  {
+	    if (scalar != 1.0f)
+	      for (unsigned int i = first; i < count; i++)
+	      {
+		deltas.arrayZ[i].x += xs[i] * scalar;
+		deltas.arrayZ[i].y += ys[i] * scalar;
+	      }
+	    else
+	      for (unsigned int i = first; i < count; i++)
+	      {
+		deltas.arrayZ[i].x += xs[i];
+		deltas.arrayZ[i].y += ys[i];
+	      }
+	  }
+	  else
+	  {
+	    const unsigned *tuple_indices = tuple->indices.arrayZ;
+	    unsigned length = tuple->indices.length;
+	    for (unsigned int i = 0; i < length; i++)
+	    {
+	      unsigned int pt_index = tuple_indices[i];
+	      if (phantom_only && pt_index < first) continue;
+	      auto &delta = deltas.arrayZ[pt_index];
+	      if (scalar != 1.0f)
+	      {
+		delta.x += xs[i] * scalar;
+		delta.y += ys[i] * scalar;
+	      }
+	      else
+	      {
+		delta.x += xs[i];
+		delta.y += ys[i];
+	      }
+	    }
+
+	    if (!phantom_only)
+	      for (const iup_t &step : tuple->iup)
+	      {
+		deltas.arrayZ[step.target].x = infer (step.x_kind, step.x_r,
+						      deltas.arrayZ[step.prev].x,
+						      deltas.arrayZ[step.next].x);
+		deltas.arrayZ[step.target].y = infer (step.y_kind, step.y_r,
+						      deltas.arrayZ[step.prev].y,
+						      deltas.arrayZ[step.next].y);
+	      }
+	  }
+
+	  if (owned)
+	  {
+	    owned->~tuple_deltas_t ();
+	    hb_free (owned);
+	  }
+	  flush = true;
+	}
+
+	if (flush)
+	{
+	  for (unsigned int i = first; i < count; i++)
+	    points.arrayZ[i].translate (deltas.arrayZ[i]);
+	}
+
+	return true;
+      }
+
+      hb_atomic_int_t ref_count;
+      hb_codepoint_t glyph;
+      unsigned num_points;
+      mutable hb_atomic_int_t size;	/* Bytes held, counted in *cache_bytes. */
+      hb_atomic_int_t *cache_bytes;
+      bool has_iup;
+      bool used;	/* Under glyph_cache_mutex. */
+      hb_vector_t<tuple_t> tuples;
+      hb_atomic_ptr_t<tuple_deltas_t> *tuple_deltas; /* One per tuple, lazily. */
+      hb_vector_t<unsigned int> shared_indices;
+      hb_vector_t<float> orig_x;	/* If has_iup. */
+      hb_vector_t<float> orig_y;	/* If has_iup. */
+      hb_vector_t<unsigned> end_points;	/* If has_iup. */
+    };
+
+    /* Returns a reference to the decompiled deltas of glyph, fit for
+     * points, or nullptr if they are not cached.  On a miss, *admit says
+     * whether to cache them: an entry that was stored or used since the
+     * last miss on its slot stays, so glyphs that take turns on a slot are
+     * not decompiled into the cache over and over. */
+    glyph_deltas_t *get_cached_deltas (hb_codepoint_t glyph,
+				       unsigned num_points,
+				       bool need_iup,
+				       bool *admit) const
+    {
+      *admit = false;
+      if (!glyph_cache)
+	return nullptr;
+      hb_lock_t lock (glyph_cache_mutex);
+      glyph_deltas_t *deltas = glyph_cache[glyph % GLYPH_CACHE_SIZE];
+      if (deltas && deltas->glyph == glyph && deltas->num_points == num_points &&
+	  (deltas->has_iup || !need_iup))
+      {
+	deltas->used = true;
+	return deltas->reference ();
+      }
+      /* Past the budget, only replace entries; that frees their bytes. */
+      if (!deltas)
+	*admit = (size_t) glyph_cache_bytes.get_relaxed () < GLYPH_CACHE_MAX_BYTES;
+      else
+      {
+	*admit = deltas->glyph == glyph || !deltas->used;
+	deltas->used = false;
+      }
+      return nullptr;
+    }
+
+    void set_cached_deltas (glyph_deltas_t *deltas) const
+    {
+      /* Bound what an entry can grow to once all its tuples apply. */
+      if (!glyph_cache ||
+	  deltas->tuples.length * deltas->num_points > GLYPH_CACHE_MAX_ENTRY_DELTAS)
+	return;
+      glyph_deltas_t *old;
+      {
+	hb_lock_t lock (glyph_cache_mutex);
+	deltas->used = true;
+	old = glyph_cache[deltas->glyph % GLYPH_CACHE_SIZE];
+	glyph_cache[deltas->glyph % GLYPH_CACHE_SIZE] = deltas->reference ();
+      }
+      if (old)
+	old->destroy ();
+    }
+#endif
+
     public:
     bool apply_deltas_to_points (hb_codepoint_t glyph,
 				 hb_array_t<const int> coords,
@@ -632,6 +1140,45 @@ struct gvar
 
       hb_bytes_t var_data_bytes = table->get_glyph_var_data_bytes (table.get_blob (), glyphCount, glyph);
       if (!var_data_bytes.as<GlyphVariationData> ()->has_data ()) return true;
+
+#ifndef HB_NO_GVAR_CACHE
+      bool admit;
+      glyph_deltas_t *deltas = get_cached_deltas (glyph, points.length, !phantom_only, &admit);
+      if (!deltas)
+      {
+	if (!admit)
+	  return apply_deltas_to_points_uncached (var_data_bytes, coords, points, phantom_only);
+	deltas = glyph_deltas_t::create ();
+	if (unlikely (!deltas))
+	  return apply_deltas_to_points_uncached (var_data_bytes, coords, points, phantom_only);
+	/* Points are not read in phantom_only mode; no inference then. */
+	if (!deltas->init (glyph, var_data_bytes, table->axisCount, points, !phantom_only,
+			   &glyph_cache_bytes))
+	{
+	  /* Let the uncached path decide; it skips tuples that do not apply. */
+	  deltas->destroy ();
+	  return apply_deltas_to_points_uncached (var_data_bytes, coords, points, phantom_only);
+	}
+	set_cached_deltas (deltas);
+      }
+
+      unsigned num_coords = table->axisCount;
+      hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * num_coords);
+      bool ret = deltas->apply (coords, num_coords, shared_tuples, &shared_tuple_active_idx,
+				points, phantom_only);
+      deltas->destroy ();
+      return ret;
+#else
+      return apply_deltas_to_points_uncached (var_data_bytes, coords, points, phantom_only);
+#endif
+    }
+
+    private:
+    bool apply_deltas_to_points_uncached (hb_bytes_t var_data_bytes,
+					  hb_array_t<const int> coords,
+					  const hb_array_t<contour_point_t> points,
+					  bool phantom_only) const
+    {
       hb_vector_t<unsigned int> shared_indices;
       GlyphVariationData::tuple_iterator_t iterator;
       if (!GlyphVariationData::get_tuple_iterator (var_data_bytes, table->axisCount,
@@ -851,12 +1398,23 @@ struct gvar
       return true;
     }
 
+    public:
     unsigned int get_axis_count () const { return table->axisCount; }
 
     private:
     hb_blob_ptr_t<gvar> table;
     unsigned glyphCount;
     hb_vector_t<hb_pair_t<int, int>> shared_tuple_active_idx;
+#ifndef HB_NO_GVAR_CACHE
+    static constexpr unsigned GLYPH_CACHE_SIZE = 512;
+    static constexpr unsigned GLYPH_CACHE_MAX_ENTRY_DELTAS = 65536;
+    mutable hb_mutex_t glyph_cache_mutex;
+    glyph_deltas_t **glyph_cache = nullptr; /* GLYPH_CACHE_SIZE slots. */
+    /* Once entries, cached or in use, hold GLYPH_CACHE_MAX_BYTES, empty
+     * slots stay empty and newly decompiled tuples are not kept. */
+    static constexpr size_t GLYPH_CACHE_MAX_BYTES = 4u << 20;
+    mutable hb_atomic_int_t glyph_cache_bytes; /* Bytes entries hold. */
+#endif
   };
 
   protected:
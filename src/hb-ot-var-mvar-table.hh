@@ -130,7 +130,8 @@ struct MVAR
   }
 
   float get_var (hb_tag_t tag,
-		 const int *coords, unsigned int coord_count) const
+		 const int *coords, unsigned int coord_count,
+		 ItemVariationStore::cache_t *store_cache = nullptr) const
   {
     const VariationValueRecord *record;
     record = (VariationValueRecord *) hb_bsearch (tag,
@@ -141,7 +142,13 @@ struct MVAR
     if (!record)
       return 0.;
 
-    return (this+varStore).get_delta (record->varIdx, coords, coord_count);
+    return (this+varStore).get_delta (record->varIdx, coords, coord_count, store_cache);
+  }
+
+  float get_var (hb_tag_t tag, hb_font_t *font) const
+  {
+    return get_var (tag, font->coords, font->num_coords,
+		    font->get_var_store_scalars (hb_font_t::VAR_STORE_MVAR, this+varStore));
   }
 
 protected:
@@ -34,9 +34,11 @@
 #include "hb-machinery.hh"
 
 
-void hb_outline_t::replay (hb_draw_funcs_t *pen, void *pen_data) const
+void hb_outline_t::replay (hb_draw_funcs_t *pen, void *pen_data,
+			   float x_mult, float y_mult,
+			   float slant) const
 {
-  hb_draw_state_t st = HB_DRAW_STATE_DEFAULT;
+  hb_draw_session_t draw_session (pen, pen_data, slant);
 
   unsigned first = 0;
   for (unsigned contour : contours)
@@ -49,37 +51,33 @@ void hb_outline_t::replay (hb_draw_funcs_t *pen, void *pen_data) const
       {
 	case hb_outline_point_t::type_t::MOVE_TO:
 	{
-	  pen->move_to (pen_data, st,
-			   p1.x, p1.y);
+	  draw_session.move_to (p1.x * x_mult, p1.y * y_mult);
 	}
 	break;
 	case hb_outline_point_t::type_t::LINE_TO:
 	{
-	  pen->line_to (pen_data, st,
-			   p1.x, p1.y);
+	  draw_session.line_to (p1.x * x_mult, p1.y * y_mult);
 	}
 	break;
 	case hb_outline_point_t::type_t::QUADRATIC_TO:
 	{
 	  hb_outline_point_t p2 = *it++;
-	  pen->quadratic_to (pen_data, st,
-				p1.x, p1.y,
-				p2.x, p2.y);
+	  draw_session.quadratic_to (p1.x * x_mult, p1.y * y_mult,
+				     p2.x * x_mult, p2.y * y_mult);
 	}
 	break;
 	case hb_outline_point_t::type_t::CUBIC_TO:
 	{
 	  hb_outline_point_t p2 = *it++;
 	  hb_outline_point_t p3 = *it++;
-	  pen->cubic_to (pen_data, st,
-			    p1.x, p1.y,
-			    p2.x, p2.y,
-			    p3.x, p3.y);
+	  draw_session.cubic_to (p1.x * x_mult, p1.y * y_mult,
+				 p2.x * x_mult, p2.y * y_mult,
+				 p3.x * x_mult, p3.y * y_mult);
 	}
 	break;
       }
     }
-    pen->close_path (pen_data, st);
+    draw_session.close_path ();
     first = contour;
   }
 }
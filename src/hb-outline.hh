@@ -67,7 +67,10 @@ struct hb_outline_t
 {
   void reset () { points.shrink (0, false); contours.resize (0); }
 
-  HB_INTERNAL void replay (hb_draw_funcs_t *pen, void *pen_data) const;
+  /* Points are scaled by x_mult / y_mult, then slanted, on the way out. */
+  HB_INTERNAL void replay (hb_draw_funcs_t *pen, void *pen_data,
+			   float x_mult = 1.f, float y_mult = 1.f,
+			   float slant = 0.f) const;
   HB_INTERNAL float control_area () const;
   HB_INTERNAL void embolden (float x_strength, float y_strength,
 			     float x_shift, float y_shift);
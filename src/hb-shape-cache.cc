@@ -0,0 +1,756 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+
+#ifndef HB_NO_SHAPER
+
+#include "hb-buffer.hh"
+#include "hb-font.hh"
+#include "hb-map.hh"
+#include "hb-mutex.hh"
+
+
+/* Number of independently-locked shards.  Must be a power of two. */
+#define HB_SHAPE_CACHE_NUM_SHARDS 16u
+#define HB_SHAPE_CACHE_DEFAULT_MAX_ENTRIES 4096u
+/* Only word-sized runs are worth caching. */
+#define HB_SHAPE_CACHE_MAX_TEXT_LENGTH 64u
+
+
+/*
+ * hb_shape_cache_key_t
+ *
+ * Everything that can change the output of hb_shape_full().  Input
+ * clusters are compared relative to the first cluster, such that the
+ * same word at different text offsets shares one entry.
+ *
+ * The pre- and post-context contents are only part of the key for runs
+ * the shaper consulted the context for (eg. Arabic joining); for the rest
+ * only whether there is any context matters (eg. dotted-circle insertion).
+ */
+
+struct hb_shape_cache_key_t
+{
+  hb_font_t *font;
+  unsigned int font_serial;
+  hb_unicode_funcs_t *unicode;
+  hb_segment_properties_t props;
+  hb_buffer_flags_t flags;
+  hb_buffer_cluster_level_t cluster_level;
+  hb_codepoint_t invisible;
+  hb_codepoint_t not_found;
+  hb_codepoint_t not_found_variation_selector;
+  bool has_pre_context;
+  bool has_post_context;
+  hb_array_t<const hb_codepoint_t> context[2];
+  hb_array_t<const hb_feature_t> features;
+  hb_array_t<const hb_glyph_info_t> text;
+  uint32_t hash_value;
+
+  void init (hb_font_t *font_,
+	     const hb_buffer_t *buffer,
+	     const hb_feature_t *features_,
+	     unsigned int num_features,
+	     bool with_context)
+  {
+    font = font_;
+    font_serial = font->serial;
+    unicode = buffer->unicode;
+    props = buffer->props;
+    flags = buffer->flags;
+    cluster_level = buffer->cluster_level;
+    invisible = buffer->invisible;
+    not_found = buffer->not_found;
+    not_found_variation_selector = buffer->not_found_variation_selector;
+    has_pre_context = buffer->context_len[0];
+    has_post_context = buffer->context_len[1];
+    for (unsigned int i = 0; i < 2; i++)
+      context[i] = with_context ? hb_array (buffer->context[i], buffer->context_len[i])
+				: hb_array_t<const hb_codepoint_t> ();
+    features = hb_array (features_, num_features);
+    text = hb_array (buffer->info, buffer->len);
+
+    /* FNV-1a, like hb_array_t::hash(). */
+    uint32_t h = 0x84222325;
+    auto fold = [&] (uint32_t v) { h = (h ^ v) * 16777619; };
+    fold (hb_hash ((uintptr_t) font));
+    fold (font_serial);
+    fold (hb_hash ((uintptr_t) unicode));
+    fold (hb_segment_properties_hash (&props));
+    fold (flags);
+    fold ((unsigned) cluster_level);
+    fold (invisible);
+    fold (not_found);
+    fold (not_found_variation_selector);
+    fold (has_pre_context | (has_post_context << 1));
+    for (unsigned int i = 0; i < 2; i++)
+    {
+      fold (context[i].length);
+      for (hb_codepoint_t u : context[i])
+	fold (u);
+    }
+    for (const hb_feature_t &f : features)
+    {
+      fold (f.tag);
+      fold (f.value);
+    }
+    unsigned int base = text.length ? text[0].cluster : 0;
+    for (const hb_glyph_info_t &info : text)
+    {
+      fold (info.codepoint);
+      fold (info.cluster - base);
+    }
+    hash_value = h;
+  }
+
+  uint32_t hash () const { return hash_value; }
+
+  bool operator == (const hb_shape_cache_key_t &o) const
+  {
+    if (!(hash_value == o.hash_value &&
+	  font == o.font &&
+	  font_serial == o.font_serial &&
+	  unicode == o.unicode &&
+	  hb_segment_properties_equal (&props, &o.props) &&
+	  flags == o.flags &&
+	  cluster_level == o.cluster_level &&
+	  invisible == o.invisible &&
+	  not_found == o.not_found &&
+	  not_found_variation_selector == o.not_found_variation_selector &&
+	  has_pre_context == o.has_pre_context &&
+	  has_post_context == o.has_post_context &&
+	  context[0] == o.context[0] &&
+	  context[1] == o.context[1] &&
+	  features.length == o.features.length &&
+	  text.length == o.text.length))
+      return false;
+
+    for (unsigned int i = 0; i < features.length; i++)
+      if (features[i].tag != o.features[i].tag ||
+	  features[i].value != o.features[i].value)
+	return false;
+
+    unsigned int base = text.length ? text[0].cluster : 0;
+    unsigned int o_base = o.text.length ? o.text[0].cluster : 0;
+    for (unsigned int i = 0; i < text.length; i++)
+      if (text[i].codepoint != o.text[i].codepoint ||
+	  text[i].cluster - base != o.text[i].cluster - o_base)
+	return false;
+
+    return true;
+  }
+};
+
+struct hb_shape_cache_entry_t
+{
+  ~hb_shape_cache_entry_t () { hb_font_destroy (key.font); }
+
+  /* The key's arrays point into our own copies.  Holding a reference
+   * on the font makes sure its address is not recycled while the entry
+   * is alive. */
+  bool init (const hb_shape_cache_key_t &key_)
+  {
+    key = key_;
+    for (unsigned int i = 0; i < 2; i++)
+    {
+      if (unlikely (!context[i].resize (key.context[i].length, false)))
+	return false;
+      hb_memcpy (context[i].arrayZ, key.context[i].arrayZ, key.context[i].get_size ());
+      key.context[i] = context[i].as_array ();
+    }
+    if (unlikely (!features.resize (key.features.length, false) ||
+		  !text.resize (key.text.length, false)))
+      return false;
+    hb_memcpy (features.arrayZ, key.features.arrayZ, key.features.get_size ());
+    hb_memcpy (text.arrayZ, key.text.arrayZ, key.text.get_size ());
+    key.features = features.as_array ();
+    key.text = text.as_array ();
+    hb_font_reference (key.font);
+    return true;
+  }
+
+  bool set_output (const hb_buffer_t *buffer)
+  {
+    if (unlikely (!info.resize (buffer->len, false) ||
+		  !pos.resize (buffer->len, false)))
+      return false;
+    unsigned int base = text[0].cluster;
+    for (unsigned int i = 0; i < buffer->len; i++)
+    {
+      info.arrayZ[i] = buffer->info[i];
+      info.arrayZ[i].cluster -= base;
+      pos.arrayZ[i] = buffer->pos[i];
+    }
+    return true;
+  }
+
+  bool replay (hb_buffer_t *buffer) const
+  {
+    unsigned int base = buffer->info[0].cluster;
+    if (unlikely (!buffer->ensure (info.length)))
+      return false;
+
+    for (unsigned int i = 0; i < info.length; i++)
+    {
+      buffer->info[i] = info.arrayZ[i];
+      buffer->info[i].cluster += base;
+    }
+    hb_memcpy (buffer->pos, pos.arrayZ, pos.get_size ());
+    buffer->len = info.length;
+    buffer->have_positions = true;
+    buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+    return true;
+  }
+
+  hb_shape_cache_key_t key;
+  hb_vector_t<hb_codepoint_t> context[2];
+  hb_vector_t<hb_feature_t> features;
+  hb_vector_t<hb_glyph_info_t> text;
+  hb_vector_t<hb_glyph_info_t> info;
+  hb_vector_t<hb_glyph_position_t> pos;
+
+  /* Set by readers; cleared by the replacement clock. */
+  hb_atomic_int_t referenced;
+  /* Retired-list link. */
+  hb_shape_cache_entry_t *next;
+};
+
+static hb_shape_cache_entry_t *
+_hb_shape_cache_entry_create (const hb_shape_cache_key_t &key)
+{
+  hb_shape_cache_entry_t *entry = (hb_shape_cache_entry_t *) hb_calloc (1, sizeof (hb_shape_cache_entry_t));
+  if (unlikely (!entry))
+    return nullptr;
+  new (entry) hb_shape_cache_entry_t ();
+  if (unlikely (!entry->init (key)))
+  {
+    entry->key.font = nullptr;
+    entry->~hb_shape_cache_entry_t ();
+    hb_free (entry);
+    return nullptr;
+  }
+  return entry;
+}
+
+static void
+_hb_shape_cache_entry_destroy (hb_shape_cache_entry_t *entry)
+{
+  entry->~hb_shape_cache_entry_t ();
+  hb_free (entry);
+}
+
+#define HB_SHAPE_CACHE_WAYS 4u
+
+/*
+ * hb_shape_cache_shard_t
+ *
+ * A set-associative table of immutable entries.  Lookups do not lock:
+ * they enter the current epoch.  Entries that writers replace are retired,
+ * and freed once the lookups that entered before the next epoch started
+ * have left.  Writers serialize on the mutex and pick victims with a clock
+ * over the referenced bits.
+ */
+
+struct hb_shape_cache_shard_t
+{
+  ~hb_shape_cache_shard_t ()
+  {
+    clear ();
+    free_entries (retired[0]);
+    free_entries (retired[1]);
+    hb_free (slots);
+  }
+
+  bool init (unsigned int max_population)
+  {
+    ways = hb_min (HB_SHAPE_CACHE_WAYS, max_population);
+    num_sets = max_population / ways;
+    max_retired = hb_max (ways, max_population / 8);
+    slots = (hb_atomic_ptr_t<hb_shape_cache_entry_t> *) hb_calloc (num_sets * ways, sizeof (slots[0]));
+    return slots;
+  }
+
+  hb_atomic_ptr_t<hb_shape_cache_entry_t> *get_set (uint32_t hash) const
+  { return slots + ((hash / HB_SHAPE_CACHE_NUM_SHARDS) % num_sets) * ways; }
+
+  void clear ()
+  {
+    hb_lock_t lock (mutex);
+    for (unsigned int i = 0; i < num_sets * ways; i++)
+      retire (slots[i].get_relaxed (), slots[i]);
+    reclaim ();
+  }
+
+  bool replay (const hb_shape_cache_key_t &key, hb_buffer_t *buffer)
+  {
+    unsigned int e = epoch.enter ();
+
+    bool ret = false;
+    hb_atomic_ptr_t<hb_shape_cache_entry_t> *set = get_set (key.hash ());
+    for (unsigned int i = 0; i < ways; i++)
+    {
+      const hb_shape_cache_entry_t *entry = set[i].get_acquire ();
+      if (entry && entry->key == key)
+      {
+	if (!entry->referenced.get_relaxed ())
+	  const_cast<hb_shape_cache_entry_t *> (entry)->referenced.set_relaxed (1);
+	ret = entry->replay (buffer);
+	break;
+      }
+    }
+
+    epoch.leave (e);
+    return ret;
+  }
+
+  /* Takes ownership of entry. */
+  void insert (hb_shape_cache_entry_t *entry,
+	       hb_atomic_int_t &evictions)
+  {
+    hb_lock_t lock (mutex);
+    hb_atomic_ptr_t<hb_shape_cache_entry_t> *set = get_set (entry->key.hash ());
+
+    hb_atomic_ptr_t<hb_shape_cache_entry_t> *victim = nullptr;
+    for (unsigned int i = 0; i < ways; i++)
+    {
+      const hb_shape_cache_entry_t *old = set[i].get_relaxed ();
+      if (old && old->key == entry->key)
+      {
+	/* Another thread beat us to it. */
+	_hb_shape_cache_entry_destroy (entry);
+	return;
+      }
+      if (!old && !victim)
+	victim = &set[i];
+    }
+
+    if (!victim)
+      for (;;)
+      {
+	hb_atomic_ptr_t<hb_shape_cache_entry_t> *slot = &set[hand++ % ways];
+	hb_shape_cache_entry_t *old = slot->get_relaxed ();
+	if (!old->referenced.get_relaxed ())
+	{
+	  victim = slot;
+	  evictions.inc ();
+	  break;
+	}
+	old->referenced.set_relaxed (0);
+      }
+
+    retire (victim->get_relaxed (), *victim, entry);
+    reclaim ();
+  }
+
+  /* Must be called with the mutex held. */
+  void retire (hb_shape_cache_entry_t *old,
+	       hb_atomic_ptr_t<hb_shape_cache_entry_t> &slot,
+	       hb_shape_cache_entry_t *entry = nullptr)
+  {
+    if (!old && !entry) return;
+    slot.cmpexch (old, entry);
+    if (old)
+    {
+      old->next = retired[1];
+      retired[1] = old;
+      num_retired++;
+    }
+  }
+
+  /* Frees the retired entries that no lookup can still be reading, and
+   * moves the others on to a new epoch.  Must be called with the mutex
+   * held.  While more than max_retired entries are left, waits for the
+   * lookups in flight, so that retired entries stay bounded under load. */
+  void reclaim ()
+  {
+    for (;;)
+    {
+      if (epoch.previous_done ())
+      {
+	num_retired -= free_entries (retired[0]);
+	retired[0] = retired[1];
+	retired[1] = nullptr;
+	if (!retired[0])
+	  return;
+	epoch.advance ();
+	continue;
+      }
+      if (num_retired <= max_retired)
+	return;
+    }
+  }
+
+  static unsigned int free_entries (hb_shape_cache_entry_t *entry)
+  {
+    unsigned int count = 0;
+    while (entry)
+    {
+      hb_shape_cache_entry_t *next = entry->next;
+      _hb_shape_cache_entry_destroy (entry);
+      entry = next;
+      count++;
+    }
+    return count;
+  }
+
+  hb_mutex_t mutex;
+  hb_epoch_t epoch;
+  hb_atomic_ptr_t<hb_shape_cache_entry_t> *slots;
+  unsigned int ways;
+  unsigned int num_sets;
+  unsigned int hand;
+  /* Entries retired before, and since, the current epoch started. */
+  hb_shape_cache_entry_t *retired[2];
+  unsigned int num_retired;
+  unsigned int max_retired;
+};
+
+struct hb_shape_cache_t
+{
+  ~hb_shape_cache_t () { fini (); }
+
+  void fini ()
+  {
+    if (!shards) return;
+    for (unsigned int i = 0; i < HB_SHAPE_CACHE_NUM_SHARDS; i++)
+      shards[i].~hb_shape_cache_shard_t ();
+    hb_free (shards);
+    shards = nullptr;
+  }
+
+  hb_object_header_t header;
+  hb_shape_cache_shard_t *shards;
+  hb_atomic_int_t hits;
+  hb_atomic_int_t misses;
+  hb_atomic_int_t evictions;
+};
+
+
+/**
+ * hb_shape_cache_create:
+ * @max_entries: Maximum number of shaping results to keep, or 0
+ *   for a default
+ *
+ * Creates a new shaping-result cache, to be used with
+ * hb_shape_cache_shape().
+ *
+ * The cache can be shared between threads.  Lookups do not take
+ * locks; only storing new results does.  Results replaced while other
+ * threads read them are kept until those reads are done; storing waits
+ * for them once those exceed an eighth of @max_entries.
+ *
+ * Return value: (transfer full): The new shape cache
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_create (unsigned int max_entries)
+{
+  hb_shape_cache_t *cache;
+
+  if (!(cache = hb_object_create<hb_shape_cache_t> ()))
+    return hb_shape_cache_get_empty ();
+
+  cache->shards = (hb_shape_cache_shard_t *) hb_calloc (HB_SHAPE_CACHE_NUM_SHARDS,
+							sizeof (hb_shape_cache_shard_t));
+  if (unlikely (!cache->shards))
+  {
+    hb_shape_cache_destroy (cache);
+    return hb_shape_cache_get_empty ();
+  }
+
+  if (!max_entries)
+    max_entries = HB_SHAPE_CACHE_DEFAULT_MAX_ENTRIES;
+  unsigned int max_population = hb_max (1u, (max_entries + HB_SHAPE_CACHE_NUM_SHARDS - 1) / HB_SHAPE_CACHE_NUM_SHARDS);
+  for (unsigned int i = 0; i < HB_SHAPE_CACHE_NUM_SHARDS; i++)
+    new (&cache->shards[i]) hb_shape_cache_shard_t ();
+  for (unsigned int i = 0; i < HB_SHAPE_CACHE_NUM_SHARDS; i++)
+    if (unlikely (!cache->shards[i].init (max_population)))
+    {
+      hb_shape_cache_destroy (cache);
+      return hb_shape_cache_get_empty ();
+    }
+
+  return cache;
+}
+
+/**
+ * hb_shape_cache_get_empty:
+ *
+ * Fetches the singleton empty shape cache.  Shaping through it
+ * never caches anything.
+ *
+ * Return value: (transfer full): The empty shape cache
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_get_empty ()
+{
+  return const_cast<hb_shape_cache_t *> (&Null (hb_shape_cache_t));
+}
+
+/**
+ * hb_shape_cache_reference: (skip)
+ * @cache: A shape cache
+ *
+ * Increases the reference count on a shape cache.
+ *
+ * Return value: (transfer full): The shape cache
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache)
+{
+  return hb_object_reference (cache);
+}
+
+/**
+ * hb_shape_cache_destroy: (skip)
+ * @cache: A shape cache
+ *
+ * Decreases the reference count on a shape cache. When the
+ * reference count reaches zero, the cache is destroyed,
+ * freeing all memory and releasing the fonts it references.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_cache_destroy (hb_shape_cache_t *cache)
+{
+  if (!hb_object_destroy (cache)) return;
+
+  hb_free (cache);
+}
+
+/**
+ * hb_shape_cache_set_user_data: (skip)
+ * @cache: A shape cache
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified shape cache.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace)
+{
+  return hb_object_set_user_data (cache, key, data, destroy, replace);
+}
+
+/**
+ * hb_shape_cache_get_user_data: (skip)
+ * @cache: A shape cache
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified shape cache.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * XSince: REPLACEME
+ **/
+void *
+hb_shape_cache_get_user_data (const hb_shape_cache_t *cache,
+			      hb_user_data_key_t     *key)
+{
+  return hb_object_get_user_data (cache, key);
+}
+
+/**
+ * hb_shape_cache_clear:
+ * @cache: A shape cache
+ *
+ * Drops all shaping results stored in @cache, releasing the fonts
+ * they reference.  Waits for other threads to finish reading the
+ * results they are replaying.  Statistics are not reset.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_cache_clear (hb_shape_cache_t *cache)
+{
+  if (unlikely (!cache->shards))
+    return;
+
+  for (unsigned int i = 0; i < HB_SHAPE_CACHE_NUM_SHARDS; i++)
+    cache->shards[i].clear ();
+}
+
+/**
+ * hb_shape_cache_get_stats:
+ * @cache: A shape cache
+ * @hits: (out) (optional): Number of shaping calls answered from the cache
+ * @misses: (out) (optional): Number of cacheable shaping calls that were
+ *   not found in the cache
+ * @evictions: (out) (optional): Number of results dropped to stay within
+ *   the size limit
+ *
+ * Fetches usage statistics of @cache.  Calls that were not eligible for
+ * caching are not counted.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_cache_get_stats (const hb_shape_cache_t *cache,
+			  unsigned int           *hits,      /* OUT */
+			  unsigned int           *misses,    /* OUT */
+			  unsigned int           *evictions  /* OUT */)
+{
+  if (hits) *hits = cache->hits.get_relaxed ();
+  if (misses) *misses = cache->misses.get_relaxed ();
+  if (evictions) *evictions = cache->evictions.get_relaxed ();
+}
+
+
+static bool
+_hb_shape_cache_is_cacheable (hb_buffer_t        *buffer,
+			      const hb_feature_t *features,
+			      unsigned int        num_features,
+			      const char * const *shaper_list)
+{
+  if (shaper_list ||
+      buffer->len > HB_SHAPE_CACHE_MAX_TEXT_LENGTH ||
+      buffer->content_type != HB_BUFFER_CONTENT_TYPE_UNICODE ||
+      (buffer->flags & HB_BUFFER_FLAG_VERIFY) ||
+      buffer->messaging () ||
+      buffer->profiling ())
+    return false;
+
+  /* Feature ranges refer to absolute cluster values. */
+  for (unsigned int i = 0; i < num_features; i++)
+    if (features[i].start != HB_FEATURE_GLOBAL_START ||
+	features[i].end != HB_FEATURE_GLOBAL_END)
+      return false;
+
+  return true;
+}
+
+/**
+ * hb_shape_cache_shape:
+ * @cache: A shape cache
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Shapes @buffer like hb_shape_full() does, reusing a previous result
+ * stored in @cache if the same text was shaped before with the same
+ * font, segment properties, buffer settings, and features.
+ *
+ * Only short runs shaped with global features and the default shaper list
+ * are cached.  Results are keyed on the font object and its serial, so
+ * modifying the font invalidates its results.  The buffer pre- and
+ * post-context contents are only taken into account for text the
+ * shaper consults them for, such that context-independent words
+ * are shared regardless of their surroundings.
+ *
+ * The cache holds a reference on every font it has results for, until
+ * those results are evicted or hb_shape_cache_clear() is called.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_cache_shape (hb_shape_cache_t   *cache,
+		      hb_font_t          *font,
+		      hb_buffer_t        *buffer,
+		      const hb_feature_t *features,
+		      unsigned int        num_features,
+		      const char * const *shaper_list)
+{
+  if (unlikely (!buffer->len))
+    return true;
+
+  if (unlikely (!cache->shards) ||
+      !_hb_shape_cache_is_cacheable (buffer, features, num_features, shaper_list))
+    return hb_shape_full (font, buffer, features, num_features, shaper_list);
+
+  bool has_context = buffer->context_len[0] || buffer->context_len[1];
+
+  hb_shape_cache_key_t key;
+  key.init (font, buffer, features, num_features, false);
+  if (cache->shards[key.hash () & (HB_SHAPE_CACHE_NUM_SHARDS - 1)].replay (key, buffer))
+  {
+    cache->hits.inc ();
+    return true;
+  }
+
+  hb_shape_cache_key_t context_key;
+  if (has_context)
+  {
+    context_key.init (font, buffer, features, num_features, true);
+    if (cache->shards[context_key.hash () & (HB_SHAPE_CACHE_NUM_SHARDS - 1)].replay (context_key, buffer))
+    {
+      cache->hits.inc ();
+      return true;
+    }
+  }
+
+  cache->misses.inc ();
+
+  /* Copy the keys out before shaping overwrites the text.  We only
+   * know which one applies after shaping. */
+  hb_shape_cache_entry_t *entry = _hb_shape_cache_entry_create (key);
+  hb_shape_cache_entry_t *context_entry = has_context ? _hb_shape_cache_entry_create (context_key) : nullptr;
+
+  hb_bool_t ret = hb_shape_full (font, buffer, features, num_features, shaper_list);
+
+  if (buffer->scratch_flags & HB_BUFFER_SCRATCH_FLAG_USED_CONTEXT)
+    hb_swap (entry, context_entry);
+  if (context_entry)
+    _hb_shape_cache_entry_destroy (context_entry);
+
+  if (entry)
+  {
+    if (ret && buffer->successful && !buffer->shaping_failed && buffer->len &&
+	entry->set_output (buffer))
+    {
+      hb_shape_cache_shard_t &shard = cache->shards[entry->key.hash () & (HB_SHAPE_CACHE_NUM_SHARDS - 1)];
+      shard.insert (entry, cache->evictions);
+    }
+    else
+      _hb_shape_cache_entry_destroy (entry);
+  }
+
+  return ret;
+}
+
+
+#endif
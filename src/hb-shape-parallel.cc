@@ -0,0 +1,413 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+
+#ifndef HB_NO_SHAPER
+
+#include "hb-buffer.hh"
+
+
+/* Paragraphs shorter than this many characters per segment are
+ * shaped serially. */
+#define HB_SHAPE_PARALLEL_MIN_SEGMENT_LENGTH 32u
+/* How far past its end each segment is shaped, so that its seam with
+ * the next one can be checked at the cluster starting there. */
+#define HB_SHAPE_PARALLEL_MAX_LOOKAHEAD 32u
+
+
+/*
+ * Parallel shaping
+ *
+ * The text is split into segments, after space separators, which are
+ * shaped independently, with the surrounding text as context.  Each
+ * segment except the last is shaped a word past its end; the glyphs
+ * for that word are dropped, but the flags of the cluster starting the
+ * next segment tell whether the text following the segment affected
+ * it.  The next segment, shaped from the seam on, flags its first
+ * cluster if it was affected by the lack of text before it.  Where
+ * either side of a seam is flagged, the segments up to the next safe
+ * seam are merged and shaped again.
+ *
+ * By default segments are shaped with
+ * #HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT and seams are checked for
+ * #HB_GLYPH_FLAG_UNSAFE_TO_CONCAT, which lookups also set when they run
+ * off the end of the shaped text, so concatenating segments is the same
+ * as shaping them together.  In many fonts kerning sets it at most
+ * word boundaries though.  #HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD
+ * checks for #HB_GLYPH_FLAG_UNSAFE_TO_BREAK instead, which only
+ * lookups matching across the seam within the lookahead window set.
+ */
+
+struct hb_shape_parallel_segment_t
+{
+  unsigned int start;	    /* Text range this segment produces glyphs for. */
+  unsigned int end;
+  unsigned int shaped_end;  /* Text is shaped up to here. */
+  unsigned int glyph_start; /* Glyphs to keep, in buffer order. */
+  unsigned int glyph_end;
+  hb_buffer_t *buffer;
+  hb_bool_t ret;
+  bool dirty;
+};
+
+struct hb_shape_parallel_context_t
+{
+  hb_font_t *font;
+  hb_buffer_t *buffer;
+  const hb_feature_t *features;
+  unsigned int num_features;
+  const char * const *shaper_list;
+  hb_shape_parallel_flags_t flags;
+  hb_vector_t<hb_shape_parallel_segment_t> segments;
+  hb_vector_t<unsigned int> dirty;
+
+  bool bounded_lookahead () const
+  { return flags & HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD; }
+
+  ~hb_shape_parallel_context_t ()
+  {
+    for (auto &segment : segments)
+      hb_buffer_destroy (segment.buffer);
+  }
+
+  /* Segments are told apart by cluster values, so a boundary must also
+   * start a new cluster. */
+  bool is_boundary (unsigned int i) const
+  {
+    return i && i < buffer->len &&
+	   buffer->info[i - 1].cluster != buffer->info[i].cluster &&
+	   buffer->unicode->general_category (buffer->info[i - 1].codepoint) == HB_UNICODE_GENERAL_CATEGORY_SPACE_SEPARATOR &&
+	   buffer->unicode->general_category (buffer->info[i].codepoint) != HB_UNICODE_GENERAL_CATEGORY_SPACE_SEPARATOR;
+  }
+
+  /* First boundary at or after i, or the end of text. */
+  unsigned int next_boundary (unsigned int i) const
+  {
+    while (i < buffer->len && !is_boundary (i))
+      i++;
+    return hb_min (i, buffer->len);
+  }
+
+  unsigned int get_shaped_end (unsigned int end) const
+  {
+    if (end == buffer->len)
+      return end;
+    return hb_min (next_boundary (end + 1), end + HB_SHAPE_PARALLEL_MAX_LOOKAHEAD);
+  }
+
+  bool split (unsigned int num_segments)
+  {
+    /* find() needs clusters in logical order. */
+    for (unsigned int i = 1; i < buffer->len; i++)
+      if (buffer->info[i].cluster < buffer->info[i - 1].cluster)
+	return false;
+
+    unsigned int start = 0;
+    for (unsigned int k = 1; k <= num_segments && start < buffer->len; k++)
+    {
+      unsigned int end = k == num_segments ? buffer->len
+			 : next_boundary (hb_max (start + 1, (unsigned int) ((uint64_t) buffer->len * k / num_segments)));
+      hb_shape_parallel_segment_t *segment = segments.push ();
+      if (unlikely (segments.in_error ()))
+	return false;
+      segment->start = start;
+      segment->end = end;
+      segment->shaped_end = get_shaped_end (end);
+      segment->dirty = true;
+      start = end;
+    }
+    return true;
+  }
+
+  bool setup (hb_shape_parallel_segment_t &segment) const
+  {
+    hb_buffer_destroy (segment.buffer);
+    hb_buffer_t *b = segment.buffer = hb_buffer_create ();
+
+    hb_buffer_flags_t flags = buffer->flags;
+    if (!bounded_lookahead ())
+      flags = (hb_buffer_flags_t) (flags | HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT);
+    if (segment.start)
+      flags = (hb_buffer_flags_t) (flags & ~HB_BUFFER_FLAG_BOT);
+    if (segment.shaped_end < buffer->len)
+      flags = (hb_buffer_flags_t) (flags & ~HB_BUFFER_FLAG_EOT);
+
+    hb_buffer_set_unicode_funcs (b, buffer->unicode);
+    hb_buffer_set_segment_properties (b, &buffer->props);
+    hb_buffer_set_flags (b, flags);
+    hb_buffer_set_cluster_level (b, buffer->cluster_level);
+    hb_buffer_set_replacement_codepoint (b, buffer->replacement);
+    hb_buffer_set_invisible_glyph (b, buffer->invisible);
+    hb_buffer_set_not_found_glyph (b, buffer->not_found);
+    hb_buffer_set_not_found_variation_selector_glyph (b, buffer->not_found_variation_selector);
+    hb_buffer_append (b, buffer, segment.start, segment.shaped_end);
+
+    return b->successful;
+  }
+
+  /* Where the glyphs of b split at cluster: for forward directions the
+   * first glyph at or after it, for backward ones the first before it. */
+  static unsigned int find (const hb_buffer_t *b, unsigned int cluster)
+  {
+    bool backward = HB_DIRECTION_IS_BACKWARD (b->props.direction);
+    unsigned int i;
+    if (!backward)
+      for (i = 0; i < b->len && b->info[i].cluster < cluster; i++)
+	;
+    else
+      for (i = b->len; i && b->info[i - 1].cluster < cluster; i--)
+	;
+    return i;
+  }
+
+  static bool safe_before (const hb_buffer_t *b, unsigned int cluster,
+			   hb_glyph_flags_t unsafe)
+  {
+    for (unsigned int i = 0; i < b->len; i++)
+      if (b->info[i].cluster == cluster)
+	return !(b->info[i].mask & unsafe);
+    /* Merged into a cluster starting earlier. */
+    return false;
+  }
+
+  /* Input cluster value at the start of text position i. */
+  unsigned int cluster_at (unsigned int i) const
+  { return i < buffer->len ? buffer->info[i].cluster : UINT_MAX; }
+
+  bool seam_is_safe (const hb_shape_parallel_segment_t &left,
+		     const hb_shape_parallel_segment_t &right) const
+  {
+    unsigned int cluster = cluster_at (right.start);
+    hb_glyph_flags_t unsafe = bounded_lookahead () ? HB_GLYPH_FLAG_UNSAFE_TO_BREAK
+						   : HB_GLYPH_FLAG_UNSAFE_TO_CONCAT;
+    return left.ret && right.ret &&
+	   safe_before (left.buffer, cluster, unsafe) &&
+	   safe_before (right.buffer, cluster, unsafe) &&
+	   (!bounded_lookahead () || !lookahead_cut (left));
+  }
+
+  /* Whether lookups were still matching where the text shaped past the
+   * end of segment was cut off. */
+  bool lookahead_cut (const hb_shape_parallel_segment_t &segment) const
+  {
+    const hb_buffer_t *b = segment.buffer;
+    if (segment.shaped_end == buffer->len || !b->len)
+      return false;
+    const hb_glyph_info_t &last = HB_DIRECTION_IS_BACKWARD (b->props.direction) ? b->info[0] : b->info[b->len - 1];
+    return last.mask & HB_GLYPH_FLAG_UNSAFE_TO_BREAK;
+  }
+
+  /* Glyphs of segment that belong to its text range, in buffer order. */
+  void get_glyph_range (const hb_shape_parallel_segment_t &segment,
+			unsigned int *start, unsigned int *end) const
+  {
+    const hb_buffer_t *b = segment.buffer;
+    unsigned int i = find (b, cluster_at (segment.end));
+    if (!HB_DIRECTION_IS_BACKWARD (b->props.direction))
+    {
+      *start = 0;
+      *end = i;
+    }
+    else
+    {
+      *start = i;
+      *end = b->len;
+    }
+  }
+
+  bool assemble ()
+  {
+    /* Find all glyph ranges first; they are found by the cluster values
+     * of the text we are about to overwrite. */
+    unsigned int count = 0;
+    for (auto &segment : segments)
+    {
+      get_glyph_range (segment, &segment.glyph_start, &segment.glyph_end);
+      count += segment.glyph_end - segment.glyph_start;
+    }
+    if (unlikely (!buffer->ensure (count)))
+      return false;
+
+    bool backward = HB_DIRECTION_IS_BACKWARD (buffer->props.direction);
+    unsigned int j = 0;
+    for (unsigned int k = 0; k < segments.length; k++)
+    {
+      const auto &segment = segments.arrayZ[backward ? segments.length - 1 - k : k];
+      unsigned int n = segment.glyph_end - segment.glyph_start;
+      hb_memcpy (buffer->info + j, segment.buffer->info + segment.glyph_start, n * sizeof (buffer->info[0]));
+      hb_memcpy (buffer->pos + j, segment.buffer->pos + segment.glyph_start, n * sizeof (buffer->pos[0]));
+      j += n;
+    }
+    /* Shaping only produces these on request. */
+    if (!(buffer->flags & HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT))
+      for (unsigned int i = 0; i < count; i++)
+	buffer->info[i].mask &= ~HB_GLYPH_FLAG_UNSAFE_TO_CONCAT;
+    buffer->len = count;
+    buffer->have_positions = true;
+    buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+    return true;
+  }
+};
+
+static void
+_hb_shape_parallel_task (unsigned int index,
+			 void        *task_data)
+{
+  hb_shape_parallel_context_t *c = (hb_shape_parallel_context_t *) task_data;
+  hb_shape_parallel_segment_t &segment = c->segments[c->dirty[index]];
+  segment.ret = hb_shape_full (c->font, segment.buffer,
+			       c->features, c->num_features,
+			       c->shaper_list);
+}
+
+/**
+ * hb_shape_parallel:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ * @num_segments: the number of pieces to split @buffer into
+ * @flags: #hb_shape_parallel_flags_t for how pieces are checked
+ * @run_tasks: (scope call) (nullable): a #hb_shape_run_tasks_func_t to
+ *    run the shaping tasks, or `NULL` to run them one after another
+ * @user_data: data to pass to @run_tasks
+ *
+ * Shapes @buffer like hb_shape_full() does, but splits long text after
+ * space separators into up to @num_segments pieces that are shaped
+ * independently, using @run_tasks to run them, typically on a thread
+ * pool.
+ *
+ * Each piece is shaped a bit past its end.  Pieces that are not safe to
+ * concatenate, according to #HB_GLYPH_FLAG_UNSAFE_TO_CONCAT on either
+ * side of where they meet, are joined and shaped again, so the
+ * resulting glyphs, positions and glyph flags are the same as
+ * hb_shape_full() would produce.  In many fonts kerning marks most word
+ * boundaries that way though, so that everything ends up shaped again
+ * as one piece; see #HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD for a
+ * check that gives up that guarantee instead.
+ *
+ * Text is only split after space separators that start a new cluster.
+ * It is shaped serially if it is too short to be split, or uses a
+ * non-monotone cluster level or decreasing cluster values.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_parallel (hb_font_t                 *font,
+		   hb_buffer_t               *buffer,
+		   const hb_feature_t        *features,
+		   unsigned int               num_features,
+		   const char * const        *shaper_list,
+		   unsigned int               num_segments,
+		   hb_shape_parallel_flags_t  flags,
+		   hb_shape_run_tasks_func_t  run_tasks,
+		   void                      *user_data)
+{
+  if (unlikely (!buffer->len))
+    return true;
+
+  num_segments = hb_min (num_segments, buffer->len / HB_SHAPE_PARALLEL_MIN_SEGMENT_LENGTH);
+  if (num_segments < 2 ||
+      buffer->content_type != HB_BUFFER_CONTENT_TYPE_UNICODE ||
+      (buffer->cluster_level != HB_BUFFER_CLUSTER_LEVEL_MONOTONE_GRAPHEMES &&
+       buffer->cluster_level != HB_BUFFER_CLUSTER_LEVEL_MONOTONE_CHARACTERS) ||
+      buffer->messaging ())
+    return hb_shape_full (font, buffer, features, num_features, shaper_list);
+
+  hb_shape_parallel_context_t c;
+  c.font = font;
+  c.buffer = buffer;
+  c.features = features;
+  c.num_features = num_features;
+  c.shaper_list = shaper_list;
+  c.flags = flags;
+
+  if (!c.split (num_segments))
+    return hb_shape_full (font, buffer, features, num_features, shaper_list);
+
+  for (;;)
+  {
+    c.dirty.reset ();
+    for (unsigned int k = 0; k < c.segments.length; k++)
+      if (c.segments.arrayZ[k].dirty)
+      {
+	if (unlikely (!c.setup (c.segments.arrayZ[k])))
+	  return hb_shape_full (font, buffer, features, num_features, shaper_list);
+	c.dirty.push (k);
+      }
+    if (unlikely (c.dirty.in_error ()))
+      return hb_shape_full (font, buffer, features, num_features, shaper_list);
+    if (!c.dirty.length)
+      break;
+
+    if (run_tasks && c.dirty.length > 1)
+      run_tasks (c.dirty.length, _hb_shape_parallel_task, &c, user_data);
+    else
+      for (unsigned int i = 0; i < c.dirty.length; i++)
+	_hb_shape_parallel_task (i, &c);
+
+    for (unsigned int k : c.dirty)
+      c.segments.arrayZ[k].dirty = false;
+
+    /* Merge each run of segments joined by unsafe seams into one; check
+     * merged ones again next round. */
+    for (unsigned int k = 0; k + 1 < c.segments.length; k++)
+    {
+      unsigned int j = k;
+      while (j + 1 < c.segments.length &&
+	     !c.seam_is_safe (c.segments.arrayZ[j], c.segments.arrayZ[j + 1]))
+	j++;
+      if (j == k)
+	continue;
+
+      hb_shape_parallel_segment_t &left = c.segments.arrayZ[k];
+      left.end = c.segments.arrayZ[j].end;
+      left.shaped_end = c.segments.arrayZ[j].shaped_end;
+      left.dirty = true;
+      for (; j > k; j--)
+      {
+	hb_buffer_destroy (c.segments.arrayZ[k + 1].buffer);
+	c.segments.remove_ordered (k + 1);
+      }
+    }
+  }
+
+  hb_bool_t ret = true;
+  for (const auto &segment : c.segments)
+    ret = ret && segment.ret;
+  if (unlikely (!ret || !c.assemble ()))
+    return hb_shape_full (font, buffer, features, num_features, shaper_list);
+
+  return true;
+}
+
+
+#endif
@@ -137,7 +137,7 @@ bail:
 }
 
 bool
-hb_shape_plan_key_t::user_features_match (const hb_shape_plan_key_t *other)
+hb_shape_plan_key_t::user_features_match (const hb_shape_plan_key_t *other) const
 {
   if (this->num_user_features != other->num_user_features)
     return false;
@@ -155,7 +155,7 @@ hb_shape_plan_key_t::user_features_match (const hb_shape_plan_key_t *other)
 }
 
 bool
-hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other)
+hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other) const
 {
   return hb_segment_properties_equal (&this->props, &other->props) &&
 	 this->user_features_match (other) &&
@@ -165,6 +165,27 @@ hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other)
 	 this->shaper_func == other->shaper_func;
 }
 
+/* Must agree with equal(). */
+uint32_t
+hb_shape_plan_key_t::hash () const
+{
+  uint32_t h = hb_segment_properties_hash (&props);
+  for (unsigned int i = 0; i < num_user_features; i++)
+  {
+    const hb_feature_t &f = user_features[i];
+    h = h * 31 + f.tag;
+    h = h * 31 + f.value;
+    h = h * 31 + (f.start == HB_FEATURE_GLOBAL_START &&
+		  f.end   == HB_FEATURE_GLOBAL_END);
+  }
+#ifndef HB_NO_OT_SHAPE
+  h = h * 31 + ot.variations_index[0];
+  h = h * 31 + ot.variations_index[1];
+#endif
+  h = h * 31 + hb_hash ((uintptr_t) shaper_func);
+  return h;
+}
+
 
 /*
  * hb_shape_plan_t
@@ -463,6 +484,222 @@ hb_shape_plan_execute (hb_shape_plan_t    *shape_plan,
  * Caching
  */
 
+#define HB_SHAPE_PLAN_CACHE_WAYS 4u
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::lookup (const hb_shape_plan_key_t *key)
+{
+  hb_shape_plan_t *found = nullptr;
+
+  unsigned int e = epoch.enter ();
+  if (table_t *t = table.get_acquire ())
+  {
+    slot_t *set = t->get_set (key->hash ());
+    for (unsigned int i = 0; i < t->ways; i++)
+    {
+      hb_shape_plan_t *shape_plan = set[i].shape_plan.get_acquire ();
+      if (shape_plan && shape_plan->key.equal (key))
+      {
+	if (!set[i].referenced.get_relaxed ())
+	  set[i].referenced.set_relaxed (1);
+	found = hb_shape_plan_reference (shape_plan);
+	break;
+      }
+    }
+  }
+  epoch.leave (e);
+
+  if (found)
+    hits.inc ();
+  else
+    misses.inc ();
+  return found;
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::insert (hb_shape_plan_t *shape_plan)
+{
+  hb_lock_t l (lock);
+
+  table_t *t = table.get_relaxed ();
+  if (!t)
+  {
+    if (!max_plans || unlikely (!(t = create_table (max_plans))))
+      return shape_plan;
+    table.cmpexch (nullptr, t);
+  }
+
+  slot_t *set = t->get_set (shape_plan->key.hash ());
+  slot_t *victim = nullptr;
+  for (unsigned int i = 0; i < t->ways; i++)
+  {
+    hb_shape_plan_t *old = set[i].shape_plan.get_relaxed ();
+    if (old && old->key.equal (&shape_plan->key))
+    {
+      /* Another thread beat us to it. */
+      hb_shape_plan_destroy (shape_plan);
+      return hb_shape_plan_reference (old);
+    }
+    if (!old && !victim)
+      victim = &set[i];
+  }
+
+  if (!victim)
+    for (;;)
+    {
+      slot_t *slot = &set[hand++ % t->ways];
+      if (!slot->referenced.get_relaxed ())
+      {
+	victim = slot;
+	break;
+      }
+      slot->referenced.set_relaxed (0);
+    }
+
+  hb_shape_plan_t *old = victim->shape_plan.get_relaxed ();
+  victim->referenced.set_relaxed (0);
+  victim->shape_plan.cmpexch (old, hb_shape_plan_reference (shape_plan));
+  if (old)
+  {
+    evictions.inc ();
+    retire (old);
+  }
+
+  return shape_plan;
+}
+
+void
+hb_shape_plan_cache_t::set_max_plans (unsigned int max_plans_)
+{
+  hb_lock_t l (lock);
+  if (max_plans_ == max_plans)
+    return;
+  max_plans = max_plans_;
+
+  table_t *old = table.get_relaxed ();
+  if (!old)
+    return;
+
+  /* Move the plans that fit over to a new table, then wait for lookups
+   * that might still see the old one. */
+  table_t *t = max_plans ? create_table (max_plans) : nullptr;
+  for (unsigned int i = 0; t && i < old->num_sets * old->ways; i++)
+  {
+    hb_shape_plan_t *shape_plan = old->slots[i].shape_plan.get_relaxed ();
+    if (!shape_plan)
+      continue;
+    slot_t *set = t->get_set (shape_plan->key.hash ());
+    for (unsigned int j = 0; j < t->ways; j++)
+      if (!set[j].shape_plan.get_relaxed ())
+      {
+	set[j].shape_plan.set_relaxed (shape_plan);
+	old->slots[i].shape_plan.set_relaxed (nullptr);
+	break;
+      }
+  }
+  table.cmpexch (old, t);
+  epoch.synchronize ();
+
+  for (unsigned int i = 0; i < old->num_sets * old->ways; i++)
+    if (hb_shape_plan_t *shape_plan = old->slots[i].shape_plan.get_relaxed ())
+    {
+      evictions.inc ();
+      hb_shape_plan_destroy (shape_plan);
+    }
+  hb_free (old);
+  reclaim ();
+}
+
+/* Only called when no lookups are possible anymore. */
+void
+hb_shape_plan_cache_t::clear ()
+{
+  if (table_t *t = table.get_relaxed ())
+  {
+    for (unsigned int i = 0; i < t->num_sets * t->ways; i++)
+      hb_shape_plan_destroy (t->slots[i].shape_plan.get_relaxed ());
+    hb_free (t);
+  }
+  for (unsigned int i = 0; i < 2; i++)
+    for (hb_shape_plan_t *shape_plan : retired[i])
+      hb_shape_plan_destroy (shape_plan);
+}
+
+hb_shape_plan_cache_t::table_t *
+hb_shape_plan_cache_t::create_table (unsigned int max_plans)
+{
+  unsigned int ways = hb_min (HB_SHAPE_PLAN_CACHE_WAYS, max_plans);
+  unsigned int num_sets = max_plans / ways;
+  size_t size = sizeof (table_t) + ((size_t) num_sets * ways - 1) * sizeof (slot_t);
+  table_t *t = (table_t *) hb_calloc (1, size);
+  if (unlikely (!t))
+    return nullptr;
+  t->ways = ways;
+  t->num_sets = num_sets;
+  return t;
+}
+
+/* Must be called with lock held. */
+void
+hb_shape_plan_cache_t::retire (hb_shape_plan_t *shape_plan)
+{
+  if (unlikely (!retired[1].alloc (retired[1].length + 1)))
+  {
+    epoch.synchronize ();
+    hb_shape_plan_destroy (shape_plan);
+    return;
+  }
+  retired[1].push (shape_plan);
+  reclaim ();
+}
+
+/* Drops the plans that no lookup can still be reading, and moves the
+ * others on to a new epoch.  While more than an eighth of max_plans are
+ * left, waits for the lookups in flight.  Must be called with lock held. */
+void
+hb_shape_plan_cache_t::reclaim ()
+{
+  unsigned int max_retired = hb_max (HB_SHAPE_PLAN_CACHE_WAYS, max_plans / 8);
+  for (;;)
+  {
+    if (epoch.previous_done ())
+    {
+      for (hb_shape_plan_t *shape_plan : retired[0])
+	hb_shape_plan_destroy (shape_plan);
+      retired[0].resize (0);
+      hb_swap (retired[0], retired[1]);
+      if (!retired[0].length)
+	return;
+      epoch.advance ();
+      continue;
+    }
+    if (retired[0].length + retired[1].length <= max_retired)
+      return;
+  }
+}
+
+static hb_shape_plan_cache_t *
+_hb_face_get_shape_plan_cache (hb_face_t *face)
+{
+retry:
+  hb_shape_plan_cache_t *cache = face->shape_plans;
+  if (likely (cache))
+    return cache;
+
+  cache = (hb_shape_plan_cache_t *) hb_calloc (1, sizeof (hb_shape_plan_cache_t));
+  if (unlikely (!cache))
+    return nullptr;
+  new (cache) hb_shape_plan_cache_t ();
+
+  if (unlikely (!face->shape_plans.cmpexch (nullptr, cache)))
+  {
+    cache->~hb_shape_plan_cache_t ();
+    hb_free (cache);
+    goto retry;
+  }
+  return cache;
+}
+
 /**
  * hb_shape_plan_create_cached:
  * @face: #hb_face_t to use
@@ -525,12 +762,9 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 		  num_user_features,
 		  shaper_list);
 
-retry:
-  hb_face_t::plan_node_t *cached_plan_nodes = face->shape_plans;
-
-  bool dont_cache = !hb_object_is_valid (face);
+  hb_shape_plan_cache_t *cache = hb_object_is_valid (face) ? _hb_face_get_shape_plan_cache (face) : nullptr;
 
-  if (likely (!dont_cache))
+  if (likely (cache))
   {
     hb_shape_plan_key_t key;
     if (!key.init (false,
@@ -543,12 +777,11 @@ retry:
 		   shaper_list))
       return hb_shape_plan_get_empty ();
 
-    for (hb_face_t::plan_node_t *node = cached_plan_nodes; node; node = node->next)
-      if (node->shape_plan->key.equal (&key))
-      {
-	DEBUG_MSG_FUNC (SHAPE_PLAN, node->shape_plan, "fulfilled from cache");
-	return hb_shape_plan_reference (node->shape_plan);
-      }
+    if (hb_shape_plan_t *shape_plan = cache->lookup (&key))
+    {
+      DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "fulfilled from cache");
+      return shape_plan;
+    }
   }
 
   hb_shape_plan_t *shape_plan = hb_shape_plan_create2 (face, props,
@@ -556,25 +789,69 @@ retry:
 						       coords, num_coords,
 						       shaper_list);
 
-  if (unlikely (dont_cache))
+  if (unlikely (!cache || !hb_object_is_valid (shape_plan)))
     return shape_plan;
 
-  hb_face_t::plan_node_t *node = (hb_face_t::plan_node_t *) hb_calloc (1, sizeof (hb_face_t::plan_node_t));
-  if (unlikely (!node))
-    return shape_plan;
+  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
+  return cache->insert (shape_plan);
+}
 
-  node->shape_plan = shape_plan;
-  node->next = cached_plan_nodes;
 
-  if (unlikely (!face->shape_plans.cmpexch (cached_plan_nodes, node)))
-  {
-    hb_shape_plan_destroy (shape_plan);
-    hb_free (node);
-    goto retry;
-  }
-  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
+/**
+ * hb_face_set_shape_plan_cache_capacity:
+ * @face: #hb_face_t to work upon
+ * @capacity: The maximum number of shape plans to keep
+ *
+ * Sets the maximum number of shape plans kept in the cache of @face
+ * used by hb_shape_plan_create_cached2() and hence hb_shape().  Plans
+ * are kept in sets of four by key hash; when the set of a new plan is
+ * full, one that was not used recently is dropped.  Setting zero
+ * disables caching.
+ *
+ * Looking plans up in the cache does not take locks.  Changing the
+ * capacity waits for the lookups other threads have in flight.
+ *
+ * Unlike most face properties, this can be changed after the face has
+ * been made immutable.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_face_set_shape_plan_cache_capacity (hb_face_t    *face,
+				       unsigned int  capacity)
+{
+  if (unlikely (!hb_object_is_valid (face)))
+    return;
+
+  hb_shape_plan_cache_t *cache = _hb_face_get_shape_plan_cache (face);
+  if (unlikely (!cache))
+    return;
+
+  cache->set_max_plans (capacity);
+}
 
-  return hb_shape_plan_reference (shape_plan);
+/**
+ * hb_face_get_shape_plan_cache_stats:
+ * @face: #hb_face_t to work upon
+ * @hits: (out) (optional): Number of plans served from the cache
+ * @misses: (out) (optional): Number of plans not found in the cache
+ * @evictions: (out) (optional): Number of plans dropped to stay within
+ *   the capacity
+ *
+ * Fetches usage statistics of the shape-plan cache of @face.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_face_get_shape_plan_cache_stats (const hb_face_t *face,
+				    unsigned int    *hits,      /* OUT */
+				    unsigned int    *misses,    /* OUT */
+				    unsigned int    *evictions  /* OUT */)
+{
+  const hb_shape_plan_cache_t *cache = face->shape_plans;
+  if (hits) *hits = cache ? cache->hits.get_relaxed () : 0;
+  if (misses) *misses = cache ? cache->misses.get_relaxed () : 0;
+  if (evictions) *evictions = cache ? cache->evictions.get_relaxed () : 0;
 }
 
 
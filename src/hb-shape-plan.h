@@ -117,6 +117,17 @@ HB_EXTERN const char *
 hb_shape_plan_get_shaper (hb_shape_plan_t *shape_plan);
 
 
+HB_EXTERN void
+hb_face_set_shape_plan_cache_capacity (hb_face_t    *face,
+				       unsigned int  capacity);
+
+HB_EXTERN void
+hb_face_get_shape_plan_cache_stats (const hb_face_t *face,
+				    unsigned int    *hits,      /* OUT */
+				    unsigned int    *misses,    /* OUT */
+				    unsigned int    *evictions  /* OUT */);
+
+
 HB_END_DECLS
 
 #endif /* HB_SHAPE_PLAN_H */
@@ -28,6 +28,7 @@
 #define HB_SHAPE_PLAN_HH
 
 #include "hb.hh"
+#include "hb-map.hh"
 #include "hb-shaper.hh"
 #include "hb-ot-shape.hh"
 
@@ -57,9 +58,13 @@ struct hb_shape_plan_key_t
 
   HB_INTERNAL void fini () { hb_free ((void *) user_features); user_features = nullptr; }
 
-  HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other);
+  HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other) const;
 
-  HB_INTERNAL bool equal (const hb_shape_plan_key_t *other);
+  HB_INTERNAL bool equal (const hb_shape_plan_key_t *other) const;
+
+  HB_INTERNAL uint32_t hash () const;
+
+  bool operator == (const hb_shape_plan_key_t &other) const { return equal (&other); }
 };
 
 struct hb_shape_plan_t
@@ -73,5 +78,65 @@ struct hb_shape_plan_t
 #endif
 };
 
+/*
+ * Bounded cache of shape plans, hanging off hb_face_t.  A set-associative
+ * table indexed by key hash.  Lookups do not lock: they enter the epoch,
+ * take a reference on the matching plan and set its referenced bit.
+ * Inserting takes the lock and picks victims with a clock over the
+ * referenced bits.  The cache only drops its references on plans it
+ * replaced once lookups that might have seen them have left.  Callers
+ * own a reference to the plans they get, so eviction never frees a plan
+ * in use.
+ */
+struct hb_shape_plan_cache_t
+{
+  struct slot_t
+  {
+    hb_atomic_ptr_t<hb_shape_plan_t> shape_plan;
+    hb_atomic_int_t referenced; /* Set by lookups; cleared by the clock. */
+  };
+
+  struct table_t
+  {
+    /* Key hashes keep pointer alignment in their low bits; spread them
+     * by the high bits of a multiplicative hash. */
+    slot_t *get_set (uint32_t hash)
+    { return slots + (unsigned) (((uint64_t) (uint32_t) (hash * 2654435761u) * num_sets) >> 32) * ways; }
+
+    unsigned int ways;
+    unsigned int num_sets;
+    slot_t slots[HB_VAR_ARRAY];
+  };
+
+  hb_shape_plan_cache_t () : max_plans (HB_SHAPE_PLAN_CACHE_MAX_PLANS) {}
+  ~hb_shape_plan_cache_t () { clear (); }
+
+  /* Returns a new reference, or nullptr. */
+  HB_INTERNAL hb_shape_plan_t *lookup (const hb_shape_plan_key_t *key);
+  /* Takes ownership of shape_plan; returns a new reference to the
+   * cached plan, which might be an equal one that got there first. */
+  HB_INTERNAL hb_shape_plan_t *insert (hb_shape_plan_t *shape_plan);
+  HB_INTERNAL void set_max_plans (unsigned int max_plans);
+  HB_INTERNAL void clear ();
+
+  private:
+  static table_t *create_table (unsigned int max_plans);
+  void retire (hb_shape_plan_t *shape_plan);
+  void reclaim ();
+
+  public:
+  hb_mutex_t lock;
+  hb_epoch_t epoch;
+  hb_atomic_ptr_t<table_t> table; /* Created on first insert. */
+  unsigned int max_plans;
+  unsigned int hand = 0;
+  /* Plans replaced before, and since, the current epoch started. */
+  hb_vector_t<hb_shape_plan_t *> retired[2];
+
+  hb_atomic_int_t hits;
+  hb_atomic_int_t misses;
+  hb_atomic_int_t evictions;
+};
+
 
 #endif /* HB_SHAPE_PLAN_HH */
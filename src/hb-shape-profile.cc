@@ -0,0 +1,379 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+
+#include "hb-buffer.hh"
+#include "hb-shape-profile.hh"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+uint64_t
+hb_shape_profile_t::now ()
+{
+#if defined(_WIN32)
+  static LARGE_INTEGER frequency;
+  if (unlikely (!frequency.QuadPart))
+    QueryPerformanceFrequency (&frequency);
+  LARGE_INTEGER count;
+  QueryPerformanceCounter (&count);
+  return (uint64_t) ((double) count.QuadPart * 1e9 / (double) frequency.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
+static unsigned int
+_hb_shape_profile_table_index (hb_tag_t table_tag)
+{
+  switch (table_tag)
+  {
+    case HB_TAG ('G','S','U','B'): return 0;
+    case HB_TAG ('G','P','O','S'): return 1;
+    default:                       return (unsigned) -1;
+  }
+}
+
+
+/**
+ * hb_shape_profile_create:
+ *
+ * Creates a new, empty, shaping profile.  Attach it to buffers with
+ * hb_buffer_set_shape_profile() to have shaping calls on them record
+ * their timings and counters into it.
+ *
+ * Profiles accumulate over all shaping calls until reset with
+ * hb_shape_profile_reset().  Like buffers, a profile must not be
+ * used from several threads at once.
+ *
+ * Return value: (transfer full): The new shaping profile
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_profile_t *
+hb_shape_profile_create ()
+{
+  hb_shape_profile_t *profile;
+
+  if (!(profile = hb_object_create<hb_shape_profile_t> ()))
+    return hb_shape_profile_get_empty ();
+
+  return profile;
+}
+
+/**
+ * hb_shape_profile_get_empty:
+ *
+ * Fetches the singleton empty shaping profile.  Attaching it to a
+ * buffer is the same as attaching none.
+ *
+ * Return value: (transfer full): The empty shaping profile
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_profile_t *
+hb_shape_profile_get_empty ()
+{
+  return const_cast<hb_shape_profile_t *> (&Null (hb_shape_profile_t));
+}
+
+/**
+ * hb_shape_profile_reference: (skip)
+ * @profile: A shaping profile
+ *
+ * Increases the reference count on a shaping profile.
+ *
+ * Return value: (transfer full): The shaping profile
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_profile_t *
+hb_shape_profile_reference (hb_shape_profile_t *profile)
+{
+  return hb_object_reference (profile);
+}
+
+/**
+ * hb_shape_profile_destroy: (skip)
+ * @profile: A shaping profile
+ *
+ * Decreases the reference count on a shaping profile. When the
+ * reference count reaches zero, the profile is destroyed,
+ * freeing all memory.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_profile_destroy (hb_shape_profile_t *profile)
+{
+  if (!hb_object_destroy (profile)) return;
+
+  hb_free (profile);
+}
+
+/**
+ * hb_shape_profile_set_user_data: (skip)
+ * @profile: A shaping profile
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified shaping profile.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_profile_set_user_data (hb_shape_profile_t *profile,
+				hb_user_data_key_t *key,
+				void *              data,
+				hb_destroy_func_t   destroy,
+				hb_bool_t           replace)
+{
+  return hb_object_set_user_data (profile, key, data, destroy, replace);
+}
+
+/**
+ * hb_shape_profile_get_user_data: (skip)
+ * @profile: A shaping profile
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified shaping profile.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * XSince: REPLACEME
+ **/
+void *
+hb_shape_profile_get_user_data (const hb_shape_profile_t *profile,
+				hb_user_data_key_t       *key)
+{
+  return hb_object_get_user_data (profile, key);
+}
+
+/**
+ * hb_shape_profile_reset:
+ * @profile: A shaping profile
+ *
+ * Clears all timings and counters collected in @profile.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_shape_profile_reset (hb_shape_profile_t *profile)
+{
+  if (hb_object_is_immutable (profile))
+    return;
+
+  profile->reset ();
+}
+
+/**
+ * hb_shape_profile_get_stage_time:
+ * @profile: A shaping profile
+ * @stage: The stage to query
+ *
+ * Fetches the time spent in @stage of shaping, summed over all shaping
+ * calls recorded in @profile.
+ *
+ * Return value: The time, in seconds
+ *
+ * XSince: REPLACEME
+ **/
+double
+hb_shape_profile_get_stage_time (const hb_shape_profile_t *profile,
+				 hb_shape_profile_stage_t  stage)
+{
+  if (unlikely ((unsigned) stage >= HB_SHAPE_PROFILE_NUM_STAGES))
+    return 0.;
+  return profile->stage_times[stage] / 1e9;
+}
+
+/**
+ * hb_shape_profile_get_layout_stage_times:
+ * @profile: A shaping profile
+ * @table_tag: #HB_OT_TAG_GSUB or #HB_OT_TAG_GPOS
+ * @start_offset: offset of the first stage to retrieve
+ * @stage_count: (inout) (optional): Input = the maximum number of
+ *   stages to return; Output = the actual number of stages returned
+ *   (may be zero)
+ * @times: (out) (array length=stage_count): The times spent in each
+ *   stage, in seconds
+ *
+ * Fetches the times spent in the stages of applying @table_tag, as
+ * the shape plan splits lookups into stages at the pauses of the
+ * shaper, summed over all shaping calls recorded in @profile.  The
+ * time of a pause is included in the stage it ends.
+ *
+ * Stage numbers are those of the shape plans used; profiling shaping
+ * calls with different plans in one profile sums unrelated stages.
+ *
+ * Return value: Total number of stages recorded
+ *
+ * XSince: REPLACEME
+ **/
+unsigned int
+hb_shape_profile_get_layout_stage_times (const hb_shape_profile_t *profile,
+					 hb_tag_t                  table_tag,
+					 unsigned int              start_offset,
+					 unsigned int             *stage_count /* IN/OUT */,
+					 double                   *times       /* OUT */)
+{
+  unsigned int table_index = _hb_shape_profile_table_index (table_tag);
+  if (unlikely (table_index == (unsigned) -1))
+  {
+    if (stage_count)
+      *stage_count = 0;
+    return 0;
+  }
+
+  const auto &stage_times = profile->layout_stage_times[table_index];
+  if (stage_count)
+  {
+    + stage_times.as_array ().sub_array (start_offset, stage_count)
+    | hb_map ([] (uint64_t t) { return t / 1e9; })
+    | hb_sink (hb_array (times, *stage_count))
+    ;
+  }
+  return stage_times.length;
+}
+
+/**
+ * hb_shape_profile_get_lookups:
+ * @profile: A shaping profile
+ * @table_tag: #HB_OT_TAG_GSUB or #HB_OT_TAG_GPOS
+ * @start_offset: offset of the first lookup to retrieve
+ * @lookup_count: (inout) (optional): Input = the maximum number of
+ *   lookups to return; Output = the actual number of lookups returned
+ *   (may be zero)
+ * @lookups: (out) (array length=lookup_count): The counters of each
+ *   lookup
+ *
+ * Fetches the counters of the lookups in @table_tag that were run
+ * at least once in the shaping calls recorded in @profile, in lookup
+ * index order.  Lookups only applied from within other lookups are
+ * not counted separately.
+ *
+ * Return value: Total number of lookups recorded
+ *
+ * XSince: REPLACEME
+ **/
+unsigned int
+hb_shape_profile_get_lookups (const hb_shape_profile_t  *profile,
+			      hb_tag_t                   table_tag,
+			      unsigned int               start_offset,
+			      unsigned int              *lookup_count /* IN/OUT */,
+			      hb_shape_profile_lookup_t *lookups      /* OUT */)
+{
+  unsigned int table_index = _hb_shape_profile_table_index (table_tag);
+  if (unlikely (table_index == (unsigned) -1))
+  {
+    if (lookup_count)
+      *lookup_count = 0;
+    return 0;
+  }
+
+  unsigned int total = 0, count = 0;
+  unsigned int max_count = lookup_count ? *lookup_count : 0;
+  const auto &stats = profile->lookups[table_index];
+  for (unsigned int i = 0; i < stats.length; i++)
+  {
+    const auto &s = stats.arrayZ[i];
+    if (!s.invocations)
+      continue;
+    if (total++ < start_offset || count >= max_count)
+      continue;
+
+    hb_shape_profile_lookup_t &out = lookups[count++];
+    out.lookup_index = i;
+    out.invocations = s.invocations;
+    out.glyphs_visited = s.glyphs_visited;
+    out.digest_rejections = s.digest_rejections;
+    out.applications = s.applications;
+    out.time = s.time / 1e9;
+  }
+  if (lookup_count)
+    *lookup_count = count;
+  return total;
+}
+
+/**
+ * hb_buffer_set_shape_profile:
+ * @buffer: An #hb_buffer_t
+ * @profile: (nullable): The shaping profile to record into, or `NULL`
+ *
+ * Attaches a shaping profile to @buffer, to record timings and
+ * counters of all subsequent shaping calls on @buffer into.  The
+ * profile is kept across hb_buffer_reset().  Profiling is off while
+ * no profile is attached, and adds little overhead when on.
+ *
+ * While a profile is attached, hb_shape_cache_shape() does not use its
+ * cache for @buffer: it shapes @buffer afresh every time, so that all
+ * calls are recorded.
+ *
+ * XSince: REPLACEME
+ **/
+void
+hb_buffer_set_shape_profile (hb_buffer_t        *buffer,
+			     hb_shape_profile_t *profile)
+{
+  if (hb_object_is_immutable (buffer))
+    return;
+
+  if (profile && profile->header.is_inert ())
+    profile = nullptr;
+
+  hb_shape_profile_reference (profile);
+  hb_shape_profile_destroy (buffer->profile);
+  buffer->profile = profile;
+}
+
+/**
+ * hb_buffer_get_shape_profile:
+ * @buffer: An #hb_buffer_t
+ *
+ * Fetches the shaping profile attached to @buffer.
+ *
+ * Return value: (transfer none) (nullable): The shaping profile, or
+ *   `NULL` if none is attached
+ *
+ * XSince: REPLACEME
+ **/
+hb_shape_profile_t *
+hb_buffer_get_shape_profile (const hb_buffer_t *buffer)
+{
+  return buffer->profile;
+}
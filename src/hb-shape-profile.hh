@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_SHAPE_PROFILE_HH
+#define HB_SHAPE_PROFILE_HH
+
+#include "hb.hh"
+#include "hb-object.hh"
+#include "hb-vector.hh"
+
+
+#define HB_SHAPE_PROFILE_NUM_STAGES (HB_SHAPE_PROFILE_STAGE_FINISH + 1)
+
+/*
+ * hb_shape_profile_t
+ *
+ * Accumulates timings and counters over all shaping calls on the buffers
+ * it is attached to.  Times are kept in nanoseconds and only converted
+ * when queried.  Like buffers, not to be used from several threads at
+ * once.
+ */
+
+struct hb_shape_profile_t
+{
+  struct lookup_t
+  {
+    unsigned int invocations;
+    unsigned int glyphs_visited;
+    unsigned int digest_rejections;
+    unsigned int applications;
+    uint64_t time;
+  };
+
+  hb_object_header_t header;
+
+  uint64_t stage_times[HB_SHAPE_PROFILE_NUM_STAGES];
+  hb_vector_t<uint64_t> layout_stage_times[2]; /* GSUB, GPOS */
+  hb_vector_t<lookup_t> lookups[2];
+  uint64_t lap_start;
+
+  HB_INTERNAL static uint64_t now ();
+
+  void start () { lap_start = now (); }
+  /* Charges the time since the previous lap, or start(), to stage. */
+  void lap (hb_shape_profile_stage_t stage)
+  {
+    uint64_t t = now ();
+    stage_times[stage] += t - lap_start;
+    lap_start = t;
+  }
+
+  void add_layout_stage_time (unsigned int table_index,
+			      unsigned int stage_index,
+			      uint64_t time)
+  {
+    auto &times = layout_stage_times[table_index];
+    if (stage_index >= times.length && unlikely (!times.resize (stage_index + 1)))
+      return;
+    times.arrayZ[stage_index] += time;
+  }
+
+  lookup_t *get_lookup (unsigned int table_index, unsigned int lookup_index)
+  {
+    auto &v = lookups[table_index];
+    if (lookup_index >= v.length && unlikely (!v.resize (lookup_index + 1)))
+      return nullptr;
+    return &v.arrayZ[lookup_index];
+  }
+
+  void reset ()
+  {
+    hb_memset (stage_times, 0, sizeof (stage_times));
+    for (unsigned int i = 0; i < 2; i++)
+    {
+      layout_stage_times[i].resize (0);
+      lookups[i].resize (0);
+    }
+  }
+};
+
+
+#endif /* HB_SHAPE_PROFILE_HH */
@@ -103,6 +103,46 @@ hb_shape_list_shapers ()
 }
 
 
+static hb_bool_t
+hb_shape_full_with_plan (hb_shape_plan_t    *shape_plan,
+			 hb_font_t          *font,
+			 hb_buffer_t        *buffer,
+			 const hb_feature_t *features,
+			 unsigned int        num_features,
+			 const char * const *shaper_list)
+{
+  buffer->enter ();
+
+  hb_buffer_t *text_buffer = nullptr;
+  if (buffer->flags & HB_BUFFER_FLAG_VERIFY)
+  {
+    text_buffer = hb_buffer_create ();
+    hb_buffer_append (text_buffer, buffer, 0, -1);
+  }
+
+  hb_bool_t res = hb_shape_plan_execute (shape_plan, font, buffer, features, num_features);
+
+  if (buffer->max_ops <= 0)
+    buffer->shaping_failed = true;
+
+  if (text_buffer)
+  {
+    if (res && buffer->successful && !buffer->shaping_failed
+	    && text_buffer->successful
+	    && !buffer->verify (text_buffer,
+				font,
+				features,
+				num_features,
+				shaper_list))
+      res = false;
+    hb_buffer_destroy (text_buffer);
+  }
+
+  buffer->leave ();
+
+  return res;
+}
+
 /**
  * hb_shape_full:
  * @font: an #hb_font_t to use for shaping
@@ -131,43 +171,81 @@ hb_shape_full (hb_font_t          *font,
   if (unlikely (!buffer->len))
     return true;
 
-  buffer->enter ();
-
-  hb_buffer_t *text_buffer = nullptr;
-  if (buffer->flags & HB_BUFFER_FLAG_VERIFY)
-  {
-    text_buffer = hb_buffer_create ();
-    hb_buffer_append (text_buffer, buffer, 0, -1);
-  }
-
   hb_shape_plan_t *shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
 							      features, num_features,
 							      font->coords, font->num_coords,
 							      shaper_list);
 
-  hb_bool_t res = hb_shape_plan_execute (shape_plan, font, buffer, features, num_features);
-
-  if (buffer->max_ops <= 0)
-    buffer->shaping_failed = true;
+  hb_bool_t res = hb_shape_full_with_plan (shape_plan, font, buffer,
+					   features, num_features,
+					   shaper_list);
 
   hb_shape_plan_destroy (shape_plan);
 
-  if (text_buffer)
+  return res;
+}
+
+/**
+ * hb_shape_batch:
+ * @font: an #hb_font_t to use for shaping
+ * @buffers: (array length=num_buffers): an array of #hb_buffer_t to shape
+ * @num_buffers: the length of @buffers array
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Shapes each of @buffers as if hb_shape_full() was called on it with
+ * the same @font, @features, and @shaper_list.
+ *
+ * This is faster than shaping the buffers one by one when many short
+ * buffers share the same segment properties: the shaping plan is looked
+ * up once for every run of consecutive buffers with equal segment
+ * properties, instead of once per buffer.  Buffers do not need to share
+ * segment properties though; a new plan is looked up whenever they change.
+ *
+ * Return value: false if all shapers failed for any of the buffers,
+ * true otherwise
+ *
+ * XSince: REPLACEME
+ **/
+hb_bool_t
+hb_shape_batch (hb_font_t          *font,
+		hb_buffer_t       **buffers,
+		unsigned int        num_buffers,
+		const hb_feature_t *features,
+		unsigned int        num_features,
+		const char * const *shaper_list)
+{
+  hb_bool_t ret = true;
+  hb_shape_plan_t *shape_plan = nullptr;
+
+  for (unsigned int i = 0; i < num_buffers; i++)
   {
-    if (res && buffer->successful && !buffer->shaping_failed
-	    && text_buffer->successful
-	    && !buffer->verify (text_buffer,
-				font,
-				features,
-				num_features,
-				shaper_list))
-      res = false;
-    hb_buffer_destroy (text_buffer);
+    hb_buffer_t *buffer = buffers[i];
+    if (unlikely (!buffer->len))
+      continue;
+
+    if (!shape_plan ||
+	!hb_segment_properties_equal (&shape_plan->key.props, &buffer->props))
+    {
+      hb_shape_plan_destroy (shape_plan);
+      shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
+						 features, num_features,
+						 font->coords, font->num_coords,
+						 shaper_list);
+    }
+
+    if (!hb_shape_full_with_plan (shape_plan, font, buffer,
+				  features, num_features,
+				  shaper_list))
+      ret = false;
   }
 
-  buffer->leave ();
+  hb_shape_plan_destroy (shape_plan);
 
-  return res;
+  return ret;
 }
 
 /**
@@ -53,6 +53,256 @@ hb_shape_full (hb_font_t          *font,
 	       unsigned int        num_features,
 	       const char * const *shaper_list);
 
+HB_EXTERN hb_bool_t
+hb_shape_batch (hb_font_t          *font,
+		hb_buffer_t       **buffers,
+		unsigned int        num_buffers,
+		const hb_feature_t *features,
+		unsigned int        num_features,
+		const char * const *shaper_list);
+
+/**
+ * hb_shape_cache_t:
+ *
+ * Data type for holding a cache of shaping results.
+ *
+ * XSince: REPLACEME
+ **/
+typedef struct hb_shape_cache_t hb_shape_cache_t;
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_create (unsigned int max_entries);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_get_empty (void);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache);
+
+HB_EXTERN void
+hb_shape_cache_destroy (hb_shape_cache_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_shape_cache_get_user_data (const hb_shape_cache_t *cache,
+			      hb_user_data_key_t     *key);
+
+HB_EXTERN void
+hb_shape_cache_clear (hb_shape_cache_t *cache);
+
+HB_EXTERN void
+hb_shape_cache_get_stats (const hb_shape_cache_t *cache,
+			  unsigned int           *hits,      /* OUT */
+			  unsigned int           *misses,    /* OUT */
+			  unsigned int           *evictions  /* OUT */);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_shape (hb_shape_cache_t   *cache,
+		      hb_font_t          *font,
+		      hb_buffer_t        *buffer,
+		      const hb_feature_t *features,
+		      unsigned int        num_features,
+		      const char * const *shaper_list);
+
+/**
+ * hb_shape_profile_t:
+ *
+ * Data type for collecting timings and counters of shaping calls.
+ *
+ * XSince: REPLACEME
+ **/
+typedef struct hb_shape_profile_t hb_shape_profile_t;
+
+/**
+ * hb_shape_profile_stage_t:
+ * @HB_SHAPE_PROFILE_STAGE_PREPARE: Setting up Unicode properties,
+ *   clusters and direction, and shaper-specific preprocessing.
+ * @HB_SHAPE_PROFILE_STAGE_NORMALIZE: Unicode normalization and mapping
+ *   characters to glyphs.
+ * @HB_SHAPE_PROFILE_STAGE_SETUP_MASKS: Setting up feature masks.
+ * @HB_SHAPE_PROFILE_STAGE_SUBSTITUTE: Glyph substitution, as GSUB or
+ *   morx.
+ * @HB_SHAPE_PROFILE_STAGE_POSITION: Glyph advances and positioning, as
+ *   GPOS, kerx or kern.
+ * @HB_SHAPE_PROFILE_STAGE_FALLBACK_POSITION: Fallback mark positioning,
+ *   for fonts without GPOS mark attachment.
+ * @HB_SHAPE_PROFILE_STAGE_FINISH: Hiding default ignorables,
+ *   shaper-specific postprocessing and glyph flags.
+ *
+ * The stages of shaping that an #hb_shape_profile_t times.  Only the
+ * OpenType shaper reports stage times.
+ *
+ * XSince: REPLACEME
+ **/
+typedef enum {
+  HB_SHAPE_PROFILE_STAGE_PREPARE,
+  HB_SHAPE_PROFILE_STAGE_NORMALIZE,
+  HB_SHAPE_PROFILE_STAGE_SETUP_MASKS,
+  HB_SHAPE_PROFILE_STAGE_SUBSTITUTE,
+  HB_SHAPE_PROFILE_STAGE_POSITION,
+  HB_SHAPE_PROFILE_STAGE_FALLBACK_POSITION,
+  HB_SHAPE_PROFILE_STAGE_FINISH,
+
+  /*< private >*/
+  _HB_SHAPE_PROFILE_STAGE_MAX_VALUE = HB_TAG_MAX_SIGNED /*< skip >*/
+} hb_shape_profile_stage_t;
+
+/**
+ * hb_shape_profile_lookup_t:
+ * @lookup_index: Index of the lookup in the GSUB or GPOS table
+ * @invocations: Number of times the lookup was run over a buffer.
+ *   Runs skipped because no glyph in the buffer could match are not
+ *   counted.
+ * @glyphs_visited: Number of glyphs the lookup was considered at
+ * @digest_rejections: Number of glyphs visited that were rejected by
+ *   the coverage filter of the lookup without trying its subtables
+ * @applications: Number of times the lookup applied
+ * @time: Time spent running the lookup, in seconds
+ *
+ * Counters of one lookup, as collected by an #hb_shape_profile_t.
+ *
+ * XSince: REPLACEME
+ **/
+typedef struct hb_shape_profile_lookup_t {
+  unsigned int lookup_index;
+  unsigned int invocations;
+  unsigned int glyphs_visited;
+  unsigned int digest_rejections;
+  unsigned int applications;
+  double       time;
+} hb_shape_profile_lookup_t;
+
+HB_EXTERN hb_shape_profile_t *
+hb_shape_profile_create (void);
+
+HB_EXTERN hb_shape_profile_t *
+hb_shape_profile_get_empty (void);
+
+HB_EXTERN hb_shape_profile_t *
+hb_shape_profile_reference (hb_shape_profile_t *profile);
+
+HB_EXTERN void
+hb_shape_profile_destroy (hb_shape_profile_t *profile);
+
+HB_EXTERN hb_bool_t
+hb_shape_profile_set_user_data (hb_shape_profile_t *profile,
+				hb_user_data_key_t *key,
+				void *              data,
+				hb_destroy_func_t   destroy,
+				hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_shape_profile_get_user_data (const hb_shape_profile_t *profile,
+				hb_user_data_key_t       *key);
+
+HB_EXTERN void
+hb_shape_profile_reset (hb_shape_profile_t *profile);
+
+HB_EXTERN double
+hb_shape_profile_get_stage_time (const hb_shape_profile_t *profile,
+				 hb_shape_profile_stage_t  stage);
+
+HB_EXTERN unsigned int
+hb_shape_profile_get_layout_stage_times (const hb_shape_profile_t *profile,
+					 hb_tag_t                  table_tag,
+					 unsigned int              start_offset,
+					 unsigned int             *stage_count /* IN/OUT */,
+					 double                   *times       /* OUT */);
+
+HB_EXTERN unsigned int
+hb_shape_profile_get_lookups (const hb_shape_profile_t  *profile,
+			      hb_tag_t                   table_tag,
+			      unsigned int               start_offset,
+			      unsigned int              *lookup_count /* IN/OUT */,
+			      hb_shape_profile_lookup_t *lookups      /* OUT */);
+
+HB_EXTERN void
+hb_buffer_set_shape_profile (hb_buffer_t        *buffer,
+			     hb_shape_profile_t *profile);
+
+HB_EXTERN hb_shape_profile_t *
+hb_buffer_get_shape_profile (const hb_buffer_t *buffer);
+
+/**
+ * hb_shape_task_func_t:
+ * @index: The index of the task to run
+ * @task_data: The data passed to the #hb_shape_run_tasks_func_t
+ *
+ * A shaping task, as handed to a #hb_shape_run_tasks_func_t.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_shape_task_func_t) (unsigned int  index,
+				      void         *task_data);
+
+/**
+ * hb_shape_run_tasks_func_t:
+ * @num_tasks: The number of tasks to run
+ * @task: The function running one task
+ * @task_data: The data to pass to @task
+ * @user_data: User data passed to hb_shape_parallel()
+ *
+ * A callback method for hb_shape_parallel(), that should call @task
+ * with @task_data for each index from zero to @num_tasks - 1, possibly
+ * concurrently, and return once all have finished.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_shape_run_tasks_func_t) (unsigned int          num_tasks,
+					   hb_shape_task_func_t  task,
+					   void                 *task_data,
+					   void                 *user_data);
+
+/**
+ * hb_shape_parallel_flags_t:
+ * @HB_SHAPE_PARALLEL_FLAG_DEFAULT: Only keep pieces apart where
+ *   #HB_GLYPH_FLAG_UNSAFE_TO_CONCAT allows, so the results are the same
+ *   as shaping serially.
+ * @HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD: Keep pieces apart where
+ *   #HB_GLYPH_FLAG_UNSAFE_TO_BREAK allows, looking up to a word, or 32
+ *   characters, past where they meet.  Glyphs and positions differ from
+ *   shaping serially if the font has lookups, or AAT state machines,
+ *   that reach further than that without matching up to where the
+ *   lookahead stops, and glyph flags other than
+ *   #HB_GLYPH_FLAG_UNSAFE_TO_BREAK may differ.
+ *
+ * Flags for hb_shape_parallel().
+ *
+ * XSince: REPLACEME
+ **/
+typedef enum { /*< flags >*/
+  HB_SHAPE_PARALLEL_FLAG_DEFAULT		= 0x00000000u,
+  HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD	= 0x00000001u
+} hb_shape_parallel_flags_t;
+
+HB_EXTERN hb_bool_t
+hb_shape_parallel (hb_font_t                 *font,
+		   hb_buffer_t               *buffer,
+		   const hb_feature_t        *features,
+		   unsigned int               num_features,
+		   const char * const        *shaper_list,
+		   unsigned int               num_segments,
+		   hb_shape_parallel_flags_t  flags,
+		   hb_shape_run_tasks_func_t  run_tasks,
+		   void                      *user_data);
+
+HB_EXTERN hb_bool_t
+hb_buffer_reshape_range (hb_buffer_t        *buffer,
+			 hb_buffer_t        *text,
+			 unsigned int        start,
+			 unsigned int        old_end,
+			 unsigned int        new_end,
+			 hb_font_t          *font,
+			 const hb_feature_t *features,
+			 unsigned int        num_features,
+			 const char * const *shaper_list);
+
 HB_EXTERN hb_bool_t
 hb_shape_justify (hb_font_t          *font,
 		  hb_buffer_t        *buffer,
@@ -119,6 +119,37 @@ struct hb_subset_accelerator_t
   // CFF
   bool has_seac;
 
+  // Layout
+  // Without instancing, the GSUB/GPOS lookup and feature indices only depend
+  // on the script/feature filters, and the glyph closure on those and the
+  // glyphs it starts from; plans created from this face reuse both. Closures
+  // are only reused for the exact same starting glyphs, so only repeated
+  // requests benefit from them; overlapping ones run the closure again.
+  struct layout_closure_t
+  {
+    bool substitute = false;
+    hb_set_t seed;
+    hb_set_t glyphs;
+    hb_set_t lookup_indices;
+  };
+
+  struct layout_cache_t
+  {
+    hb_tag_t table_tag = HB_TAG_NONE;
+    hb_set_t layout_scripts;
+    hb_set_t layout_features;
+    hb_set_t lookup_indices;
+    hb_set_t feature_indices;
+    hb_vector_t<layout_closure_t> closures;
+    unsigned next_closure = 0;
+  };
+
+  static constexpr unsigned MAX_LAYOUT_CACHE_FILTERS = 8;
+  static constexpr unsigned MAX_LAYOUT_CACHE_CLOSURES = 16;
+
+  mutable hb_mutex_t layout_cache_lock;
+  mutable hb_vector_t<layout_cache_t> layout_cache;
+
   // TODO(garretrieger): cumulative glyf checksum map
 
   bool in_error () const
@@ -335,7 +335,10 @@ struct subr_flattener_t
 		    const hb_subset_plan_t *plan_)
 		   : acc (acc_), plan (plan_) {}
 
-  bool flatten (str_buff_vec_t &flat_charstrings)
+  /* If @previous is given, it is the output of the plan this one was
+   * extended from; glyphs it retained are copied from it instead of being
+   * flattened again. */
+  bool flatten (str_buff_vec_t &flat_charstrings, const ACC *previous = nullptr)
   {
     unsigned count = plan->num_output_glyphs ();
     if (!flat_charstrings.resize_exact (count))
@@ -349,6 +352,20 @@ struct subr_flattener_t
 	if (endchar_op != OpCode_Invalid) flat_charstrings[i].push (endchar_op);
 	continue;
       }
+
+      if (previous)
+      {
+	hb_codepoint_t previous_glyph = plan->previous_glyph_map.get (glyph);
+	if (previous_glyph < previous->num_glyphs)
+	{
+	  const hb_ubytes_t str = (*previous->charStrings)[previous_glyph];
+	  if (unlikely (!flat_charstrings.arrayZ[i].resize_exact (str.length, false)))
+	    return false;
+	  hb_memcpy (flat_charstrings.arrayZ[i].arrayZ, str.arrayZ, str.length);
+	  continue;
+	}
+      }
+
       const hb_ubytes_t str = (*acc.charStrings)[glyph];
       unsigned int fd = acc.fdSelect->get_fd (glyph);
       if (unlikely (fd >= acc.fdCount))
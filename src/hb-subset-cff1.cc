@@ -690,7 +690,8 @@ struct cff1_subset_plan
       /* Flatten global & local subrs */
       subr_flattener_t<const OT::cff1::accelerator_subset_t, cff1_cs_interp_env_t, cff1_cs_opset_flatten_t, OpCode_endchar>
 		    flattener(acc, plan);
-      if (!flattener.flatten (subset_charstrings))
+      const OT::cff1::accelerator_subset_t previous (plan->previous_output);
+      if (!flattener.flatten (subset_charstrings, previous.is_valid () ? &previous : nullptr))
 	return false;
     }
     else
@@ -450,7 +450,8 @@ struct cff2_subset_plan
       /* Flatten global & local subrs */
       subr_flattener_t<const OT::cff2::accelerator_subset_t, cff2_cs_interp_env_t<blend_arg_t>, cff2_cs_opset_flatten_t>
 		    flattener(acc, plan);
-      if (!flattener.flatten (subset_charstrings))
+      const OT::cff2::accelerator_subset_t previous (plan->previous_output);
+      if (!flattener.flatten (subset_charstrings, previous.is_valid () ? &previous : nullptr))
 	return false;
     }
     else
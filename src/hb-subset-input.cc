@@ -189,6 +189,50 @@ hb_subset_input_t::hb_subset_input_t ()
   sets.layout_scripts->invert (); // Default to all scripts.
 }
 
+hb_subset_input_t *
+hb_subset_input_t::copy () const
+{
+  hb_subset_input_t *input = hb_object_create<hb_subset_input_t> ();
+  if (unlikely (!input))
+    return nullptr;
+
+  for (unsigned i = 0; i < num_sets (); i++)
+    input->set_ptrs[i]->set (*set_ptrs[i]);
+
+  input->flags = flags;
+  input->attach_accelerator_data = attach_accelerator_data;
+  input->force_long_loca = force_long_loca;
+  input->axes_location = axes_location;
+  input->glyph_map = glyph_map;
+
+#ifdef HB_EXPERIMENTAL_API
+  for (auto _ : name_table_overrides)
+  {
+    hb_bytes_t name_bytes = _.second;
+    if (name_bytes.length)
+    {
+      char *name_str = (char *) hb_malloc (name_bytes.length);
+      if (unlikely (!name_str))
+      {
+	hb_subset_input_destroy (input);
+	return nullptr;
+      }
+      hb_memcpy (name_str, name_bytes.arrayZ, name_bytes.length);
+      name_bytes = hb_bytes_t (name_str, name_bytes.length);
+    }
+    input->name_table_overrides.set (_.first, name_bytes);
+  }
+#endif
+
+  if (unlikely (input->in_error () || input->glyph_map.in_error ()))
+  {
+    hb_subset_input_destroy (input);
+    return nullptr;
+  }
+
+  return input;
+}
+
 /**
  * hb_subset_input_create_or_fail:
  *
@@ -85,6 +85,9 @@ struct hb_subset_input_t
 {
   HB_INTERNAL hb_subset_input_t ();
 
+  /* Returns a new input with the same settings, or nullptr on failure. */
+  HB_INTERNAL hb_subset_input_t *copy () const;
+
   ~hb_subset_input_t ()
   {
     sets.~sets_t ();
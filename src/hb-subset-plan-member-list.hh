@@ -61,6 +61,10 @@ HB_SUBSET_PLAN_MEMBER (hb_set_t, drop_tables)
 // Old -> New glyph id mapping
 HB_SUBSET_PLAN_MEMBER (hb_map_t, glyph_map_gsub)
 
+// For incremental plans: old -> new glyph id mapping of the plan this one
+// was extended from.
+HB_SUBSET_PLAN_MEMBER (hb_map_t, previous_glyph_map)
+
 HB_SUBSET_PLAN_MEMBER (hb_set_t, _glyphset)
 HB_SUBSET_PLAN_MEMBER (hb_set_t, _glyphset_gsub)
 HB_SUBSET_PLAN_MEMBER (hb_set_t, _glyphset_mathed)
@@ -303,6 +303,125 @@ _GSUBGPOS_find_duplicate_features (const OT::GSUBGPOS &g,
   }
 }
 
+/* Returns the accelerator's layout cache entry for the plan's filters, or
+ * nullptr. Must be called with layout_cache_lock held. */
+static hb_subset_accelerator_t::layout_cache_t *
+_find_layout_cache (const hb_subset_accelerator_t *accel,
+                    const hb_subset_plan_t *plan,
+                    hb_tag_t table_tag)
+{
+  for (auto &entry : accel->layout_cache)
+    if (entry.table_tag == table_tag &&
+        entry.layout_scripts.is_equal (plan->layout_scripts) &&
+        entry.layout_features.is_equal (plan->layout_features))
+      return &entry;
+  return nullptr;
+}
+
+static bool
+_get_cached_layout_indices (const hb_subset_accelerator_t *accel,
+                            hb_subset_plan_t *plan,
+                            hb_tag_t table_tag,
+                            hb_set_t *lookup_indices, /* OUT */
+                            hb_set_t *feature_indices /* OUT */)
+{
+  hb_lock_t l (accel->layout_cache_lock);
+  auto *entry = _find_layout_cache (accel, plan, table_tag);
+  if (!entry) return false;
+  *lookup_indices = entry->lookup_indices;
+  *feature_indices = entry->feature_indices;
+  return plan->check_success (!lookup_indices->in_error () && !feature_indices->in_error ());
+}
+
+static void
+_cache_layout_indices (const hb_subset_accelerator_t *accel,
+                       const hb_subset_plan_t *plan,
+                       hb_tag_t table_tag,
+                       const hb_set_t &lookup_indices,
+                       const hb_set_t &feature_indices)
+{
+  hb_lock_t l (accel->layout_cache_lock);
+  if (_find_layout_cache (accel, plan, table_tag) ||
+      accel->layout_cache.length >= hb_subset_accelerator_t::MAX_LAYOUT_CACHE_FILTERS)
+    return;
+
+  hb_subset_accelerator_t::layout_cache_t entry;
+  entry.table_tag = table_tag;
+  entry.layout_scripts = plan->layout_scripts;
+  entry.layout_features = plan->layout_features;
+  entry.lookup_indices = lookup_indices;
+  entry.feature_indices = feature_indices;
+  if (entry.layout_scripts.in_error () || entry.layout_features.in_error () ||
+      entry.lookup_indices.in_error () || entry.feature_indices.in_error ())
+    return;
+  accel->layout_cache.push (std::move (entry));
+}
+
+/*
+ * Looks up the closure of 'glyphs' in the accelerator. On an exact match
+ * replaces 'glyphs' and 'lookup_indices' with the cached results and returns
+ * true.
+ *
+ * Inputs that merely overlap a cached seed are not served from it. The only
+ * sound reuse for those would be a GSUB seed between a cached seed and its
+ * closure, which new codepoints almost never are, and the retained lookups
+ * of GPOS depend on the exact glyph set.
+ */
+static bool
+_get_cached_layout_closure (const hb_subset_accelerator_t *accel,
+                            hb_subset_plan_t *plan,
+                            hb_tag_t table_tag,
+                            bool substitute,
+                            hb_set_t *glyphs, /* IN/OUT */
+                            hb_set_t *lookup_indices /* OUT */)
+{
+  hb_lock_t l (accel->layout_cache_lock);
+  auto *entry = _find_layout_cache (accel, plan, table_tag);
+  if (!entry) return false;
+
+  for (const auto &closure : entry->closures)
+    if (closure.substitute == substitute && closure.seed.is_equal (*glyphs))
+    {
+      *glyphs = closure.glyphs;
+      *lookup_indices = closure.lookup_indices;
+      return plan->check_success (!glyphs->in_error () && !lookup_indices->in_error ());
+    }
+  return false;
+}
+
+static void
+_cache_layout_closure (const hb_subset_accelerator_t *accel,
+                       const hb_subset_plan_t *plan,
+                       hb_tag_t table_tag,
+                       bool substitute,
+                       const hb_set_t &seed,
+                       const hb_set_t &glyphs,
+                       const hb_set_t &lookup_indices)
+{
+  hb_lock_t l (accel->layout_cache_lock);
+  auto *entry = _find_layout_cache (accel, plan, table_tag);
+  if (!entry) return;
+  for (const auto &closure : entry->closures)
+    if (closure.substitute == substitute && closure.seed.is_equal (seed))
+      return;
+
+  hb_subset_accelerator_t::layout_closure_t closure;
+  closure.substitute = substitute;
+  closure.seed = seed;
+  closure.glyphs = glyphs;
+  closure.lookup_indices = lookup_indices;
+  if (closure.seed.in_error () || closure.glyphs.in_error () || closure.lookup_indices.in_error ())
+    return;
+
+  if (entry->closures.length < hb_subset_accelerator_t::MAX_LAYOUT_CACHE_CLOSURES)
+  {
+    entry->closures.push (std::move (closure));
+    return;
+  }
+  entry->closures[entry->next_closure] = std::move (closure);
+  entry->next_closure = (entry->next_closure + 1) % hb_subset_accelerator_t::MAX_LAYOUT_CACHE_CLOSURES;
+}
+
 template <typename T>
 static inline void
 _closure_glyphs_lookups_features (hb_subset_plan_t   *plan,
@@ -318,22 +437,44 @@ _closure_glyphs_lookups_features (hb_subset_plan_t   *plan,
   hb_blob_ptr_t<T> table = plan->source_table<T> ();
   hb_tag_t table_tag = table->tableTag;
   hb_set_t lookup_indices, feature_indices;
-  _collect_layout_indices<T> (plan,
-                              *table,
-                              &lookup_indices,
-                              &feature_indices,
-                              feature_record_cond_idx_map,
-                              feature_substitutes_map,
-                              catch_all_record_feature_idxes,
-                              catch_all_record_idx_feature_map);
-
-  if (table_tag == HB_OT_TAG_GSUB && !(plan->flags & HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE))
-    hb_ot_layout_lookups_substitute_closure (plan->source,
-                                             &lookup_indices,
-					     gids_to_retain);
-  table->closure_lookups (plan->source,
-			  gids_to_retain,
-                          &lookup_indices);
+
+  /* Feature variations and instancing make the results depend on the axes
+   * location; only share them through the accelerator without those. */
+  const hb_subset_accelerator_t *accel =
+      plan->user_axes_location.is_empty () ? plan->accelerator : nullptr;
+  bool substitute_closure = table_tag == HB_OT_TAG_GSUB && !(plan->flags & HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE);
+
+  if (!accel || !_get_cached_layout_indices (accel, plan, table_tag, &lookup_indices, &feature_indices))
+  {
+    _collect_layout_indices<T> (plan,
+                                *table,
+                                &lookup_indices,
+                                &feature_indices,
+                                feature_record_cond_idx_map,
+                                feature_substitutes_map,
+                                catch_all_record_feature_idxes,
+                                catch_all_record_idx_feature_map);
+    if (accel && !plan->in_error ())
+      _cache_layout_indices (accel, plan, table_tag, lookup_indices, feature_indices);
+  }
+
+  hb_set_t seed;
+  if (accel)
+    seed = *gids_to_retain;
+  if (!accel || !_get_cached_layout_closure (accel, plan, table_tag, substitute_closure,
+                                             gids_to_retain, &lookup_indices))
+  {
+    if (substitute_closure)
+      hb_ot_layout_lookups_substitute_closure (plan->source,
+                                               &lookup_indices,
+                                               gids_to_retain);
+    table->closure_lookups (plan->source,
+                            gids_to_retain,
+                            &lookup_indices);
+    if (accel && !seed.in_error () && !plan->in_error ())
+      _cache_layout_closure (accel, plan, table_tag, substitute_closure,
+                             seed, *gids_to_retain, lookup_indices);
+  }
   _remap_indexes (&lookup_indices, lookups);
 
   // prune features
@@ -861,16 +1002,10 @@ _nameid_closure (hb_subset_plan_t* plan,
 
 static void
 _populate_gids_to_retain (hb_subset_plan_t* plan,
-		          hb_set_t* drop_tables)
+		          hb_set_t* drop_tables,
+			  const hb_subset_plan_t *previous)
 {
   OT::glyf_accelerator_t glyf (plan->source);
-#ifndef HB_NO_SUBSET_CFF
-  // Note: we cannot use inprogress_accelerator here, since it has not been
-  // created yet. So in case of preprocessed-face (and otherwise), we do an
-  // extra sanitize pass here, which is not ideal.
-  OT::cff1::accelerator_subset_t stack_cff (plan->accelerator ? nullptr : plan->source);
-  const OT::cff1::accelerator_subset_t *cff (plan->accelerator ? plan->accelerator->cff1_accel.get () : &stack_cff);
-#endif
 
   plan->_glyphset_gsub.add (0); // Not-def
 
@@ -923,23 +1058,42 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
   // XXX TODO VARC closure / subset
 
   _nameid_closure (plan, drop_tables);
+
+  /* When extending a previous plan, its glyphs already have their components
+   * collected; only the new ones need to be visited. */
+  bool incremental = previous && previous->_glyphset_colred.is_subset (cur_glyphset);
+  hb_set_t new_glyphset;
+  if (incremental)
+  {
+    plan->_glyphset.union_ (previous->_glyphset);
+    new_glyphset = cur_glyphset;
+    new_glyphset.subtract (previous->_glyphset_colred);
+  }
+  const hb_set_t &glyphs_to_visit = incremental ? new_glyphset : cur_glyphset;
+
   /* Populate a full set of glyphs to retain by adding all referenced
    * composite glyphs. */
   if (glyf.has_data ())
-    for (hb_codepoint_t gid : cur_glyphset)
+    for (hb_codepoint_t gid : glyphs_to_visit)
       _glyf_add_gid_and_children (glyf, gid, &plan->_glyphset,
 				  cur_glyphset.get_population () * HB_MAX_COMPOSITE_OPERATIONS_PER_GLYPH);
   else
     plan->_glyphset.union_ (cur_glyphset);
 #ifndef HB_NO_SUBSET_CFF
-  if (!plan->accelerator || plan->accelerator->has_seac)
+  plan->has_seac = incremental && previous->has_seac;
+  if ((!plan->accelerator || plan->accelerator->has_seac) &&
+      !glyphs_to_visit.is_empty ())
   {
-    bool has_seac = false;
+    // Note: we cannot use inprogress_accelerator here, since it has not been
+    // created yet. So in case of preprocessed-face (and otherwise), we do an
+    // extra sanitize pass here, which is not ideal.
+    OT::cff1::accelerator_subset_t stack_cff (plan->accelerator ? nullptr : plan->source);
+    const OT::cff1::accelerator_subset_t *cff (plan->accelerator ? plan->accelerator->cff1_accel.get () : &stack_cff);
+
     if (cff->is_valid ())
-      for (hb_codepoint_t gid : cur_glyphset)
+      for (hb_codepoint_t gid : glyphs_to_visit)
 	if (_add_cff_seac_components (*cff, gid, &plan->_glyphset))
-	  has_seac = true;
-    plan->has_seac = has_seac;
+	  plan->has_seac = true;
   }
 #endif
 
@@ -1248,8 +1402,29 @@ _get_instance_glyphs_contour_points (hb_subset_plan_t *plan)
 }
 #endif
 
+/* Takes a reference to the tables of @previous's output which incremental
+ * subsetting reuses, so that they stay valid even if @previous is executed
+ * again. */
+static hb_face_t *
+_snapshot_previous_output (hb_subset_plan_t *previous)
+{
+  hb_face_t *snapshot = hb_face_builder_create ();
+  hb_tag_t tags[] = {OT::cff1::tableTag, OT::cff2::tableTag, HB_OT_TAG_maxp};
+
+  hb_lock_t lock (previous->tables_lock);
+  for (hb_tag_t tag : tags)
+  {
+    hb_blob_t *blob = hb_face_reference_table (previous->dest, tag);
+    if (hb_blob_get_length (blob))
+      hb_face_builder_add_table (snapshot, tag, blob);
+    hb_blob_destroy (blob);
+  }
+  return snapshot;
+}
+
 hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
-				    const hb_subset_input_t *input)
+				    const hb_subset_input_t *input,
+				    hb_subset_plan_t *previous)
 {
   successful = true;
   flags = input->flags;
@@ -1313,7 +1488,7 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
 
   _populate_unicodes_to_retain (input->sets.unicodes, input->sets.glyphs, this);
 
-  _populate_gids_to_retain (this, input->sets.drop_tables);
+  _populate_gids_to_retain (this, input->sets.drop_tables, previous);
   if (unlikely (in_error ()))
     return;
 
@@ -1362,6 +1537,12 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
   if (unlikely (in_error ()))
     return;
 
+  if (previous)
+  {
+    previous_glyph_map = *previous->glyph_map;
+    previous_output = _snapshot_previous_output (previous);
+  }
+
 #ifndef HB_NO_VAR
   _update_instance_metrics_map_from_cff2 (this);
   if (!check_success (_get_instance_glyphs_contour_points (this)))
@@ -1387,6 +1568,8 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
 hb_subset_plan_t::~hb_subset_plan_t()
 {
   hb_face_destroy (dest);
+  hb_face_destroy (previous_output);
+  hb_subset_input_destroy (subset_input);
 
   hb_map_destroy (codepoint_to_glyph);
   hb_map_destroy (glyph_map);
@@ -1430,6 +1613,66 @@ hb_subset_plan_create_or_fail (hb_face_t	 *face,
   if (unlikely (!(plan = hb_object_create<hb_subset_plan_t> (face, input))))
     return nullptr;
 
+  if (unlikely (plan->in_error () ||
+		!(plan->subset_input = input->copy ())))
+  {
+    hb_subset_plan_destroy (plan);
+    return nullptr;
+  }
+
+  return plan;
+}
+
+/**
+ * hb_subset_plan_create_incremental_or_fail:
+ * @previous: a #hb_subset_plan_t to extend.
+ * @unicodes: (nullable): additional codepoints to retain.
+ * @glyphs: (nullable): additional glyph ids to retain.
+ *
+ * Computes a plan for subsetting the face of @previous according to the
+ * input @previous was created from, extended with @unicodes and @glyphs.
+ * The result is the same as that of hb_subset_plan_create_or_fail() with
+ * the extended input, but is faster to compute: the glyph closure only
+ * needs to consider the added glyphs, and if @previous has been executed,
+ * the desubroutinized CFF/CFF2 charstrings of glyphs it retained are
+ * reused from its output instead of being flattened again.
+ *
+ * Only the relevant tables of the output of @previous are referenced, so
+ * @previous may be destroyed once this returns.
+ *
+ * Return value: (transfer full): New subset plan. Destroy with
+ * hb_subset_plan_destroy(). If there is a failure creating the plan
+ * nullptr will be returned.
+ *
+ * XSince: REPLACEME
+ **/
+hb_subset_plan_t *
+hb_subset_plan_create_incremental_or_fail (hb_subset_plan_t *previous,
+					   const hb_set_t   *unicodes,
+					   const hb_set_t   *glyphs)
+{
+  if (unlikely (!previous || !previous->subset_input))
+    return nullptr;
+
+  hb_subset_input_t *input = previous->subset_input->copy ();
+  if (unlikely (!input))
+    return nullptr;
+
+  if (unicodes)
+    input->sets.unicodes->union_ (*unicodes);
+  if (glyphs)
+    input->sets.glyphs->union_ (*glyphs);
+
+  hb_subset_plan_t *plan = nullptr;
+  if (likely (!input->in_error ()))
+    plan = hb_object_create<hb_subset_plan_t> (previous->source, input, previous);
+  if (unlikely (!plan))
+  {
+    hb_subset_input_destroy (input);
+    return nullptr;
+  }
+  plan->subset_input = input;
+
   if (unlikely (plan->in_error ()))
   {
     hb_subset_plan_destroy (plan);
@@ -132,7 +132,8 @@ namespace OT {
 struct hb_subset_plan_t
 {
   HB_INTERNAL hb_subset_plan_t (hb_face_t *,
-				const hb_subset_input_t *input);
+				const hb_subset_input_t *input,
+				hb_subset_plan_t *previous = nullptr);
 
   HB_INTERNAL ~hb_subset_plan_t();
 
@@ -183,6 +184,18 @@ struct hb_subset_plan_t
   const hb_subset_accelerator_t* accelerator;
   hb_subset_accelerator_t* inprogress_accelerator;
 
+  // Copy of the input this plan was created from, so that it can be extended
+  // by hb_subset_plan_create_incremental_or_fail().  nullptr for the plans
+  // hb_subset_or_fail() creates internally, as those are never extended.
+  hb_subset_input_t *subset_input;
+
+  // For incremental plans: the CFF/CFF2 and maxp tables output by the plan
+  // this one was extended from, or nullptr.
+  hb_face_t *previous_output;
+
+  // Guards sanitized_table_cache and dest, for tables subset in parallel.
+  hb_mutex_t tables_lock;
+
  public:
 
   template<typename T>
@@ -190,21 +203,29 @@ struct hb_subset_plan_t
   {
     hb_blob_ptr_t<T> operator () (hb_subset_plan_t *plan)
     {
-      hb_lock_t lock (plan->accelerator ? &plan->accelerator->sanitized_table_cache_lock : nullptr);
-
+      hb_mutex_t *lock = plan->accelerator ? &plan->accelerator->sanitized_table_cache_lock : &plan->tables_lock;
       auto *cache = plan->accelerator ? &plan->accelerator->sanitized_table_cache : &plan->sanitized_table_cache;
-      if (cache
-	  && !cache->in_error ()
-	  && cache->has (+T::tableTag)) {
-	return hb_blob_reference (cache->get (+T::tableTag).get ());
+      {
+	hb_lock_t l (lock);
+	if (cache
+	    && !cache->in_error ()
+	    && cache->has (+T::tableTag)) {
+	  return hb_blob_reference (cache->get (+T::tableTag).get ());
+	}
       }
 
+      /* Sanitize without holding the lock, so that tables being subset in
+       * parallel do not wait on each other. */
       hb::unique_ptr<hb_blob_t> table_blob {hb_sanitize_context_t ().reference_table<T> (plan->source)};
-      hb_blob_t* ret = hb_blob_reference (table_blob.get ());
 
-      if (likely (cache))
-	cache->set (+T::tableTag, std::move (table_blob));
+      hb_lock_t l (lock);
+      if (unlikely (!cache))
+	return hb_blob_reference (table_blob.get ());
+      if (!cache->in_error () && cache->has (+T::tableTag))
+	return hb_blob_reference (cache->get (+T::tableTag).get ());
 
+      hb_blob_t* ret = hb_blob_reference (table_blob.get ());
+      cache->set (+T::tableTag, std::move (table_blob));
       return ret;
     }
   };
@@ -294,6 +315,7 @@ struct hb_subset_plan_t
 		hb_blob_get_length (source_blob));
       hb_blob_destroy (source_blob);
     }
+    hb_lock_t lock (tables_lock);
     return hb_face_builder_add_table (dest, tag, contents);
   }
 };
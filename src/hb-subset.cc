@@ -451,10 +451,11 @@ _passthrough (hb_subset_plan_t *plan, hb_tag_t tag)
   return result;
 }
 
-static bool
-_dependencies_satisfied (hb_subset_plan_t *plan, hb_tag_t tag,
-                         const hb_set_t &subsetted_tags,
-                         const hb_set_t &pending_subset_tags)
+/*
+ * Returns the table that has to be subset before @tag, or 0 if none.
+ */
+static hb_tag_t
+_table_dependency (hb_subset_plan_t *plan, hb_tag_t tag)
 {
   switch (tag)
   {
@@ -462,14 +463,23 @@ _dependencies_satisfied (hb_subset_plan_t *plan, hb_tag_t tag,
   case HB_OT_TAG_vmtx:
   case HB_OT_TAG_maxp:
   case HB_OT_TAG_OS2:
-    return !plan->normalized_coords || !pending_subset_tags.has (HB_OT_TAG_glyf);
+    return plan->normalized_coords ? HB_OT_TAG_glyf : 0;
   case HB_OT_TAG_GPOS:
-    return plan->all_axes_pinned || !pending_subset_tags.has (HB_OT_TAG_GDEF);
+    return plan->all_axes_pinned ? 0 : HB_OT_TAG_GDEF;
   default:
-    return true;
+    return 0;
   }
 }
 
+static bool
+_dependencies_satisfied (hb_subset_plan_t *plan, hb_tag_t tag,
+                         const hb_set_t &subsetted_tags,
+                         const hb_set_t &pending_subset_tags)
+{
+  hb_tag_t dependency = _table_dependency (plan, tag);
+  return !dependency || !pending_subset_tags.has (dependency);
+}
+
 static bool
 _subset_table (hb_subset_plan_t *plan,
 	       hb_vector_t<char> &buf,
@@ -588,6 +598,25 @@ static void _attach_accelerator_data (hb_subset_plan_t* plan,
     hb_subset_accelerator_t::destroy (accel);
 }
 
+static void
+_collect_subset_tags (hb_subset_plan_t *plan, hb_set_t &subset_tags /* OUT */)
+{
+  hb_tag_t table_tags[32];
+  unsigned offset = 0, num_tables = ARRAY_LENGTH (table_tags);
+
+  while (((void) _get_table_tags (plan, offset, &num_tables, table_tags), num_tables))
+  {
+    for (unsigned i = 0; i < num_tables; ++i)
+    {
+      hb_tag_t tag = table_tags[i];
+      if (_should_drop_table (plan, tag)) continue;
+      subset_tags.add (tag);
+    }
+
+    offset += num_tables;
+  }
+}
+
 /**
  * hb_subset_or_fail:
  * @source: font face data to be subset.
@@ -609,7 +638,9 @@ hb_subset_or_fail (hb_face_t *source, const hb_subset_input_t *input)
     return nullptr;
   }
 
-  hb_subset_plan_t *plan = hb_subset_plan_create_or_fail (source, input);
+  /* Not hb_subset_plan_create_or_fail(): this plan is never extended, so
+   * it does not need a copy of input.  Plans in error fail to execute. */
+  hb_subset_plan_t *plan = hb_object_create<hb_subset_plan_t> (source, input);
   if (unlikely (!plan)) {
     return nullptr;
   }
@@ -639,21 +670,8 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
     return nullptr;
   }
 
-  hb_tag_t table_tags[32];
-  unsigned offset = 0, num_tables = ARRAY_LENGTH (table_tags);
-
   hb_set_t subsetted_tags, pending_subset_tags;
-  while (((void) _get_table_tags (plan, offset, &num_tables, table_tags), num_tables))
-  {
-    for (unsigned i = 0; i < num_tables; ++i)
-    {
-      hb_tag_t tag = table_tags[i];
-      if (_should_drop_table (plan, tag)) continue;
-      pending_subset_tags.add (tag);
-    }
-
-    offset += num_tables;
-  }
+  _collect_subset_tags (plan, pending_subset_tags);
 
   bool success = true;
 
@@ -708,3 +726,167 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
 end:
   return success ? hb_face_reference (plan->dest) : nullptr;
 }
+
+
+/*
+ * A chain of tables subset one after another by one task of
+ * hb_subset_plan_execute_parallel_or_fail(): a table and the tables
+ * that depend on it.
+ */
+struct subset_task_t
+{
+  hb_vector_t<hb_tag_t> tags;
+  bool success = false;
+};
+
+struct parallel_subset_t
+{
+  hb_subset_plan_t *plan;
+  hb_vector_t<subset_task_t> tasks;
+
+  static void run_task (unsigned index, void *task_data)
+  {
+    parallel_subset_t *p = (parallel_subset_t *) task_data;
+    subset_task_t &task = p->tasks.arrayZ[index];
+
+    hb_vector_t<char> buf;
+    buf.alloc (8192 - 16);
+
+    task.success = true;
+    for (hb_tag_t tag : task.tags)
+      if (unlikely (!_subset_table (p->plan, buf, tag)))
+      {
+	task.success = false;
+	return;
+      }
+  }
+
+  static int cmp_size_desc (const void *pa, const void *pb)
+  {
+    const auto &a = *(const hb_pair_t<unsigned, hb_tag_t> *) pa;
+    const auto &b = *(const hb_pair_t<unsigned, hb_tag_t> *) pb;
+    if (a.first != b.first) return a.first > b.first ? -1 : +1;
+    return a.second < b.second ? -1 : a.second > b.second ? +1 : 0;
+  }
+
+  /* Groups the tables into tasks that can run concurrently.  Tables that
+   * have to wait for another table are appended to the task of that
+   * table, so they run after it.  Tasks are ordered largest source table
+   * first, so that a pool picking them in order starts the long ones
+   * early. */
+  bool plan_tasks (const hb_set_t &subset_tags)
+  {
+    const hb_set_t subsetted_tags;
+    hb_vector_t<hb_pair_t<unsigned, hb_tag_t>> roots;
+    for (hb_tag_t tag : subset_tags)
+    {
+      if (!_dependencies_satisfied (plan, tag, subsetted_tags, subset_tags))
+	continue;
+      hb_blob_t *blob = hb_face_reference_table (plan->source, tag);
+      roots.push (hb_pair (hb_blob_get_length (blob), tag));
+      hb_blob_destroy (blob);
+    }
+    if (unlikely (roots.in_error () || !tasks.resize (roots.length)))
+      return false;
+    roots.qsort (cmp_size_desc);
+
+    hb_hashmap_t<hb_tag_t, unsigned> task_for_tag;
+    for (unsigned i = 0; i < roots.length; i++)
+    {
+      tasks.arrayZ[i].tags.push (roots.arrayZ[i].second);
+      task_for_tag.set (roots.arrayZ[i].second, i);
+    }
+
+    hb_set_t pending_tags = subset_tags;
+    for (hb_tag_t tag : task_for_tag.keys ())
+      pending_tags.del (tag);
+
+    while (!pending_tags.is_empty ())
+    {
+      if (unlikely (pending_tags.in_error () || task_for_tag.in_error ()))
+	return false;
+
+      bool made_changes = false;
+      for (hb_tag_t tag : pending_tags)
+      {
+	unsigned *task_index;
+	if (!task_for_tag.has (_table_dependency (plan, tag), &task_index))
+	  continue;
+	unsigned i = *task_index;
+	tasks.arrayZ[i].tags.push (tag);
+	task_for_tag.set (tag, i);
+	pending_tags.del (tag);
+	made_changes = true;
+      }
+
+      if (!made_changes)
+      {
+	DEBUG_MSG (SUBSET, nullptr, "Table dependencies unable to be satisfied. Subset failed.");
+	return false;
+      }
+    }
+
+    for (const subset_task_t &task : tasks)
+      if (unlikely (task.tags.in_error ()))
+	return false;
+    return true;
+  }
+};
+
+/**
+ * hb_subset_plan_execute_parallel_or_fail:
+ * @plan: a subsetting plan.
+ * @run_tasks: (scope call) (nullable): a #hb_subset_run_tasks_func_t to
+ *    run the per-table subsetting tasks, or `NULL` to run them one after another
+ * @user_data: data to pass to @run_tasks
+ *
+ * Executes the provided subsetting @plan like hb_subset_plan_execute_or_fail(),
+ * with the tables subset as independent tasks, run by @run_tasks.  Typically
+ * @run_tasks hands the tasks to a thread pool; if it is `NULL` the tasks run one
+ * after another on the calling thread.
+ *
+ * Tables that depend on the result of another table, such as hmtx on glyf
+ * when instancing, run in the same task after it.  The generated font is
+ * identical to the one hb_subset_plan_execute_or_fail() generates.
+ *
+ * Return value:
+ * on success returns a reference to generated font subset. If the subsetting operation fails
+ * returns nullptr.
+ *
+ * XSince: REPLACEME
+ **/
+hb_face_t *
+hb_subset_plan_execute_parallel_or_fail (hb_subset_plan_t           *plan,
+					 hb_subset_run_tasks_func_t  run_tasks,
+					 void                       *user_data)
+{
+  if (unlikely (!plan || plan->in_error ())) {
+    return nullptr;
+  }
+
+  hb_set_t subset_tags;
+  _collect_subset_tags (plan, subset_tags);
+  if (unlikely (subset_tags.in_error ()))
+    return nullptr;
+
+  parallel_subset_t p;
+  p.plan = plan;
+  if (unlikely (!p.plan_tasks (subset_tags)))
+    return nullptr;
+
+  if (run_tasks)
+    run_tasks (p.tasks.length, parallel_subset_t::run_task, &p, user_data);
+  else
+    for (unsigned i = 0; i < p.tasks.length; i++)
+      parallel_subset_t::run_task (i, &p);
+
+  for (const subset_task_t &task : p.tasks)
+    if (unlikely (!task.success))
+      return nullptr;
+
+  if (plan->attach_accelerator_data) {
+    _attach_accelerator_data (plan, plan->dest);
+  }
+
+  return hb_face_reference (plan->dest);
+}
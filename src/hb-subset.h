@@ -223,10 +223,53 @@ hb_subset_or_fail (hb_face_t *source, const hb_subset_input_t *input);
 HB_EXTERN hb_face_t *
 hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan);
 
+/**
+ * hb_subset_task_func_t:
+ * @index: The index of the task to run
+ * @task_data: The data passed to the #hb_subset_run_tasks_func_t
+ *
+ * A subsetting task, as handed to a #hb_subset_run_tasks_func_t.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_subset_task_func_t) (unsigned int  index,
+				       void         *task_data);
+
+/**
+ * hb_subset_run_tasks_func_t:
+ * @num_tasks: The number of tasks to run
+ * @task: The function running one task
+ * @task_data: The data to pass to @task
+ * @user_data: User data passed to hb_subset_plan_execute_parallel_or_fail()
+ *
+ * A callback method for hb_subset_plan_execute_parallel_or_fail(), that
+ * should call @task with @task_data for each index from zero to
+ * @num_tasks - 1, possibly concurrently, and return once all have finished.
+ *
+ * This has the same signature as #hb_shape_run_tasks_func_t, so one
+ * thread pool adapter can serve both.
+ *
+ * XSince: REPLACEME
+ **/
+typedef void (*hb_subset_run_tasks_func_t) (unsigned int           num_tasks,
+					    hb_subset_task_func_t  task,
+					    void                  *task_data,
+					    void                  *user_data);
+
+HB_EXTERN hb_face_t *
+hb_subset_plan_execute_parallel_or_fail (hb_subset_plan_t           *plan,
+					 hb_subset_run_tasks_func_t  run_tasks,
+					 void                       *user_data);
+
 HB_EXTERN hb_subset_plan_t *
 hb_subset_plan_create_or_fail (hb_face_t                 *face,
                                const hb_subset_input_t   *input);
 
+HB_EXTERN hb_subset_plan_t *
+hb_subset_plan_create_incremental_or_fail (hb_subset_plan_t *previous,
+                                           const hb_set_t   *unicodes,
+                                           const hb_set_t   *glyphs);
+
 HB_EXTERN void
 hb_subset_plan_destroy (hb_subset_plan_t *plan);
 
@@ -198,6 +198,7 @@ hb_unicode_funcs_create (hb_unicode_funcs_t *parent)
    * onto it and it's immutable.  We should not copy the destroy notifiers
    * though. */
   ufuncs->user_data = parent->user_data;
+  ufuncs->batch = parent->batch;
 
   return ufuncs;
 }
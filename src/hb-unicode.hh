@@ -60,6 +60,14 @@ extern HB_INTERNAL const uint8_t _hb_modified_combining_class[256];
   HB_UNICODE_FUNC_IMPLEMENT (hb_script_t, script) \
   /* ^--- Add new simple callbacks here */
 
+/* Batch variants are internal array-at-once versions of simple callbacks.
+ * A backend registers one next to the callback it stands in for; if the
+ * callback is later overridden, the per-codepoint callback is used. */
+#define HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_BATCH \
+  HB_UNICODE_FUNC_IMPLEMENT (hb_unicode_general_category_t, general_category, general_categories) \
+  HB_UNICODE_FUNC_IMPLEMENT (hb_codepoint_t, mirroring, mirrorings) \
+  /* ^--- Add new batch callbacks here */
+
 struct hb_unicode_funcs_t
 {
   hb_object_header_t header;
@@ -69,6 +77,26 @@ struct hb_unicode_funcs_t
 #define HB_UNICODE_FUNC_IMPLEMENT(return_type, name) \
   return_type name (hb_codepoint_t unicode) { return func.name (this, unicode, user_data.name); }
 HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_SIMPLE
+#undef HB_UNICODE_FUNC_IMPLEMENT
+
+#define HB_UNICODE_FUNC_IMPLEMENT(return_type, name, names) \
+  void names (unsigned int count, \
+	      const hb_codepoint_t *first_unicode, \
+	      unsigned int unicode_stride, \
+	      return_type *first_out) \
+  { \
+    if (batch.names && batch.name == func.name) \
+    { \
+      batch.names (count, first_unicode, unicode_stride, first_out); \
+      return; \
+    } \
+    for (unsigned int i = 0; i < count; i++) \
+    { \
+      first_out[i] = name (*first_unicode); \
+      first_unicode = (const hb_codepoint_t *) ((const char *) first_unicode + unicode_stride); \
+    } \
+  }
+HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_BATCH
 #undef HB_UNICODE_FUNC_IMPLEMENT
 
   hb_bool_t compose (hb_codepoint_t a, hb_codepoint_t b,
@@ -258,6 +286,14 @@ HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_SIMPLE
     HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS
 #undef HB_UNICODE_FUNC_IMPLEMENT
   } destroy;
+
+  struct {
+#define HB_UNICODE_FUNC_IMPLEMENT(return_type, name, names) \
+    hb_unicode_##name##_func_t name; \
+    void (*names) (unsigned int, const hb_codepoint_t *, unsigned int, return_type *);
+    HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_BATCH
+#undef HB_UNICODE_FUNC_IMPLEMENT
+  } batch;
 };
 DECLARE_NULL_INSTANCE (hb_unicode_funcs_t);
 
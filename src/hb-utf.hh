@@ -123,6 +123,29 @@ struct hb_utf8_t
     return end - 1;
   }
 
+  /* Returns the length of the prefix of text made of code units that
+   * each encode the character of the same value, ie. ASCII.  Returns 0
+   * for prefixes shorter than four bytes, like the single spaces between
+   * words of non-Latin text, without scanning further. */
+  static unsigned int
+  direct_len (const codepoint_t *text,
+	      const codepoint_t *end)
+  {
+    const codepoint_t *p = text;
+    if (end - p < 4 || ((p[0] | p[1] | p[2] | p[3]) & 0x80u))
+      return 0;
+    for (; end - p >= 8; p += 8)
+    {
+      uint64_t v;
+      hb_memcpy (&v, p, 8);
+      if (v & 0x8080808080808080ull)
+	break;
+    }
+    while (p < end && *p < 0x80u)
+      p++;
+    return p - text;
+  }
+
   static unsigned int
   strlen (const codepoint_t *text)
   { return ::strlen ((const char *) text); }
@@ -249,6 +272,28 @@ struct hb_utf16_xe_t
     return text;
   }
 
+  /* Returns the length of the prefix of text without surrogates. */
+  static unsigned int
+  direct_len (const codepoint_t *text,
+	      const codepoint_t *end)
+  {
+    const codepoint_t *p = text;
+    if (hb_is_same (TCodepoint, uint16_t))
+      for (; end - p >= 4; p += 4)
+      {
+	/* Four units at a time; a lane is a surrogate iff it is zero
+	 * after masking and flipping the surrogate bits. */
+	uint64_t v;
+	hb_memcpy (&v, p, 8);
+	v = (v & 0xF800F800F800F800ull) ^ 0xD800D800D800D800ull;
+	if ((v - 0x0001000100010001ull) & ~v & 0x8000800080008000ull)
+	  break;
+      }
+    while (p < end && !hb_in_range<hb_codepoint_t> (*p, 0xD800u, 0xDFFFu))
+      p++;
+    return p - text;
+  }
+
 
   static unsigned int
   strlen (const codepoint_t *text)
@@ -318,6 +363,19 @@ struct hb_utf32_xe_t
     return text;
   }
 
+  /* Returns the length of the prefix of text with valid characters only. */
+  static unsigned int
+  direct_len (const TCodepoint *text,
+	      const TCodepoint *end)
+  {
+    if (!validate)
+      return end - text;
+    const TCodepoint *p = text;
+    while (p < end && !(*p >= 0xD800u && (*p <= 0xDFFFu || *p > 0x10FFFFu)))
+      p++;
+    return p - text;
+  }
+
   static unsigned int
   strlen (const TCodepoint *text)
   {
@@ -373,6 +431,11 @@ struct hb_latin1_t
     return text;
   }
 
+  static unsigned int
+  direct_len (const codepoint_t *text,
+	      const codepoint_t *end)
+  { return end - text; }
+
   static unsigned int
   strlen (const codepoint_t *text)
   {
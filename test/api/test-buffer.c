@@ -812,6 +812,171 @@ test_buffer_utf32_conversion (void)
 }
 
 
+typedef struct {
+  const char *utf8;
+  unsigned int item_offset;
+  int item_length;
+  const uint32_t codepoints[20];
+  const unsigned int clusters[20];
+} utf8_runs_test_t;
+
+/* Runs of ASCII are copied into the buffer directly; check that the
+ * characters around them and all clusters come out as when decoded one
+ * by one, including sequences split across eight-byte words. */
+static const utf8_runs_test_t utf8_runs_tests[] = {
+  /* ASCII only */
+  {"abcdefghijklmnopq", 0, -1,
+   {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}},
+  /* two-byte sequence across a word boundary */
+  {"abcdefg\303\251hijklmnop", 0, -1,
+   {'a', 'b', 'c', 'd', 'e', 'f', 'g', 0xE9, 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15, 16, 17}},
+  /* three-byte sequence at a word boundary */
+  {"abcdefgh\344\270\255ijklmnop", 0, -1,
+   {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 0x4E2D, 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 11, 12, 13, 14, 15, 16, 17, 18}},
+  /* four-byte sequence across a word boundary */
+  {"abcdef\360\237\230\200ghijklmnop", 0, -1,
+   {'a', 'b', 'c', 'd', 'e', 'f', 0x1F600, 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p'},
+   {0, 1, 2, 3, 4, 5, 6, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19}},
+  /* invalid byte */
+  {"abcdefg\377hijklmnop", 0, -1,
+   {'a', 'b', 'c', 'd', 'e', 'f', 'g', (hb_codepoint_t) -1, 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}},
+  /* truncated sequence at a word boundary */
+  {"abcdefg\344\270hijklmnop", 0, -1,
+   {'a', 'b', 'c', 'd', 'e', 'f', 'g', (hb_codepoint_t) -1, (hb_codepoint_t) -1, 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17}},
+  /* single spaces between non-ASCII letters */
+  {"\330\250 \330\250 \330\250 abcd efgh", 0, -1,
+   {0x628, ' ', 0x628, ' ', 0x628, ' ', 'a', 'b', 'c', 'd', ' ', 'e', 'f', 'g', 'h'},
+   {0, 2, 3, 5, 6, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17}},
+  /* lone continuation byte after a short run */
+  {"abc\200defghijk", 0, -1,
+   {'a', 'b', 'c', (hb_codepoint_t) -1, 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+  /* item offset and length */
+  {"abcdefghij", 2, 6,
+   {'c', 'd', 'e', 'f', 'g', 'h'},
+   {2, 3, 4, 5, 6, 7}},
+};
+
+typedef struct {
+  const uint32_t text[16];
+  const uint32_t codepoints[16];
+  const unsigned int clusters[16];
+} utf16_32_runs_test_t;
+
+/* Same for UTF-16, where runs stop at surrogates. */
+static const utf16_32_runs_test_t utf16_runs_tests[] = {
+  /* surrogate pair across a four-unit boundary */
+  {{'a', 'b', 'c', 0xD83D, 0xDE00, 'd', 'e', 'f', 'g', 'h', 'i'},
+   {'a', 'b', 'c', 0x1F600, 'd', 'e', 'f', 'g', 'h', 'i'},
+   {0, 1, 2, 3, 5, 6, 7, 8, 9, 10}},
+  /* lone high surrogate */
+  {{'a', 'b', 'c', 'd', 'e', 'f', 'g', 0xD83D, 'h', 'i', 'j', 'k'},
+   {'a', 'b', 'c', 'd', 'e', 'f', 'g', (hb_codepoint_t) -1, 'h', 'i', 'j', 'k'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+  /* lone low surrogate */
+  {{'a', 'b', 'c', 'd', 0xDE00, 'e', 'f', 'g', 'h', 'i'},
+   {'a', 'b', 'c', 'd', (hb_codepoint_t) -1, 'e', 'f', 'g', 'h', 'i'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}},
+};
+
+/* And for UTF-32, where runs stop at invalid characters. */
+static const utf16_32_runs_test_t utf32_runs_tests[] = {
+  {{'a', 'b', 'c', 'd', 0xD800, 'e', 'f', 'g', 'h', 0x110000, 'i', 'j', 'k', 'l'},
+   {'a', 'b', 'c', 'd', (hb_codepoint_t) -1, 'e', 'f', 'g', 'h', (hb_codepoint_t) -1, 'i', 'j', 'k', 'l'},
+   {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13}},
+};
+
+static void
+check_runs (hb_buffer_t *b,
+	    const uint32_t *codepoints,
+	    const unsigned int *clusters)
+{
+  unsigned int chars, j, len;
+  hb_glyph_info_t *glyphs;
+
+  for (chars = 0; codepoints[chars]; chars++)
+    ;
+
+  glyphs = hb_buffer_get_glyph_infos (b, &len);
+  g_assert_cmpint (len, ==, chars);
+  for (j = 0; j < chars; j++)
+  {
+    g_assert_cmphex (glyphs[j].codepoint, ==, codepoints[j]);
+    g_assert_cmpuint (glyphs[j].cluster, ==, clusters[j]);
+    g_assert_cmphex (glyphs[j].mask, ==, 0);
+  }
+}
+
+static void
+test_buffer_utf_runs (void)
+{
+  hb_buffer_t *b;
+  hb_glyph_info_t *glyphs;
+  unsigned int i, j, u_len, len;
+
+  b = hb_buffer_create ();
+  hb_buffer_set_replacement_codepoint (b, (hb_codepoint_t) -1);
+
+  for (i = 0; i < G_N_ELEMENTS (utf8_runs_tests); i++)
+  {
+    const utf8_runs_test_t *test = &utf8_runs_tests[i];
+
+    g_test_message ("UTF-8 runs test #%d", i);
+
+    hb_buffer_clear_contents (b);
+    hb_buffer_add_utf8 (b, test->utf8, -1, test->item_offset, test->item_length);
+    check_runs (b, test->codepoints, test->clusters);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (utf16_runs_tests); i++)
+  {
+    const utf16_32_runs_test_t *test = &utf16_runs_tests[i];
+    uint16_t utf16[16];
+
+    g_test_message ("UTF-16 runs test #%d", i);
+
+    for (u_len = 0; test->text[u_len]; u_len++)
+      utf16[u_len] = test->text[u_len];
+
+    hb_buffer_clear_contents (b);
+    hb_buffer_add_utf16 (b, utf16, u_len, 0, -1);
+    check_runs (b, test->codepoints, test->clusters);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (utf32_runs_tests); i++)
+  {
+    const utf16_32_runs_test_t *test = &utf32_runs_tests[i];
+
+    g_test_message ("UTF-32 runs test #%d", i);
+
+    for (u_len = 0; test->text[u_len]; u_len++)
+      ;
+
+    hb_buffer_clear_contents (b);
+    hb_buffer_add_utf32 (b, test->text, u_len, 0, -1);
+    check_runs (b, test->codepoints, test->clusters);
+  }
+
+  /* Runs spanning several calls keep counting clusters from each
+   * call's text. */
+  hb_buffer_clear_contents (b);
+  hb_buffer_add_utf8 (b, "abcdefgh", -1, 0, -1);
+  hb_buffer_add_utf8 (b, "ijklmnop", -1, 4, -1);
+  glyphs = hb_buffer_get_glyph_infos (b, &len);
+  g_assert_cmpint (len, ==, 12);
+  for (j = 0; j < 8; j++)
+    g_assert_cmpuint (glyphs[j].cluster, ==, j);
+  for (j = 8; j < 12; j++)
+    g_assert_cmpuint (glyphs[j].cluster, ==, j - 4);
+
+  hb_buffer_destroy (b);
+}
+
 static void
 test_empty (hb_buffer_t *b)
 {
@@ -947,6 +1112,7 @@ main (int argc, char **argv)
   hb_test_add (test_buffer_utf8_validity);
   hb_test_add (test_buffer_utf16_conversion);
   hb_test_add (test_buffer_utf32_conversion);
+  hb_test_add (test_buffer_utf_runs);
   hb_test_add (test_buffer_empty);
   hb_test_add (test_buffer_serialize_deserialize);
 
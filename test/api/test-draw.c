@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include <hb.h>
+#include <hb-ot.h>
 #ifdef HAVE_FREETYPE
 #include <hb-ft.h>
 #endif
@@ -1074,6 +1075,181 @@ test_hb_draw_immutable (void)
   hb_draw_funcs_destroy (draw_funcs);
 }
 
+static void
+_draw_all_glyphs_and_compare (hb_font_t *font, hb_font_t *uncached)
+{
+  char str[2048], str2[2048];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  draw_data_t draw_data2 = {
+    .str = str2,
+    .size = sizeof (str2)
+  };
+  unsigned num_glyphs = hb_face_get_glyph_count (hb_font_get_face (font));
+
+  for (unsigned i = 0; i < 2; i++)
+    for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
+    {
+      draw_data.consumed = 0;
+      hb_font_draw_glyph (font, gid, funcs, &draw_data);
+      draw_data2.consumed = 0;
+      hb_font_draw_glyph (uncached, gid, funcs, &draw_data2);
+      g_assert_cmpmem (str, draw_data.consumed, str2, draw_data2.consumed);
+    }
+}
+
+static void
+test_hb_draw_outline_cache (void)
+{
+  const char *paths[] = {"fonts/TestGVARTwo.ttf", "fonts/AdobeVFPrototype-Subset.otf"};
+  for (unsigned i = 0; i < G_N_ELEMENTS (paths); i++)
+  {
+    hb_face_t *face = hb_test_open_font_file (paths[i]);
+    hb_font_t *font = hb_font_create (face);
+    hb_font_t *uncached = hb_font_create (face);
+    hb_face_destroy (face);
+    hb_variation_t var = {HB_TAG ('w','g','h','t'), 900};
+    unsigned hits, misses;
+
+    hb_ot_font_set_outline_cache (font, 64);
+
+    _draw_all_glyphs_and_compare (font, uncached);
+    hb_ot_font_get_outline_cache_stats (font, &hits, &misses);
+    g_assert_cmpuint (hits, >, 0);
+    g_assert_cmpuint (misses, >, 0);
+
+    /* Recorded outlines must not outlive the coordinates they were
+     * drawn at. */
+    hb_font_set_variations (font, &var, 1);
+    hb_font_set_variations (uncached, &var, 1);
+    _draw_all_glyphs_and_compare (font, uncached);
+
+    /* Slant is applied on replay. */
+    hb_font_set_synthetic_slant (font, 0.2f);
+    hb_font_set_synthetic_slant (uncached, 0.2f);
+    _draw_all_glyphs_and_compare (font, uncached);
+
+    hb_ot_font_set_outline_cache (font, 0);
+    hb_ot_font_get_outline_cache_stats (font, &hits, &misses);
+    g_assert_cmpuint (hits, ==, 0);
+    g_assert_cmpuint (misses, ==, 0);
+
+    hb_font_destroy (uncached);
+    hb_font_destroy (font);
+  }
+}
+
+static void
+test_hb_draw_gvar_cache (void)
+{
+  /* Deltas decompiled at one set of coordinates are reused at the next;
+   * compare against a fresh face at each. */
+  const char *paths[] = {"fonts/TestGVAROne.ttf", "fonts/TestGVARTwo.ttf", "fonts/TestGVARThree.ttf"};
+  float weights[] = {300, 900, 300, 600, 450, 900};
+  char str[2048], str2[2048];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  draw_data_t draw_data2 = {
+    .str = str2,
+    .size = sizeof (str2)
+  };
+  for (unsigned i = 0; i < G_N_ELEMENTS (paths); i++)
+  {
+    hb_face_t *face = hb_test_open_font_file (paths[i]);
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+    hb_codepoint_t gid;
+    g_assert (hb_font_get_nominal_glyph (font, 24396 /* 彌 */, &gid));
+
+    for (unsigned j = 0; j < G_N_ELEMENTS (weights); j++)
+    {
+      hb_variation_t var = {HB_TAG ('w','g','h','t'), weights[j]};
+      hb_font_set_variations (font, &var, 1);
+      draw_data.consumed = 0;
+      hb_font_draw_glyph (font, gid, funcs, &draw_data);
+
+      hb_face_t *fresh_face = hb_test_open_font_file (paths[i]);
+      hb_font_t *fresh = hb_font_create (fresh_face);
+      hb_face_destroy (fresh_face);
+      hb_font_set_variations (fresh, &var, 1);
+      draw_data2.consumed = 0;
+      hb_font_draw_glyph (fresh, gid, funcs, &draw_data2);
+      hb_font_destroy (fresh);
+
+      g_assert_cmpuint (draw_data.consumed, >, 0);
+      g_assert_cmpmem (str, draw_data.consumed, str2, draw_data2.consumed);
+    }
+
+    hb_font_destroy (font);
+  }
+}
+
+static void
+test_hb_draw_cff_charstring_cache (void)
+{
+  /* Charstrings decoded on first use are replayed afterwards, at any
+   * coordinates; compare against fresh faces each time.  Each fresh face
+   * is asked about every glyph once only, so its answers all come from
+   * the charstring interpreter. */
+  const char *paths[] = {"fonts/AdobeVFPrototype-Subset.otf", "fonts/SourceHanSans-Regular.41,4C2E.otf"};
+  float weights[] = {300, 900, 300, 600};
+  char str[2048], str2[2048];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  draw_data_t draw_data2 = {
+    .str = str2,
+    .size = sizeof (str2)
+  };
+  for (unsigned i = 0; i < G_N_ELEMENTS (paths); i++)
+  {
+    hb_face_t *face = hb_test_open_font_file (paths[i]);
+    hb_font_t *font = hb_font_create (face);
+    unsigned num_glyphs = hb_face_get_glyph_count (face);
+    hb_face_destroy (face);
+
+    for (unsigned j = 0; j < G_N_ELEMENTS (weights); j++)
+    {
+      hb_variation_t var = {HB_TAG ('w','g','h','t'), weights[j]};
+      hb_font_set_variations (font, &var, 1);
+
+      hb_font_t *fresh[2];
+      for (unsigned k = 0; k < 2; k++)
+      {
+	hb_face_t *fresh_face = hb_test_open_font_file (paths[i]);
+	fresh[k] = hb_font_create (fresh_face);
+	hb_face_destroy (fresh_face);
+	hb_font_set_variations (fresh[k], &var, 1);
+      }
+
+      for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
+      {
+	hb_glyph_extents_t extents, extents2;
+	g_assert (hb_font_get_glyph_extents (font, gid, &extents));
+	draw_data.consumed = 0;
+	hb_font_draw_glyph (font, gid, funcs, &draw_data);
+
+	g_assert (hb_font_get_glyph_extents (fresh[0], gid, &extents2));
+	draw_data2.consumed = 0;
+	hb_font_draw_glyph (fresh[1], gid, funcs, &draw_data2);
+
+	g_assert_cmpmem (&extents, sizeof (extents), &extents2, sizeof (extents2));
+	g_assert_cmpmem (str, draw_data.consumed, str2, draw_data2.consumed);
+      }
+
+      hb_font_destroy (fresh[0]);
+      hb_font_destroy (fresh[1]);
+    }
+
+    hb_font_destroy (font);
+  }
+}
+
 #ifdef HAVE_FREETYPE
 static void test_hb_draw_ft (void)
 {
@@ -1191,6 +1367,9 @@ main (int argc, char **argv)
   hb_test_add (test_hb_draw_synthetic_slant);
   hb_test_add (test_hb_draw_subfont_scale);
   hb_test_add (test_hb_draw_immutable);
+  hb_test_add (test_hb_draw_outline_cache);
+  hb_test_add (test_hb_draw_gvar_cache);
+  hb_test_add (test_hb_draw_cff_charstring_cache);
 #ifdef HAVE_FREETYPE
   hb_test_add (test_hb_draw_ft);
   hb_test_add (test_hb_draw_compare_ot_ft);
@@ -25,6 +25,7 @@
  */
 
 #include "hb-test.h"
+#include <hb-ot.h>
 
 
 static void
@@ -121,6 +122,55 @@ test_glyph_extents_color_v0 (void)
   hb_face_destroy (face);
 }
 
+static void
+_assert_same_extents (hb_font_t *font, hb_font_t *uncached, unsigned int num_glyphs)
+{
+  for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
+  {
+    hb_glyph_extents_t extents, expected;
+    g_assert_cmpint (hb_font_get_glyph_extents (font, gid, &extents), ==,
+		     hb_font_get_glyph_extents (uncached, gid, &expected));
+    g_assert_cmpint (extents.x_bearing, ==, expected.x_bearing);
+    g_assert_cmpint (extents.y_bearing, ==, expected.y_bearing);
+    g_assert_cmpint (extents.width, ==, expected.width);
+    g_assert_cmpint (extents.height, ==, expected.height);
+  }
+}
+
+static void
+test_glyph_extents_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype-Subset.otf");
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *uncached = hb_font_create (face);
+  unsigned int num_glyphs = hb_face_get_glyph_count (face);
+  hb_variation_t wght = {HB_TAG ('w','g','h','t'), 800};
+
+  /* uncached has no cache by default. */
+  /* Small enough that glyphs evict each other. */
+  hb_ot_font_set_extents_cache (font, 2);
+
+  for (unsigned int i = 0; i < 2; i++)
+    _assert_same_extents (font, uncached, num_glyphs);
+
+  /* Cached extents must not survive changes to the font. */
+  hb_font_set_scale (font, 2000, 3000);
+  hb_font_set_scale (uncached, 2000, 3000);
+  _assert_same_extents (font, uncached, num_glyphs);
+
+  hb_font_set_variations (font, &wght, 1);
+  hb_font_set_variations (uncached, &wght, 1);
+  _assert_same_extents (font, uncached, num_glyphs);
+
+  hb_ot_font_set_extents_cache (font, 256);
+  for (unsigned int i = 0; i < 2; i++)
+    _assert_same_extents (font, uncached, num_glyphs);
+
+  hb_font_destroy (uncached);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -128,6 +178,7 @@ main (int argc, char **argv)
 
   hb_test_add (test_glyph_extents_color_v1);
   hb_test_add (test_glyph_extents_color_v0);
+  hb_test_add (test_glyph_extents_cache);
 
   return hb_test_run();
 }
@@ -25,6 +25,7 @@
  */
 
 #include "hb-test.h"
+#include <hb-ot.h>
 
 /* Unit tests for hb-font.h */
 
@@ -598,6 +599,62 @@ test_font_properties (void)
   hb_font_destroy (subfont);
 }
 
+static void
+test_font_cmap_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Mplus1p-Regular.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *cached = hb_font_create (face);
+  hb_codepoint_t u, glyph, cached_glyph;
+  unsigned int hits, misses;
+
+  hb_ot_font_get_cmap_cache_stats (cached, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  /* Small enough that the characters below collide. */
+  hb_ot_font_set_cmap_cache (cached, 64, 4, TRUE);
+
+  for (unsigned int i = 0; i < 2; i++)
+    for (u = 0; u < 0x10000u; u += 7)
+    {
+      hb_bool_t ret = hb_font_get_nominal_glyph (font, u, &glyph);
+      g_assert_cmpint (ret, ==, hb_font_get_nominal_glyph (cached, u, &cached_glyph));
+      if (ret)
+	g_assert_cmpuint (glyph, ==, cached_glyph);
+    }
+
+  hb_ot_font_get_cmap_cache_stats (cached, &hits, &misses);
+  g_assert_cmpuint (misses, >, 0);
+
+  g_assert (hb_font_get_nominal_glyph (cached, 0x3042u, &glyph));
+  g_assert (hb_font_get_nominal_glyph (cached, 0x3042u, &cached_glyph));
+  g_assert_cmpuint (glyph, ==, cached_glyph);
+  hb_ot_font_get_cmap_cache_stats (cached, &hits, NULL);
+  g_assert_cmpuint (hits, >, 0);
+
+  /* Without stats nothing is counted. */
+  hb_ot_font_set_cmap_cache (cached, 64, 4, FALSE);
+  g_assert (hb_font_get_nominal_glyph (cached, 0x3042u, &cached_glyph));
+  g_assert (hb_font_get_nominal_glyph (cached, 0x3042u, &cached_glyph));
+  g_assert_cmpuint (glyph, ==, cached_glyph);
+  hb_ot_font_get_cmap_cache_stats (cached, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  /* Dropping the cache falls back to the shared one. */
+  hb_ot_font_set_cmap_cache (cached, 0, 0, FALSE);
+  hb_ot_font_get_cmap_cache_stats (cached, &hits, &misses);
+  g_assert_cmpuint (hits, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+  g_assert (hb_font_get_nominal_glyph (cached, 0x3042u, &cached_glyph));
+  g_assert_cmpuint (glyph, ==, cached_glyph);
+
+  hb_font_destroy (cached);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -614,6 +671,7 @@ main (int argc, char **argv)
 
   hb_test_add (test_font_empty);
   hb_test_add (test_font_properties);
+  hb_test_add (test_font_cmap_cache);
 
   return hb_test_run();
 }
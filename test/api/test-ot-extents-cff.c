@@ -215,6 +215,40 @@ test_extents_cff2_vsindex_named_instance (void)
   hb_font_destroy (font);
 }
 
+static void
+test_extents_cff2_vsindex_coords_change (void)
+{
+  /* Region scalars are shared per font; they must follow the coords. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype_vsindex.otf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  hb_glyph_extents_t  extents;
+  float coords[2] = { 800.0f, 50.0f };
+  float coords2[2] = { 900.0f, 50.0f };
+  for (unsigned i = 0; i < 2; i++)
+  {
+    hb_font_set_var_coords_design (font, coords, 2);
+    g_assert (hb_font_get_glyph_extents (font, 2, &extents));
+    g_assert_cmpint (extents.x_bearing, ==, 8);
+    g_assert_cmpint (extents.y_bearing, ==, 669);
+    g_assert_cmpint (extents.width, ==, 648);
+    g_assert_cmpint (extents.height, ==, -669);
+
+    hb_font_set_var_coords_design (font, coords2, 2);
+    g_assert (hb_font_get_glyph_extents (font, 2, &extents));
+    g_assert_cmpint (extents.x_bearing, ==, 6);
+    g_assert_cmpint (extents.y_bearing, ==, 675);
+    g_assert_cmpint (extents.width, ==, 647);
+    g_assert_cmpint (extents.height, ==, -675);
+  }
+
+  hb_font_destroy (font);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -226,6 +260,7 @@ main (int argc, char **argv)
   hb_test_add (test_extents_cff2);
   hb_test_add (test_extents_cff2_vsindex);
   hb_test_add (test_extents_cff2_vsindex_named_instance);
+  hb_test_add (test_extents_cff2_vsindex_coords_change);
 
   return hb_test_run ();
 }
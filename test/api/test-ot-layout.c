@@ -215,6 +215,69 @@ test_ot_layout_language_get_feature_tags (void)
   hb_face_destroy (face);
 }
 
+static hb_blob_t *
+_single_subst_reference_table (hb_face_t *face HB_UNUSED, hb_tag_t tag, void *user_data HB_UNUSED)
+{
+  /* cmap mapping 'a'..'h' to glyphs 1..8. */
+  static const char cmap[] =
+    "\x00\x00\x00\x01"
+    "\x00\x03\x00\x0A\x00\x00\x00\x0C"
+    "\x00\x0C\x00\x00\x00\x00\x00\x1C\x00\x00\x00\x00\x00\x00\x00\x01"
+    "\x00\x00\x00\x61\x00\x00\x00\x68\x00\x00\x00\x01";
+  /* GSUB with a DFLT script, one 'test' feature, and a SingleSubstFormat1
+   * lookup with delta -9 on glyphs 1..8, taking glyph 8 to 0xFFFF. */
+  static const char gsub[] =
+    "\x00\x01\x00\x00\x00\x0A\x00\x1E\x00\x2C"
+    "\x00\x01" "DFLT" "\x00\x08"
+    "\x00\x04\x00\x00"
+    "\x00\x00\xFF\xFF\x00\x01\x00\x00"
+    "\x00\x01" "test" "\x00\x08"
+    "\x00\x00\x00\x01\x00\x00"
+    "\x00\x01\x00\x04"
+    "\x00\x01\x00\x00\x00\x01\x00\x08"
+    "\x00\x01\x00\x06\xFF\xF7"
+    "\x00\x02\x00\x01\x00\x01\x00\x08\x00\x00";
+  /* maxp version 0.5 with 65535 glyphs. */
+  static const char maxp[] = "\x00\x00\x50\x00\xFF\xFF";
+
+  switch (tag)
+  {
+  case HB_TAG ('c','m','a','p'): return hb_blob_create (cmap, sizeof (cmap) - 1, HB_MEMORY_MODE_READONLY, NULL, NULL);
+  case HB_TAG ('G','S','U','B'): return hb_blob_create (gsub, sizeof (gsub) - 1, HB_MEMORY_MODE_READONLY, NULL, NULL);
+  case HB_TAG ('m','a','x','p'): return hb_blob_create (maxp, sizeof (maxp) - 1, HB_MEMORY_MODE_READONLY, NULL, NULL);
+  default: return NULL;
+  }
+}
+
+static void
+test_ot_layout_single_subst_large_glyph (void)
+{
+  hb_face_t *face = hb_face_create_for_tables (_single_subst_reference_table, NULL, NULL);
+  hb_font_t *font = hb_font_create (face);
+  hb_feature_t feature = {HB_TAG ('t','e','s','t'), 1, HB_FEATURE_GLOBAL_START, HB_FEATURE_GLOBAL_END};
+
+  /* Shape twice; the second time around the lookup uses the tables
+   * its accelerator built. */
+  for (unsigned i = 0; i < 2; i++)
+  {
+    hb_buffer_t *buffer = hb_buffer_create ();
+    hb_buffer_add_utf8 (buffer, "abcdefgh", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    hb_shape (font, buffer, &feature, 1);
+
+    unsigned len;
+    hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buffer, &len);
+    g_assert_cmpuint (len, ==, 8);
+    for (unsigned j = 0; j < len; j++)
+      g_assert_cmphex (info[j].codepoint, ==, 0xFFF8u + j);
+
+    hb_buffer_destroy (buffer);
+  }
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -224,5 +287,6 @@ main (int argc, char **argv)
   hb_test_add (test_ot_layout_script_get_language_tags);
   hb_test_add (test_ot_layout_table_get_feature_tags);
   hb_test_add (test_ot_layout_language_get_feature_tags);
+  hb_test_add (test_ot_layout_single_subst_large_glyph);
   return hb_test_run ();
 }
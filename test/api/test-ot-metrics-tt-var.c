@@ -130,6 +130,45 @@ test_advance_tt_var_hvarvvar (void)
   g_assert_cmpint (x, ==, 0);
   g_assert_cmpint (y, ==, -1012);
 
+  /* Region scalars go with the coordinates they were computed at. */
+  hb_font_set_var_coords_design (font, NULL, 0);
+  hb_font_get_glyph_advance_for_direction(font, 1, HB_DIRECTION_LTR, &x, &y);
+
+  g_assert_cmpint (x, ==, 508);
+  g_assert_cmpint (y, ==, 0);
+
+  hb_font_get_glyph_advance_for_direction(font, 1, HB_DIRECTION_TTB, &x, &y);
+
+  g_assert_cmpint (x, ==, 0);
+  g_assert_cmpint (y, ==, -1000);
+
+  hb_font_destroy (font);
+}
+
+static void
+test_advance_tt_var_hvarvvar_array (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+  hb_ot_font_set_advance_array_budget (font, 1 << 16);
+
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, 1), ==, 508);
+
+  float coords[1] = { 700.0f };
+  hb_font_set_var_coords_design (font, coords, 1);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, 1), ==, 531);
+
+  hb_font_set_scale (font, 2000, 2000);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, 1), ==, 1062);
+
+  /* Too small a budget leaves the advances uncached, but still correct. */
+  hb_ot_font_set_advance_array_budget (font, 1);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, 1), ==, 1062);
+
   hb_font_destroy (font);
 }
 
@@ -259,6 +298,7 @@ main (int argc, char **argv)
   hb_test_add (test_extents_tt_var);
   hb_test_add (test_advance_tt_var_nohvar);
   hb_test_add (test_advance_tt_var_hvarvvar);
+  hb_test_add (test_advance_tt_var_hvarvvar_array);
   hb_test_add (test_advance_tt_var_anchor);
   hb_test_add (test_extents_tt_var_comp);
   hb_test_add (test_advance_tt_var_comp_v);
@@ -25,6 +25,7 @@
  */
 
 #include "hb-test.h"
+#include <hb-ot.h>
 
 /* Unit tests for hb-shape.h */
 
@@ -180,6 +181,294 @@ test_shape_clusters (void)
 }
 
 
+static void
+test_shape_batch (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  const char *texts[] = {"abc", "cba", "", "aabbcc", "c"};
+  hb_buffer_t *buffers[G_N_ELEMENTS (texts)];
+  unsigned int i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (texts); i++)
+  {
+    buffers[i] = hb_buffer_create ();
+    hb_buffer_add_utf8 (buffers[i], texts[i], -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffers[i]);
+  }
+  /* Change segment properties midway to force a plan switch. */
+  hb_buffer_set_direction (buffers[3], HB_DIRECTION_RTL);
+
+  g_assert (hb_shape_batch (font, buffers, G_N_ELEMENTS (texts), NULL, 0, NULL));
+
+  for (i = 0; i < G_N_ELEMENTS (texts); i++)
+  {
+    hb_buffer_t *expected = hb_buffer_create ();
+    hb_buffer_add_utf8 (expected, texts[i], -1, 0, -1);
+    hb_buffer_guess_segment_properties (expected);
+    if (i == 3)
+      hb_buffer_set_direction (expected, HB_DIRECTION_RTL);
+    hb_shape (font, expected, NULL, 0);
+
+    unsigned int len, expected_len;
+    hb_glyph_info_t *infos = hb_buffer_get_glyph_infos (buffers[i], &len);
+    hb_glyph_position_t *positions = hb_buffer_get_glyph_positions (buffers[i], NULL);
+    hb_glyph_info_t *expected_infos = hb_buffer_get_glyph_infos (expected, &expected_len);
+    hb_glyph_position_t *expected_positions = hb_buffer_get_glyph_positions (expected, NULL);
+
+    g_assert_cmpint (len, ==, expected_len);
+    for (j = 0; j < len; j++)
+    {
+      g_assert_cmpint (infos[j].codepoint, ==, expected_infos[j].codepoint);
+      g_assert_cmpint (infos[j].cluster, ==, expected_infos[j].cluster);
+      g_assert_cmpint (positions[j].x_advance, ==, expected_positions[j].x_advance);
+      g_assert_cmpint (positions[j].x_offset, ==, expected_positions[j].x_offset);
+    }
+
+    hb_buffer_destroy (expected);
+    hb_buffer_destroy (buffers[i]);
+  }
+
+  hb_font_destroy (font);
+}
+
+static void
+test_shape_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_shape_cache_t *cache = hb_shape_cache_create (2 * 16);
+  const char *texts[] = {"abc", "cba", "abc", "aabbcc", "abc", "cba"};
+  unsigned int i, j, hits, misses, evictions;
+
+  for (i = 0; i < G_N_ELEMENTS (texts); i++)
+  {
+    hb_buffer_t *buffer = hb_buffer_create ();
+    hb_buffer_t *expected = hb_buffer_create ();
+
+    /* Shape the same word at different text offsets. */
+    hb_buffer_add_utf8 (buffer, texts[i], -1, 0, -1);
+    hb_buffer_add_utf8 (expected, texts[i], -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    hb_buffer_guess_segment_properties (expected);
+    for (j = 0; j < hb_buffer_get_length (buffer); j++)
+      hb_buffer_get_glyph_infos (buffer, NULL)[j].cluster += 10 * i;
+    for (j = 0; j < hb_buffer_get_length (expected); j++)
+      hb_buffer_get_glyph_infos (expected, NULL)[j].cluster += 10 * i;
+
+    g_assert (hb_shape_cache_shape (cache, font, buffer, NULL, 0, NULL));
+    hb_shape (font, expected, NULL, 0);
+
+    unsigned int len, expected_len;
+    hb_glyph_info_t *infos = hb_buffer_get_glyph_infos (buffer, &len);
+    hb_glyph_position_t *positions = hb_buffer_get_glyph_positions (buffer, NULL);
+    hb_glyph_info_t *expected_infos = hb_buffer_get_glyph_infos (expected, &expected_len);
+    hb_glyph_position_t *expected_positions = hb_buffer_get_glyph_positions (expected, NULL);
+
+    g_assert_cmpint (hb_buffer_get_content_type (buffer), ==, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+    g_assert_cmpint (len, ==, expected_len);
+    for (j = 0; j < len; j++)
+    {
+      g_assert_cmpint (infos[j].codepoint, ==, expected_infos[j].codepoint);
+      g_assert_cmpint (infos[j].cluster, ==, expected_infos[j].cluster);
+      g_assert_cmpint (infos[j].mask, ==, expected_infos[j].mask);
+      g_assert_cmpint (positions[j].x_advance, ==, expected_positions[j].x_advance);
+      g_assert_cmpint (positions[j].x_offset, ==, expected_positions[j].x_offset);
+    }
+
+    hb_buffer_destroy (expected);
+    hb_buffer_destroy (buffer);
+  }
+
+  hb_shape_cache_get_stats (cache, &hits, &misses, &evictions);
+  g_assert_cmpint (hits, ==, 3);
+  g_assert_cmpint (misses, ==, 3);
+  g_assert_cmpint (evictions, ==, 0);
+
+  /* Changing the font invalidates its results. */
+  hb_font_set_scale (font, 100, 100);
+  {
+    hb_buffer_t *buffer = hb_buffer_create ();
+    hb_buffer_add_utf8 (buffer, "abc", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    g_assert (hb_shape_cache_shape (cache, font, buffer, NULL, 0, NULL));
+    g_assert_cmpint (hb_buffer_get_glyph_positions (buffer, NULL)[0].x_advance, <, 100);
+    hb_buffer_destroy (buffer);
+  }
+  hb_shape_cache_get_stats (cache, &hits, &misses, NULL);
+  g_assert_cmpint (hits, ==, 3);
+  g_assert_cmpint (misses, ==, 4);
+
+  hb_shape_cache_clear (cache);
+  hb_shape_cache_destroy (cache);
+  hb_font_destroy (font);
+}
+
+static void
+test_shape_profile (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.gsub.fil.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_shape_profile_t *profile = hb_shape_profile_create ();
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_shape_profile_lookup_t lookups[8];
+  double times[8];
+  unsigned int i, count, total, visited = 0;
+
+  hb_buffer_set_shape_profile (buffer, profile);
+  g_assert (hb_buffer_get_shape_profile (buffer) == profile);
+
+  for (i = 0; i < 2; i++)
+  {
+    hb_buffer_reset (buffer);
+    hb_buffer_add_utf8 (buffer, "fil fi", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    hb_shape (font, buffer, NULL, 0);
+  }
+  /* The profile survives hb_buffer_reset(). */
+  g_assert (hb_buffer_get_shape_profile (buffer) == profile);
+
+  for (i = 0; i < HB_SHAPE_PROFILE_STAGE_FINISH + 1; i++)
+    g_assert_cmpfloat (hb_shape_profile_get_stage_time (profile, i), >=, 0.);
+
+  count = G_N_ELEMENTS (times);
+  total = hb_shape_profile_get_layout_stage_times (profile, HB_OT_TAG_GSUB, 0, &count, times);
+  g_assert_cmpuint (total, >, 0);
+  g_assert_cmpuint (count, ==, MIN (total, G_N_ELEMENTS (times)));
+
+  count = G_N_ELEMENTS (lookups);
+  total = hb_shape_profile_get_lookups (profile, HB_OT_TAG_GSUB, 0, &count, lookups);
+  g_assert_cmpuint (total, >, 0);
+  g_assert_cmpuint (count, ==, MIN (total, G_N_ELEMENTS (lookups)));
+  for (i = 0; i < count; i++)
+  {
+    g_assert_cmpuint (lookups[i].invocations, ==, 2);
+    g_assert_cmpuint (lookups[i].digest_rejections, <=, lookups[i].glyphs_visited);
+    g_assert_cmpuint (lookups[i].applications, <=, lookups[i].glyphs_visited);
+    if (i)
+      g_assert_cmpuint (lookups[i].lookup_index, >, lookups[i - 1].lookup_index);
+    visited += lookups[i].glyphs_visited;
+  }
+  g_assert_cmpuint (visited, >, 0);
+
+  g_assert_cmpuint (hb_shape_profile_get_lookups (profile, HB_OT_TAG_GSUB, total, &count, lookups), ==, total);
+  g_assert_cmpuint (count, ==, 0);
+  g_assert_cmpuint (hb_shape_profile_get_lookups (profile, HB_TAG ('k','e','r','x'), 0, NULL, NULL), ==, 0);
+
+  hb_shape_profile_reset (profile);
+  g_assert_cmpfloat (hb_shape_profile_get_stage_time (profile, HB_SHAPE_PROFILE_STAGE_SUBSTITUTE), ==, 0.);
+  g_assert_cmpuint (hb_shape_profile_get_layout_stage_times (profile, HB_OT_TAG_GSUB, 0, NULL, NULL), ==, 0);
+  g_assert_cmpuint (hb_shape_profile_get_lookups (profile, HB_OT_TAG_GSUB, 0, NULL, NULL), ==, 0);
+
+  /* Attaching the empty profile detaches. */
+  hb_buffer_set_shape_profile (buffer, hb_shape_profile_get_empty ());
+  g_assert (hb_buffer_get_shape_profile (buffer) == NULL);
+
+  hb_buffer_destroy (buffer);
+  hb_shape_profile_destroy (profile);
+  hb_font_destroy (font);
+}
+
+static void
+test_shape_plan_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  const char *languages[] = {"en", "fr", "en", "de", "fr"};
+  hb_shape_plan_t *plans[G_N_ELEMENTS (languages)];
+  unsigned int i, hits, misses, evictions;
+
+  hb_face_set_shape_plan_cache_capacity (face, 2);
+
+  for (i = 0; i < G_N_ELEMENTS (languages); i++)
+  {
+    hb_segment_properties_t props = HB_SEGMENT_PROPERTIES_DEFAULT;
+    props.direction = HB_DIRECTION_LTR;
+    props.script = HB_SCRIPT_LATIN;
+    props.language = hb_language_from_string (languages[i], -1);
+    plans[i] = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  }
+
+  /* en is found again; fr was evicted by de. */
+  g_assert (plans[2] == plans[0]);
+  g_assert (plans[4] != plans[1]);
+
+  hb_face_get_shape_plan_cache_stats (face, &hits, &misses, &evictions);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 4);
+  g_assert_cmpuint (evictions, ==, 2);
+
+  /* Plans stay valid after eviction. */
+  g_assert_cmpstr (hb_shape_plan_get_shaper (plans[1]), ==, "ot");
+
+  /* Shrinking evicts down to the new capacity; zero disables caching. */
+  hb_face_set_shape_plan_cache_capacity (face, 0);
+  hb_face_get_shape_plan_cache_stats (face, NULL, NULL, &evictions);
+  g_assert_cmpuint (evictions, ==, 4);
+
+  for (i = 0; i < G_N_ELEMENTS (languages); i++)
+    hb_shape_plan_destroy (plans[i]);
+  hb_face_destroy (face);
+}
+
+static void
+test_buffer_reshape_range (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  /* Replace "b" at 5 with "cc", then delete the last word, then insert
+   * at the start. */
+  struct {
+    const char *text;
+    unsigned int start, old_end, new_end;
+  } edits[] = {
+    {"abc acc abc", 5, 6, 7},
+    {"abc acc ", 8, 11, 8},
+    {"ababc acc ", 0, 0, 2},
+  };
+  unsigned int i, flags;
+
+  for (flags = 0; flags < 2; flags++)
+  {
+    hb_buffer_t *buffer = hb_buffer_create ();
+    hb_buffer_set_flags (buffer, flags ? HB_BUFFER_FLAG_VERIFY : HB_BUFFER_FLAG_DEFAULT);
+    hb_buffer_add_utf8 (buffer, "abc abc abc", -1, 0, -1);
+    hb_buffer_guess_segment_properties (buffer);
+    hb_shape (font, buffer, NULL, 0);
+
+    for (i = 0; i < G_N_ELEMENTS (edits); i++)
+    {
+      hb_buffer_t *text = hb_buffer_create ();
+      hb_buffer_t *expected = hb_buffer_create ();
+      hb_buffer_add_utf8 (text, edits[i].text, -1, 0, -1);
+      hb_buffer_add_utf8 (expected, edits[i].text, -1, 0, -1);
+      hb_buffer_guess_segment_properties (text);
+      hb_buffer_guess_segment_properties (expected);
+      hb_shape (font, expected, NULL, 0);
+
+      g_assert (hb_buffer_reshape_range (buffer, text,
+					 edits[i].start, edits[i].old_end, edits[i].new_end,
+					 font, NULL, 0, NULL));
+      g_assert_cmpuint (hb_buffer_diff (buffer, expected, (hb_codepoint_t) -1, 0) &
+			~HB_BUFFER_DIFF_FLAG_GLYPH_FLAGS_MISMATCH, ==, HB_BUFFER_DIFF_FLAG_EQUAL);
+
+      hb_buffer_destroy (expected);
+      hb_buffer_destroy (text);
+    }
+
+    hb_buffer_destroy (buffer);
+  }
+
+  hb_font_destroy (font);
+}
+
 static void
 test_shape_list (void)
 {
@@ -202,6 +491,11 @@ main (int argc, char **argv)
   hb_test_add (test_shape_clusters);
   /* TODO test fallback shaper */
   /* TODO test shaper_full */
+  hb_test_add (test_shape_batch);
+  hb_test_add (test_shape_cache);
+  hb_test_add (test_shape_profile);
+  hb_test_add (test_shape_plan_cache);
+  hb_test_add (test_buffer_reshape_range);
   hb_test_add (test_shape_list);
 
   return hb_test_run();
@@ -204,6 +204,40 @@ test_subset_cff1_j_desubr (void)
   hb_face_destroy (face_41_4c2e);
 }
 
+static void
+test_subset_cff1_j_desubr_incremental (void)
+{
+  hb_face_t *face_41_3041_4c2e = hb_test_open_font_file ("fonts/SourceHanSans-Regular.41,3041,4C2E.otf");
+  hb_face_t *face_41_4c2e = hb_test_open_font_file ("fonts/SourceHanSans-Regular.41,4C2E.nosubrs.otf");
+
+  hb_set_t *codepoints = hb_set_create ();
+  hb_subset_input_t *input;
+  hb_subset_plan_t *plan_41, *plan_41_4c2e;
+  hb_face_t *face_41_subset, *face_41_3041_4c2e_subset;
+  hb_set_add (codepoints, 0x41);
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_flags (input, HB_SUBSET_FLAGS_DESUBROUTINIZE);
+  plan_41 = hb_subset_plan_create_or_fail (face_41_3041_4c2e, input);
+  face_41_subset = hb_subset_plan_execute_or_fail (plan_41);
+
+  /* Extend the executed plan, reusing its flattened charstrings. */
+  hb_set_clear (codepoints);
+  hb_set_add (codepoints, 0x4C2E);
+  plan_41_4c2e = hb_subset_plan_create_incremental_or_fail (plan_41, codepoints, NULL);
+  hb_subset_plan_destroy (plan_41);
+  face_41_3041_4c2e_subset = hb_subset_plan_execute_or_fail (plan_41_4c2e);
+  hb_set_destroy (codepoints);
+
+  hb_subset_test_check (face_41_4c2e, face_41_3041_4c2e_subset, HB_TAG ('C','F','F',' '));
+
+  hb_subset_input_destroy (input);
+  hb_subset_plan_destroy (plan_41_4c2e);
+  hb_face_destroy (face_41_subset);
+  hb_face_destroy (face_41_3041_4c2e_subset);
+  hb_face_destroy (face_41_3041_4c2e);
+  hb_face_destroy (face_41_4c2e);
+}
+
 static void
 test_subset_cff1_j_desubr_strip_hints (void)
 {
@@ -377,6 +411,7 @@ main (int argc, char **argv)
   hb_test_add (test_subset_cff1_j);
   hb_test_add (test_subset_cff1_j_strip_hints);
   hb_test_add (test_subset_cff1_j_desubr);
+  hb_test_add (test_subset_cff1_j_desubr_incremental);
   hb_test_add (test_subset_cff1_j_desubr_strip_hints);
   hb_test_add (test_subset_cff1_expert);
   hb_test_add (test_subset_cff1_seac);
@@ -192,6 +192,99 @@ test_subset_plan (void)
   hb_face_destroy (face_ac);
 }
 
+static void
+test_subset_plan_incremental (void)
+{
+  hb_face_t *face_abc = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_face_t *face_ac = hb_test_open_font_file ("fonts/Roboto-Regular.ac.ttf");
+
+  hb_set_t *codepoints = hb_set_create();
+  hb_set_add (codepoints, 97);
+  hb_subset_input_t* input = hb_subset_test_create_input (codepoints);
+
+  hb_subset_plan_t* plan_a = hb_subset_plan_create_or_fail (face_abc, input);
+  g_assert (plan_a);
+  hb_face_t* face_a_subset = hb_subset_plan_execute_or_fail (plan_a);
+
+  hb_set_clear (codepoints);
+  hb_set_add (codepoints, 99);
+  hb_subset_plan_t* plan_ac = hb_subset_plan_create_incremental_or_fail (plan_a, codepoints, NULL);
+  g_assert (plan_ac);
+  hb_set_destroy (codepoints);
+
+  /* The input of plan_a is left untouched. */
+  g_assert (hb_map_get_population (hb_subset_plan_old_to_new_glyph_mapping (plan_a)) == 2);
+
+  const hb_map_t* mapping = hb_subset_plan_old_to_new_glyph_mapping (plan_ac);
+  g_assert (hb_map_get (mapping, 1) == 1);
+  g_assert (hb_map_get (mapping, 3) == 2);
+
+  hb_face_t* face_ac_subset = hb_subset_plan_execute_or_fail (plan_ac);
+
+  hb_subset_test_check (face_ac, face_ac_subset, HB_TAG ('l','o','c', 'a'));
+  hb_subset_test_check (face_ac, face_ac_subset, HB_TAG ('g','l','y','f'));
+
+  hb_subset_input_destroy (input);
+  hb_subset_plan_destroy (plan_a);
+  hb_subset_plan_destroy (plan_ac);
+  hb_face_destroy (face_a_subset);
+  hb_face_destroy (face_ac_subset);
+  hb_face_destroy (face_abc);
+  hb_face_destroy (face_ac);
+}
+
+static void
+test_subset_preprocessed_layout (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_t *preprocessed = hb_subset_preprocess (face);
+  g_assert (preprocessed);
+
+  /* Repeated, nested and overlapping sets, so that plans from the
+   * preprocessed face both reuse and miss its cached layout closures. */
+  static const hb_codepoint_t sets[][6] = {
+    {0x0627, 0x0628, 0x0644},
+    {0x0627, 0x0628, 0x0644, 0x0645, 0x0646},
+    {0x0627, 0x0628, 0x0644},
+    {0x0644, 0x0645, 0x0647, 0x06CC},
+    {0x0627, 0x0628, 0x0644, 0x0645, 0x0646},
+    {0x0644, 0x0645, 0x0647, 0x06CC, 0x0628, 0x06F1},
+    {0x0644, 0x0645, 0x0647, 0x06CC},
+  };
+  static const hb_subset_flags_t flags[] = {
+    HB_SUBSET_FLAGS_DEFAULT,
+    HB_SUBSET_FLAGS_NO_LAYOUT_CLOSURE,
+  };
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (flags); f++)
+    for (unsigned i = 0; i < G_N_ELEMENTS (sets); i++)
+    {
+      hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+      hb_set_t *codepoints = hb_subset_input_unicode_set (input);
+      for (unsigned j = 0; j < G_N_ELEMENTS (sets[i]) && sets[i][j]; j++)
+	hb_set_add (codepoints, sets[i][j]);
+      hb_subset_input_set_flags (input, flags[f]);
+
+      hb_face_t *expected = hb_subset_or_fail (face, input);
+      hb_face_t *actual = hb_subset_or_fail (preprocessed, input);
+      g_assert (expected);
+      g_assert (actual);
+
+      hb_subset_test_check (expected, actual, HB_TAG ('G','S','U','B'));
+      hb_subset_test_check (expected, actual, HB_TAG ('G','P','O','S'));
+      hb_subset_test_check (expected, actual, HB_TAG ('G','D','E','F'));
+      hb_subset_test_check (expected, actual, HB_TAG ('c','m','a','p'));
+      hb_subset_test_check (expected, actual, HB_TAG ('g','l','y','f'));
+
+      hb_face_destroy (expected);
+      hb_face_destroy (actual);
+      hb_subset_input_destroy (input);
+    }
+
+  hb_face_destroy (preprocessed);
+  hb_face_destroy (face);
+}
+
 static hb_blob_t*
 _ref_table (hb_face_t *face HB_UNUSED, hb_tag_t tag, void *user_data)
 {
@@ -239,6 +332,8 @@ main (int argc, char **argv)
   hb_test_add (test_subset_set_flags);
   hb_test_add (test_subset_sets);
   hb_test_add (test_subset_plan);
+  hb_test_add (test_subset_plan_incremental);
+  hb_test_add (test_subset_preprocessed_layout);
   hb_test_add (test_subset_create_for_tables_face);
 
   return hb_test_run();
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hb.h"
+
+struct test_input_t
+{
+  const char *font_path;
+  const char *text_path;
+} default_tests[] =
+{
+
+  {"perf/fonts/NotoNastaliqUrdu-Regular.ttf",
+   "perf/texts/fa-thelittleprince.txt"},
+
+  {"perf/fonts/Amiri-Regular.ttf",
+   "perf/texts/fa-thelittleprince.txt"},
+
+  {"perf/fonts/Roboto-Regular.ttf",
+   "perf/texts/en-thelittleprince.txt"},
+};
+
+
+static test_input_t *tests = default_tests;
+static unsigned num_tests = sizeof (default_tests) / sizeof (default_tests[0]);
+
+static unsigned num_threads = 4;
+
+static void run_tasks (unsigned int num_tasks,
+		       hb_shape_task_func_t task,
+		       void *task_data,
+		       void *user_data)
+{
+  std::atomic<unsigned> next {0};
+  auto worker = [&] () {
+    unsigned i;
+    while ((i = next++) < num_tasks)
+      task (i, task_data);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < num_threads && i < num_tasks; i++)
+    threads.push_back (std::thread (worker));
+  worker ();
+  for (auto &thread : threads)
+    thread.join ();
+}
+
+/* Compares glyphs, positions and the given glyph flags. */
+static bool buffers_equal (hb_buffer_t *a, hb_buffer_t *b,
+			   unsigned flags = HB_GLYPH_FLAG_DEFINED)
+{
+  unsigned len_a, len_b;
+  hb_glyph_info_t *info_a = hb_buffer_get_glyph_infos (a, &len_a);
+  hb_glyph_info_t *info_b = hb_buffer_get_glyph_infos (b, &len_b);
+  hb_glyph_position_t *pos_a = hb_buffer_get_glyph_positions (a, nullptr);
+  hb_glyph_position_t *pos_b = hb_buffer_get_glyph_positions (b, nullptr);
+  if (len_a != len_b)
+    return false;
+  for (unsigned i = 0; i < len_a; i++)
+    if (info_a[i].codepoint != info_b[i].codepoint ||
+	info_a[i].cluster != info_b[i].cluster ||
+	((hb_glyph_info_get_glyph_flags (&info_a[i]) ^ hb_glyph_info_get_glyph_flags (&info_b[i])) & flags) ||
+	memcmp (&pos_a[i], &pos_b[i], sizeof (pos_a[i])))
+      return false;
+  return true;
+}
+
+static bool test_input (const test_input_t &input)
+{
+  printf ("Testing %s %s\n", input.font_path, input.text_path);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (input.font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  hb_buffer_t *expected = hb_buffer_create ();
+  hb_buffer_t *buf = hb_buffer_create ();
+  hb_buffer_t *bounded = hb_buffer_create ();
+  unsigned num_lines = 0, num_failures = 0;
+
+  const char *end;
+  while ((end = (const char *) memchr (text, '\n', text_length)))
+  {
+    hb_buffer_clear_contents (expected);
+    hb_buffer_add_utf8 (expected, text, text_length, 0, end - text);
+    hb_buffer_guess_segment_properties (expected);
+    /* Every other line also checks the flags that are only produced on
+     * request. */
+    hb_buffer_flags_t flags = num_lines & 1 ? HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT : HB_BUFFER_FLAG_DEFAULT;
+    hb_buffer_set_flags (expected, flags);
+    hb_buffer_clear_contents (buf);
+    hb_buffer_set_flags (buf, flags);
+    hb_buffer_append (buf, expected, 0, -1);
+    hb_buffer_clear_contents (bounded);
+    hb_buffer_set_flags (bounded, flags);
+    hb_buffer_append (bounded, expected, 0, -1);
+
+    hb_shape (font, expected, nullptr, 0);
+    hb_shape_parallel (font, buf, nullptr, 0, nullptr, num_threads * 2,
+		       HB_SHAPE_PARALLEL_FLAG_DEFAULT, run_tasks, nullptr);
+    hb_shape_parallel (font, bounded, nullptr, 0, nullptr, num_threads * 2,
+		       HB_SHAPE_PARALLEL_FLAG_BOUNDED_LOOKAHEAD, run_tasks, nullptr);
+
+    if (!buffers_equal (expected, buf) ||
+	/* None of these fonts reach past the lookahead. */
+	!buffers_equal (expected, bounded, HB_GLYPH_FLAG_UNSAFE_TO_BREAK))
+    {
+      fprintf (stderr, "Mismatch shaping line %u\n", num_lines + 1);
+      num_failures++;
+    }
+    num_lines++;
+
+    unsigned skip = end - text + 1;
+    text_length -= skip;
+    text += skip;
+  }
+
+  printf ("%u lines, %u mismatches\n", num_lines, num_failures);
+
+  hb_buffer_destroy (bounded);
+  hb_buffer_destroy (buf);
+  hb_buffer_destroy (expected);
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+
+  return !num_failures;
+}
+
+/* Shapes text whose characters share cluster values in pairs, such that
+ * clusters repeat across space boundaries, and checks hb_shape_parallel()
+ * does not split it there. */
+static bool test_repeated_clusters (const test_input_t &input)
+{
+  printf ("Testing repeated clusters %s %s\n", input.font_path, input.text_path);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (input.font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  hb_buffer_t *expected = hb_buffer_create ();
+  hb_buffer_t *buf = hb_buffer_create ();
+  bool success = true;
+  for (unsigned shift = 0; shift < 2; shift++)
+  {
+    hb_buffer_clear_contents (expected);
+    hb_buffer_add_utf8 (expected, text, std::min (text_length, 4000u), 0, -1);
+    hb_buffer_guess_segment_properties (expected);
+    unsigned len;
+    hb_glyph_info_t *info = hb_buffer_get_glyph_infos (expected, &len);
+    for (unsigned i = 0; i < len; i++)
+      info[i].cluster = (i + shift) / 2;
+    hb_buffer_clear_contents (buf);
+    hb_buffer_append (buf, expected, 0, -1);
+
+    hb_shape (font, expected, nullptr, 0);
+    hb_shape_parallel (font, buf, nullptr, 0, nullptr, num_threads * 2,
+		       HB_SHAPE_PARALLEL_FLAG_DEFAULT, run_tasks, nullptr);
+
+    if (!buffers_equal (expected, buf))
+    {
+      fprintf (stderr, "Mismatch with clusters shifted by %u\n", shift);
+      success = false;
+    }
+  }
+
+  hb_buffer_destroy (buf);
+  hb_buffer_destroy (expected);
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc > 1)
+    num_threads = atoi (argv[1]);
+
+  /* Dummy call to alleviate _guess_segment_properties thread safety-ness
+   * https://github.com/harfbuzz/harfbuzz/issues/1191 */
+  hb_language_get_default ();
+
+  if (argc > 3)
+  {
+    num_tests = (argc - 2) / 2;
+    tests = (test_input_t *) calloc (num_tests, sizeof (test_input_t));
+    for (unsigned i = 0; i < num_tests; i++)
+    {
+      tests[i].font_path = argv[2 + i * 2];
+      tests[i].text_path = argv[3 + i * 2];
+    }
+  }
+
+  printf ("Num threads %u\n", num_threads);
+  bool success = true;
+  for (unsigned i = 0; i < num_tests; i++)
+    success = test_input (tests[i]) && success;
+  success = test_repeated_clusters (default_tests[2]) && success;
+
+  if (tests != default_tests)
+    free (tests);
+
+  return success ? 0 : 1;
+}
@@ -169,6 +169,161 @@ static void test_backend (backend_t backend,
   hb_font_destroy (font);
 }
 
+/* Shapes the lines of a text through one small hb_shape_cache_t on
+ * num_threads threads, such that lookups race with evictions and clears,
+ * and checks every result against hb_shape(). */
+static void test_shape_cache (const test_input_t &test_input)
+{
+  printf ("Testing shape-cache/%s\n", strrchr (test_input.text_path, '/') + 1);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (test_input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  std::vector<std::pair<const char *, unsigned>> lines;
+  const char *end;
+  for (const char *p = text; (end = (const char *) memchr (p, '\n', text + text_length - p)); p = end + 1)
+    lines.push_back ({p, (unsigned) (end - p)});
+
+  hb_shape_cache_t *cache = hb_shape_cache_create (64);
+
+  auto worker = [&] (unsigned seed) {
+    hb_buffer_t *buf = hb_buffer_create ();
+    hb_buffer_t *expected = hb_buffer_create ();
+    for (unsigned r = 0; r < num_repetitions; r++)
+      for (unsigned l = 0; l < lines.size (); l++)
+      {
+	/* Each thread starts at a different line. */
+	auto &line = lines[(l + seed * lines.size () / num_threads) % lines.size ()];
+	for (hb_buffer_t *b : {buf, expected})
+	{
+	  hb_buffer_clear_contents (b);
+	  hb_buffer_add_utf8 (b, line.first, line.second, 0, -1);
+	  hb_buffer_guess_segment_properties (b);
+	}
+	/* Clearing waits for the lookups in flight. */
+	if (!seed && l % 64 == 63)
+	  hb_shape_cache_clear (cache);
+	hb_shape_cache_shape (cache, font, buf, nullptr, 0, nullptr);
+	hb_shape (font, expected, nullptr, 0);
+
+	unsigned len, expected_len;
+	hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buf, &len);
+	hb_glyph_info_t *expected_info = hb_buffer_get_glyph_infos (expected, &expected_len);
+	hb_glyph_position_t *pos = hb_buffer_get_glyph_positions (buf, nullptr);
+	hb_glyph_position_t *expected_pos = hb_buffer_get_glyph_positions (expected, nullptr);
+	assert (len == expected_len);
+	for (unsigned i = 0; i < len; i++)
+	{
+	  assert (info[i].codepoint == expected_info[i].codepoint);
+	  assert (info[i].cluster == expected_info[i].cluster);
+	  assert (pos[i].x_advance == expected_pos[i].x_advance);
+	}
+      }
+    hb_buffer_destroy (expected);
+    hb_buffer_destroy (buf);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; i++)
+    threads.push_back (std::thread (worker, i));
+  for (unsigned i = 0; i < num_threads; i++)
+    threads[i].join ();
+
+  hb_shape_cache_destroy (cache);
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+}
+
+/* Shapes the lines of a text in more languages than the face keeps
+ * shape plans for, on num_threads threads, such that plan lookups race
+ * with evictions and capacity changes, and checks every result against
+ * shaping on a face of its own. */
+static void test_shape_plan_cache (const test_input_t &test_input)
+{
+  printf ("Testing shape-plan-cache/%s\n", strrchr (test_input.text_path, '/') + 1);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_face_t *expected_face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  hb_face_set_shape_plan_cache_capacity (face, 4);
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *expected_font = hb_font_create (expected_face);
+  hb_face_destroy (face);
+  hb_face_destroy (expected_face);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (test_input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  std::vector<std::pair<const char *, unsigned>> lines;
+  const char *end;
+  for (const char *p = text; (end = (const char *) memchr (p, '\n', text + text_length - p)); p = end + 1)
+    lines.push_back ({p, (unsigned) (end - p)});
+
+  const char *languages[] = {"en", "fr", "de", "nl", "tr", "ro", "pl", "fi"};
+  unsigned num_languages = sizeof (languages) / sizeof (languages[0]);
+
+  auto worker = [&] (unsigned seed) {
+    hb_buffer_t *buf = hb_buffer_create ();
+    hb_buffer_t *expected = hb_buffer_create ();
+    for (unsigned r = 0; r < num_repetitions; r++)
+      for (unsigned l = 0; l < lines.size (); l++)
+      {
+	auto &line = lines[(l + seed * lines.size () / num_threads) % lines.size ()];
+	hb_language_t language = hb_language_from_string (languages[(l + seed) % num_languages], -1);
+	for (hb_buffer_t *b : {buf, expected})
+	{
+	  hb_buffer_clear_contents (b);
+	  hb_buffer_add_utf8 (b, line.first, line.second, 0, -1);
+	  hb_buffer_set_language (b, language);
+	  hb_buffer_guess_segment_properties (b);
+	}
+	/* Resizing waits for the lookups in flight. */
+	if (!seed && l % 64 == 63)
+	  hb_face_set_shape_plan_cache_capacity (hb_font_get_face (font), 4 + 4 * ((l / 64) % 2));
+	hb_shape (font, buf, nullptr, 0);
+	hb_shape (expected_font, expected, nullptr, 0);
+
+	unsigned len, expected_len;
+	hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buf, &len);
+	hb_glyph_info_t *expected_info = hb_buffer_get_glyph_infos (expected, &expected_len);
+	hb_glyph_position_t *pos = hb_buffer_get_glyph_positions (buf, nullptr);
+	hb_glyph_position_t *expected_pos = hb_buffer_get_glyph_positions (expected, nullptr);
+	assert (len == expected_len);
+	for (unsigned i = 0; i < len; i++)
+	{
+	  assert (info[i].codepoint == expected_info[i].codepoint);
+	  assert (info[i].cluster == expected_info[i].cluster);
+	  assert (pos[i].x_advance == expected_pos[i].x_advance);
+	}
+      }
+    hb_buffer_destroy (expected);
+    hb_buffer_destroy (buf);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; i++)
+    threads.push_back (std::thread (worker, i));
+  for (unsigned i = 0; i < num_threads; i++)
+    threads[i].join ();
+
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (expected_font);
+  hb_font_destroy (font);
+}
+
 int main(int argc, char** argv)
 {
   if (argc > 1)
@@ -207,6 +362,9 @@ int main(int argc, char** argv)
     }
   }
 
+  test_shape_cache (default_tests[3]);
+  test_shape_plan_cache (default_tests[3]);
+
   if (tests != default_tests)
     free (tests);
 }
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -10,6 +11,7 @@
 #include "config.h"
 #endif
 
+#include "hb-ot.h"
 #include "hb-subset.h"
 
 enum operation_t
@@ -33,6 +35,8 @@ struct test_input_t
   {SUBSET_FONT_BASE_PATH "Mplus1p-Regular.ttf", 10000},
   {SUBSET_FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", 10000},
   {SUBSET_FONT_BASE_PATH "SourceSansPro-Regular.otf", 2000},
+  {SUBSET_FONT_BASE_PATH "Roboto-Variable.ttf", 1000},
+  {SUBSET_FONT_BASE_PATH "AdobeVFPrototype.otf", 1000},
 };
 
 
@@ -152,6 +156,156 @@ static void test_operation (operation_t operation,
   hb_face_destroy (face);
 }
 
+static void run_tasks (unsigned int num_tasks,
+		       hb_subset_task_func_t task,
+		       void *task_data,
+		       void *user_data)
+{
+  std::atomic<unsigned> next {0};
+  auto worker = [&] () {
+    unsigned i;
+    while ((i = next++) < num_tasks)
+      task (i, task_data);
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < num_threads && i < num_tasks; i++)
+    threads.push_back (std::thread (worker));
+  worker ();
+  for (auto &thread : threads)
+    thread.join ();
+}
+
+static hb_blob_t *subset_to_blob (hb_face_t *face,
+				  hb_subset_input_t *input,
+				  bool parallel)
+{
+  hb_subset_plan_t *plan = hb_subset_plan_create_or_fail (face, input);
+  assert (plan);
+  hb_face_t *subset = parallel
+		    ? hb_subset_plan_execute_parallel_or_fail (plan, run_tasks, nullptr)
+		    : hb_subset_plan_execute_or_fail (plan);
+  assert (subset);
+  hb_blob_t *blob = hb_face_reference_blob (subset);
+  hb_face_destroy (subset);
+  hb_subset_plan_destroy (plan);
+  return blob;
+}
+
+static void check_parallel_matches_serial (const char *name,
+					   hb_face_t *face,
+					   hb_subset_input_t *input)
+{
+  printf ("Testing parallel/%s\n", name);
+
+  hb_blob_t *expected = subset_to_blob (face, input, false);
+  for (unsigned i = 0; i < num_repetitions; i++)
+  {
+    hb_blob_t *actual = subset_to_blob (face, input, true);
+    unsigned expected_length, actual_length;
+    const char *expected_data = hb_blob_get_data (expected, &expected_length);
+    const char *actual_data = hb_blob_get_data (actual, &actual_length);
+    assert (expected_length == actual_length);
+    assert (!memcmp (expected_data, actual_data, expected_length));
+    hb_blob_destroy (actual);
+  }
+  hb_blob_destroy (expected);
+}
+
+/* Subsets each font with hb_subset_plan_execute_parallel_or_fail() on
+ * num_threads threads and checks the result is byte-identical to the
+ * serial hb_subset_plan_execute_or_fail(). */
+static void test_parallel (const test_input_t &test_input)
+{
+  const char *name = strrchr (test_input.font_path, '/');
+  name = name ? name + 1 : test_input.font_path;
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  assert (input);
+  hb_set_t *all_codepoints = hb_set_create ();
+  hb_face_collect_unicodes (face, all_codepoints);
+  AddCodepoints (all_codepoints, test_input.max_subset_size, input);
+  hb_set_destroy (all_codepoints);
+
+  check_parallel_matches_serial (name, face, input);
+
+  /* Instancing makes hmtx, vmtx, maxp and OS/2 wait for glyf, and GPOS
+   * for GDEF unless all axes are pinned. */
+  if (hb_ot_var_has_data (face))
+  {
+    hb_subset_input_pin_axis_location (input, face, HB_TAG ('w','g','h','t'), 600);
+    check_parallel_matches_serial (name, face, input);
+
+    hb_subset_input_pin_all_axes_to_default (input, face);
+    check_parallel_matches_serial (name, face, input);
+  }
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+/* Subsets a preprocessed face to nested codepoint sets on num_threads
+ * threads, which share its layout closure cache, and checks the results
+ * are byte-identical to subsetting the plain face. */
+static void test_preprocessed (const test_input_t &test_input)
+{
+  const char *name = strrchr (test_input.font_path, '/');
+  name = name ? name + 1 : test_input.font_path;
+  printf ("Testing preprocessed/%s\n", name);
+
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  hb_face_t *preprocessed = hb_subset_preprocess (face);
+
+  hb_set_t *all_codepoints = hb_set_create ();
+  hb_face_collect_unicodes (face, all_codepoints);
+  hb_subset_input_t *inputs[3];
+  hb_blob_t *expected[3];
+  for (unsigned i = 0; i < 3; i++)
+  {
+    inputs[i] = hb_subset_input_create_or_fail ();
+    assert (inputs[i]);
+    AddCodepoints (all_codepoints, test_input.max_subset_size >> (2 - i), inputs[i]);
+    expected[i] = subset_to_blob (face, inputs[i], false);
+  }
+  hb_set_destroy (all_codepoints);
+
+  auto worker = [&] () {
+    for (unsigned r = 0; r < num_repetitions; r++)
+      for (unsigned i = 0; i < 3; i++)
+      {
+	hb_blob_t *actual = subset_to_blob (preprocessed, inputs[i], false);
+	unsigned expected_length, actual_length;
+	const char *expected_data = hb_blob_get_data (expected[i], &expected_length);
+	const char *actual_data = hb_blob_get_data (actual, &actual_length);
+	assert (expected_length == actual_length);
+	assert (!memcmp (expected_data, actual_data, expected_length));
+	hb_blob_destroy (actual);
+      }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; i++)
+    threads.push_back (std::thread (worker));
+  for (auto &thread : threads)
+    thread.join ();
+
+  for (unsigned i = 0; i < 3; i++)
+  {
+    hb_blob_destroy (expected[i]);
+    hb_subset_input_destroy (inputs[i]);
+  }
+  hb_face_destroy (preprocessed);
+  hb_face_destroy (face);
+}
+
 int main(int argc, char** argv)
 {
   if (argc > 1)
@@ -175,6 +329,8 @@ int main(int argc, char** argv)
     auto& test_input = tests[i];
     test_operation (subset_codepoints, "codepoints", test_input);
     test_operation (subset_glyphs, "glyphs", test_input);
+    test_parallel (test_input);
+    test_preprocessed (test_input);
   }
 
   if (tests != default_tests)
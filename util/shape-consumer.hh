@@ -46,6 +46,11 @@ struct shape_consumer_t : shape_options_t
   {
     failed = false;
     buffer = hb_buffer_create ();
+    if (profile)
+    {
+      shape_profile = hb_shape_profile_create ();
+      hb_buffer_set_shape_profile (buffer, shape_profile);
+    }
 
     output.init (buffer, app);
   }
@@ -89,6 +94,77 @@ struct shape_consumer_t : shape_options_t
     output.finish (buffer, app);
     hb_buffer_destroy (buffer);
     buffer = nullptr;
+    if (shape_profile)
+    {
+      print_profile (stderr);
+      hb_shape_profile_destroy (shape_profile);
+      shape_profile = nullptr;
+    }
+  }
+
+  protected:
+  void print_profile (FILE *fp)
+  {
+    static const struct { hb_shape_profile_stage_t stage; const char *name; } stages[] =
+    {
+      {HB_SHAPE_PROFILE_STAGE_PREPARE,		"prepare"},
+      {HB_SHAPE_PROFILE_STAGE_NORMALIZE,	"normalize"},
+      {HB_SHAPE_PROFILE_STAGE_SETUP_MASKS,	"setup-masks"},
+      {HB_SHAPE_PROFILE_STAGE_SUBSTITUTE,	"substitute"},
+      {HB_SHAPE_PROFILE_STAGE_POSITION,		"position"},
+      {HB_SHAPE_PROFILE_STAGE_FALLBACK_POSITION,"fallback-position"},
+      {HB_SHAPE_PROFILE_STAGE_FINISH,		"finish"},
+    };
+    double total = 0;
+    for (const auto &s : stages)
+      total += hb_shape_profile_get_stage_time (shape_profile, s.stage);
+
+    fprintf (fp, "Stage                 Time (ms)\n");
+    for (const auto &s : stages)
+    {
+      double t = hb_shape_profile_get_stage_time (shape_profile, s.stage);
+      fprintf (fp, "%-20s %10.3f %5.1f%%\n", s.name, t * 1000, total ? t / total * 100 : 0.);
+    }
+    fprintf (fp, "%-20s %10.3f\n", "total", total * 1000);
+
+    static const hb_tag_t table_tags[] = {HB_OT_TAG_GSUB, HB_OT_TAG_GPOS};
+    for (hb_tag_t table_tag : table_tags)
+    {
+      char tag[5] = {};
+      hb_tag_to_string (table_tag, tag);
+
+      unsigned count = hb_shape_profile_get_layout_stage_times (shape_profile, table_tag, 0, nullptr, nullptr);
+      if (count)
+      {
+	double *times = (double *) calloc (count, sizeof (times[0]));
+	hb_shape_profile_get_layout_stage_times (shape_profile, table_tag, 0, &count, times);
+	fprintf (fp, "\n%s stage           Time (ms)\n", tag);
+	for (unsigned i = 0; i < count; i++)
+	  fprintf (fp, "%-20u %10.3f\n", i, times[i] * 1000);
+	free (times);
+      }
+
+      count = hb_shape_profile_get_lookups (shape_profile, table_tag, 0, nullptr, nullptr);
+      if (count)
+      {
+	hb_shape_profile_lookup_t *lookups = (hb_shape_profile_lookup_t *) calloc (count, sizeof (lookups[0]));
+	hb_shape_profile_get_lookups (shape_profile, table_tag, 0, &count, lookups);
+	/* Slowest first. */
+	qsort (lookups, count, sizeof (lookups[0]),
+	       [] (const void *pa, const void *pb) {
+		 double a = ((const hb_shape_profile_lookup_t *) pa)->time;
+		 double b = ((const hb_shape_profile_lookup_t *) pb)->time;
+		 return a > b ? -1 : a < b ? 1 : 0;
+	       });
+	fprintf (fp, "\n%s lookup    Time (ms)     Runs    Glyphs  Rejected   Applied\n", tag);
+	for (unsigned i = 0; i < count; i++)
+	  fprintf (fp, "%-11u %10.3f %8u %9u %9u %9u\n",
+		   lookups[i].lookup_index, lookups[i].time * 1000,
+		   lookups[i].invocations, lookups[i].glyphs_visited,
+		   lookups[i].digest_rejections, lookups[i].applications);
+	free (lookups);
+      }
+    }
   }
 
   public:
@@ -98,6 +174,7 @@ struct shape_consumer_t : shape_options_t
   output_t output;
 
   hb_buffer_t *buffer = nullptr;
+  hb_shape_profile_t *shape_profile = nullptr;
 };
 
 
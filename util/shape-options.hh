@@ -253,6 +253,7 @@ struct shape_options_t
   hb_bool_t glyphs = false;
   bool scale_advances = true;
   hb_bool_t verify = false;
+  hb_bool_t profile = false;
   hb_bool_t unsafe_to_concat = false;
   hb_bool_t safe_to_insert_tatweel = false;
   unsigned int num_iterations = 1;
@@ -389,6 +390,7 @@ shape_options_t::add_options (option_parser_t *parser)
     {"safe-to-insert-tatweel",0, 0, G_OPTION_ARG_NONE,	&this->safe_to_insert_tatweel,	"Produce safe-to-insert-tatweel glyph flag",	nullptr},
     {"glyphs",		0, 0, G_OPTION_ARG_NONE,	&this->glyphs,			"Interpret input as glyph string",	nullptr},
     {"verify",		0, 0, G_OPTION_ARG_NONE,	&this->verify,			"Perform sanity checks on shaping results",	nullptr},
+    {"profile",		0, 0, G_OPTION_ARG_NONE,	&this->profile,			"Print shaping times and lookup counters to stderr",	nullptr},
     {"num-iterations",	'n',G_OPTION_FLAG_IN_MAIN,
 			      G_OPTION_ARG_INT,		&this->num_iterations,		"Run shaper N times (default: 1)",	"N"},
     {nullptr}